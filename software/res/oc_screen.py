@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+#
+# Live view of the O_C display over USB serial.
+#
+# Sends 's' to start the screen stream (util/util_framestream.h), decodes the
+# XOR/RLE page deltas and draws the screen in the terminal with half-block
+# characters. Sends 'q' on exit.
+#
+#   python3 oc_screen.py /dev/ttyACM0
+#   python3 oc_screen.py /dev/ttyACM0 --pbm shots/   # also save each frame
+#   python3 oc_screen.py --file capture.bin          # decode a recording
+#
+# Serial needs pyserial (pip install pyserial).
+
+import argparse
+import os
+import sys
+
+WIDTH = 128
+HEIGHT = 64
+PAGE_SIZE = WIDTH
+NUM_PAGES = HEIGHT // 8
+SYNC = b'\xa5\x5a'
+END_OF_FRAME = 0xff
+HEADER_SIZE = 5
+
+
+class Decoder:
+    def __init__(self):
+        self.frame = bytearray(WIDTH * NUM_PAGES)
+        self.buffer = bytearray()
+        self.frames = 0
+
+    def feed(self, data):
+        """Decode data, yields at the end of each frame."""
+        self.buffer += data
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]
+                break
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER_SIZE:
+                break
+            page = self.buffer[2]
+            length = self.buffer[3] | (self.buffer[4] << 8)
+            if page != END_OF_FRAME and (page >= NUM_PAGES or length > PAGE_SIZE + 1):
+                # not a header after all, resync
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < HEADER_SIZE + length:
+                break
+            payload = self.buffer[HEADER_SIZE:HEADER_SIZE + length]
+            del self.buffer[:HEADER_SIZE + length]
+            if page == END_OF_FRAME:
+                self.frames += 1
+                yield self
+            else:
+                self.apply(page, payload)
+
+    def apply(self, page, payload):
+        offset = page * PAGE_SIZE
+        i = 0
+        pos = 0
+        while pos < len(payload) and i < PAGE_SIZE:
+            c = payload[pos]
+            pos += 1
+            if c & 0x80:
+                n = (c & 0x7f) + 2
+                delta = payload[pos] if pos < len(payload) else 0
+                pos += 1
+                for _ in range(min(n, PAGE_SIZE - i)):
+                    self.frame[offset + i] ^= delta
+                    i += 1
+            else:
+                for b in payload[pos:pos + c + 1]:
+                    if i >= PAGE_SIZE:
+                        break
+                    self.frame[offset + i] ^= b
+                    i += 1
+                pos += c + 1
+
+    def pixel(self, x, y):
+        return (self.frame[(y // 8) * WIDTH + x] >> (y & 7)) & 1
+
+
+def render(decoder):
+    # Two pixel rows per text line
+    blocks = (' ', '▀', '▄', '█')
+    lines = []
+    for y in range(0, HEIGHT, 2):
+        lines.append(''.join(blocks[decoder.pixel(x, y) | (decoder.pixel(x, y + 1) << 1)]
+                             for x in range(WIDTH)))
+    return '\x1b[H' + '\n'.join(lines) + '\n'
+
+
+def write_pbm(decoder, path):
+    with open(path, 'wb') as f:
+        f.write(b'P1\n%d %d\n' % (WIDTH, HEIGHT))
+        for y in range(HEIGHT):
+            f.write(b' '.join(b'1' if decoder.pixel(x, y) else b'0' for x in range(WIDTH)) + b'\n')
+
+
+def frames(decoder, read):
+    # read() returns None at the end of the stream, b'' on a timeout
+    while True:
+        data = read()
+        if data is None:
+            return
+        for frame in decoder.feed(data):
+            yield frame
+
+
+def main():
+    parser = argparse.ArgumentParser(description='O_C screen viewer')
+    parser.add_argument('port', nargs='?', help='serial port, e.g. /dev/ttyACM0 or COM3')
+    parser.add_argument('--file', help='decode a recorded stream instead')
+    parser.add_argument('--record', help='save the raw stream to this file')
+    parser.add_argument('--pbm', help='write each frame as a PBM to this directory')
+    parser.add_argument('--quiet', action='store_true', help='do not draw in the terminal')
+    args = parser.parse_args()
+
+    if not args.port and not args.file:
+        parser.error('need a serial port or --file')
+    if args.pbm:
+        os.makedirs(args.pbm, exist_ok=True)
+
+    port = None
+    if args.file:
+        source = open(args.file, 'rb')
+        read = lambda: source.read(4096) or None
+    else:
+        import serial
+        port = serial.Serial(args.port, 115200, timeout=0.1)
+        port.write(b's')
+        read = lambda: port.read(max(1, port.in_waiting))
+
+    record = open(args.record, 'wb') if args.record else None
+    if record:
+        raw_read = read
+        def read():
+            data = raw_read()
+            if data:
+                record.write(data)
+            return data
+
+    decoder = Decoder()
+    if not args.quiet:
+        sys.stdout.write('\x1b[2J')
+    try:
+        for frame in frames(decoder, read):
+            if not args.quiet:
+                sys.stdout.write(render(frame))
+                sys.stdout.flush()
+            if args.pbm:
+                write_pbm(frame, os.path.join(args.pbm, 'frame%05d.pbm' % frame.frames))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if port:
+            port.write(b'q')
+            port.close()
+        if record:
+            record.close()
+    print('%d frames' % decoder.frames)
+
+
+if __name__ == '__main__':
+    main()
@@ -256,26 +256,9 @@ public:
         cal8_presets[index].save_preset(channel);
         preset_modified = 0;
 
-        // initiate actual EEPROM save
-        OC::CORE::app_isr_enabled = false;
-        OC::draw_save_message(16);
-        delay(1);
-        OC::draw_save_message(32);
+        // only takes a snapshot, the writes happen from loop()
         OC::save_app_data();
-        OC::draw_save_message(64);
-
-        const uint32_t timeout = 100;
-        uint32_t start = millis();
-        while(millis() < start + timeout) {
-          GRAPHICS_BEGIN_FRAME(true);
-          graphics.setPrintPos(13, 18);
-          graphics.print("Settings saved");
-          graphics.setPrintPos(31, 27);
-          graphics.print("to EEPROM!");
-          GRAPHICS_END_FRAME();
-        }
-
-        OC::CORE::app_isr_enabled = true;
+        PokePopup(SAVE_POPUP);
     }
 
     void Resume() {
@@ -285,62 +268,43 @@ public:
         }
     }
 
-    void ProcessMIDI() {
-        HS::IOFrame &f = HS::frame;
-        bool dothething = false;
-
-        while (usbMIDI.read()) {
-            const int message = usbMIDI.getType();
-            const int data1 = usbMIDI.getData1();
-            const int data2 = usbMIDI.getData2();
+    template <typename T>
+    void PollMIDI(T &device) {
+        while (device.read()) {
+            const int message = device.getType();
 
             if (message == usbMIDI.SystemExclusive) {
                 // TODO: consider implementing SysEx import/export for Calibr8or
                 continue;
             }
 
-            f.MIDIState.ProcessMIDIMsg(usbMIDI.getChannel(), message, data1, data2);
-
-            if (message == usbMIDI.NoteOn || message == usbMIDI.NoteOff) {
-              dothething = true;
-            }
+            HS::PushMIDIEvent(message, device.getChannel(), device.getData1(), device.getData2());
         }
+    }
 
+    // Called from loop(): reads all MIDI ports and queues messages for
+    // ProcessMIDI()
+    void PollMIDI() {
+        PollMIDI(usbMIDI);
 #if defined(__IMXRT1062__) && defined(ARDUINO_TEENSY41)
         thisUSB.Task();
-        while (usbHostMIDI.read()) {
-            const int message = usbHostMIDI.getType();
-            const int data1 = usbHostMIDI.getData1();
-            const int data2 = usbHostMIDI.getData2();
-
-            if (message == usbMIDI.SystemExclusive) {
-                // TODO: consider implementing SysEx import/export for Calibr8or
-                continue;
-            }
-
-            f.MIDIState.ProcessMIDIMsg(usbHostMIDI.getChannel(), message, data1, data2);
-
-            if (message == usbMIDI.NoteOn || message == usbMIDI.NoteOff) {
-              dothething = true;
-            }
-        }
-        while (MIDI1.read()) {
-            const int message = MIDI1.getType();
-            const int data1 = MIDI1.getData1();
-            const int data2 = MIDI1.getData2();
+        PollMIDI(usbHostMIDI);
+        PollMIDI(MIDI1);
+#endif
+    }
 
-            if (message == usbMIDI.SystemExclusive) {
-                // TODO: consider implementing SysEx import/export for Calibr8or
-                continue;
-            }
+    // ISR side: handles a bounded number of queued events per tick
+    void ProcessMIDI() {
+        bool dothething = false;
 
-            f.MIDIState.ProcessMIDIMsg(MIDI1.getChannel(), message, data1, data2);
+        HS::MIDIEvent event;
+        for (int i = 0; i < HS::kMIDIEventsPerTick && HS::midi_events.Pop(event); ++i) {
+            HS::frame.MIDIState.ProcessMIDIMsg(event.channel, event.message, event.data1, event.data2);
 
-            if (message == usbMIDI.NoteOn || message == usbMIDI.NoteOff) {
+            if (event.message == usbMIDI.NoteOn || event.message == usbMIDI.NoteOff) {
               dothething = true;
             }
         }
-#endif
 
         if (dothething) {
           // reconfigure with MIDI-derived masks
@@ -348,9 +312,9 @@ public:
             uint16_t mask_ = HS::frame.MIDIState.semitone_mask[ch];
 
             if (mask_) // manually override global config
-              HS::quantizer[ch].Configure(OC::Scales::GetScale(OC::Scales::SCALE_SEMI), mask_);
+              HS::quantizer_bank.Configure(ch, OC::Scales::GetScale(OC::Scales::SCALE_SEMI), mask_);
             else // restore global config
-              HS::quantizer[ch].Configure(OC::Scales::GetScale(HS::quant_scale[ch]), 0xffff);
+              HS::quantizer_bank.Configure(ch, OC::Scales::GetScale(HS::quant_scale[ch]), 0xffff);
 
             HS::quantizer[ch].Requantize();
           }
@@ -364,24 +328,35 @@ public:
         ClockSetup_instance.Controller();
 
         // -- core processing --
+        // gather the channels to sample, then quantize them in one go
+        uint32_t sampled = 0;
+        uint32_t clocked = 0;
+        int32_t pitch[DAC_CHANNEL_LAST];
+        int32_t transpose[DAC_CHANNEL_LAST];
+        int32_t quantized[DAC_CHANNEL_LAST];
         for (int ch = 0; ch < DAC_CHANNEL_LAST; ++ch) {
-            bool clocked = Clock(ch);
             Cal8ChannelConfig &cfg = channel[ch];
+            if (Clock(ch)) clocked |= 1u << ch;
 
             // clocked transpose
-            if (CONTINUOUS == cfg.clocked_mode || clocked) {
+            if (CONTINUOUS == cfg.clocked_mode || (clocked & (1u << ch))) {
                 cfg.transpose_active = cfg.transpose;
             }
             if (HS::frame.MIDIState.semitone_mask[ch] != 0)
               cfg.transpose_active = 0;
 
             // respect S&H mode
-            if (cfg.clocked_mode != SAMPLE_AND_HOLD || clocked) {
-                // CV value
-                int pitch = In(ch);
-                int quantized = HS::Quantize(ch, pitch, 0, cfg.transpose_active);
-                cfg.last_note = quantized;
+            if (cfg.clocked_mode != SAMPLE_AND_HOLD || (clocked & (1u << ch))) {
+                sampled |= 1u << ch;
+                pitch[ch] = In(ch);
+                transpose[ch] = cfg.transpose_active;
             }
+        }
+        HS::QuantizeAll(sampled, pitch, transpose, quantized);
+
+        for (int ch = 0; ch < DAC_CHANNEL_LAST; ++ch) {
+            Cal8ChannelConfig &cfg = channel[ch];
+            if (sampled & (1u << ch)) cfg.last_note = quantized[ch];
 
             int output_cv = cfg.last_note;
             if ( OC::DAC::calibration_data_used( DAC_CHANNEL(sel_chan) ) != 0x01 ) // not autotuned
@@ -391,7 +366,7 @@ public:
             Out(ch, output_cv);
 
             // for UI flashers
-            if (clocked) trigger_flash[ch] = HEMISPHERE_PULSE_ANIMATION_TIME;
+            if (clocked & (1u << ch)) trigger_flash[ch] = HEMISPHERE_PULSE_ANIMATION_TIME;
             else if (trigger_flash[ch]) --trigger_flash[ch];
         }
     }
@@ -820,6 +795,7 @@ void Calibr8or_isr() {
 void Calibr8or_handleAppEvent(OC::AppEvent event) {
     switch (event) {
     case OC::APP_EVENT_RESUME:
+        HS::midi_events.Flush();
         Calibr8or_instance.Resume();
         break;
 
@@ -832,7 +808,10 @@ void Calibr8or_handleAppEvent(OC::AppEvent event) {
     }
 }
 
-void Calibr8or_loop() {} // Deprecated
+void Calibr8or_loop() {
+    Calibr8or_instance.PollMIDI();
+    HS::PollQuantizers();
+}
 
 void Calibr8or_menu() { Calibr8or_instance.BaseView(); }
 
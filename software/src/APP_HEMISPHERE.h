@@ -36,6 +36,7 @@
 #include "HSicons.h"
 #include "HSMIDI.h"
 #include "HSClockManager.h"
+#include "HSAppletScheduler.h"
 
 #ifdef ARDUINO_TEENSY41
 #include "AudioSetup.h"
@@ -91,9 +92,8 @@ public:
         return (h == LEFT_HEMISPHERE) ? values_[HEMISPHERE_SELECTED_LEFT_ID]
                                       : values_[HEMISPHERE_SELECTED_RIGHT_ID];
     }
-    HemisphereApplet* GetApplet(int h) {
-      int idx = HS::get_applet_index_by_id( GetAppletId(h) );
-      return HS::available_applets[idx].instance[h];
+    int GetAppletIndex(int h) {
+      return HS::get_applet_index_by_id( GetAppletId(h) );
     }
     void SetAppletId(int h, int id) {
         apply_value(h, id);
@@ -243,7 +243,7 @@ public:
         for (int i = 0; i < 4; ++i) {
             quant_scale[i] = OC::Scales::SCALE_SEMI;
             quantizer[i].Init();
-            quantizer[i].Configure(OC::Scales::GetScale(quant_scale[i]), 0xffff);
+            quantizer_bank.Configure(i, OC::Scales::GetScale(quant_scale[i]), 0xffff);
         }
 
         SetApplet(LEFT_HEMISPHERE, HS::get_applet_index_by_id(18)); // DualTM
@@ -251,12 +251,19 @@ public:
     }
 
     void Resume() {
+        OC::DEBUG::ResetAppletCycles();
+        // Quadrants shares the slots, and may have put its own applets there
+        for (int h = 0; h < 2; h++)
+        {
+            if (HS::applet_slots[h].index != my_applet[h] || !HS::applet_in(h))
+                SetApplet(HEM_SIDE(h), my_applet[h]);
+        }
         if (!hem_active_preset)
             LoadFromPreset(0);
         // restore quantizer settings
         for (int i = 0; i < 4; ++i) {
             quantizer[i].Init();
-            quantizer[i].Configure(OC::Scales::GetScale(quant_scale[i]), 0xffff);
+            quantizer_bank.Configure(i, OC::Scales::GetScale(quant_scale[i]), 0xffff);
         }
     }
     void Suspend() {
@@ -277,7 +284,7 @@ public:
                 doSave = 1;
             hem_active_preset->SetAppletId(HEM_SIDE(h), HS::available_applets[index].id);
 
-            uint64_t data = HS::available_applets[index].instance[h]->OnDataRequest();
+            uint64_t data = HS::applet_in(h)->OnDataRequest();
             if (data != applet_data[h]) doSave = 1;
             applet_data[h] = data;
             hem_active_preset->SetData(HEM_SIDE(h), data);
@@ -304,26 +311,9 @@ public:
           // this also takes care of the EEPROM save
           Calibr8or_instance.SavePreset();
 #else
-        // initiate actual EEPROM save
-        OC::CORE::app_isr_enabled = false;
-        OC::draw_save_message(16);
-        delay(1);
-        OC::draw_save_message(32);
-        OC::save_app_data();
-        OC::draw_save_message(64);
-
-        const uint32_t timeout = 100;
-        uint32_t start = millis();
-        while(millis() < start + timeout) {
-          GRAPHICS_BEGIN_FRAME(true);
-          graphics.setPrintPos(13, 18);
-          graphics.print("Settings saved");
-          graphics.setPrintPos(31, 27);
-          graphics.print("to EEPROM!");
-          GRAPHICS_END_FRAME();
-        }
-
-        OC::CORE::app_isr_enabled = true;
+          // only takes a snapshot, the writes happen from loop()
+          OC::save_app_data();
+          PokePopup(SAVE_POPUP);
 #endif
         }
 
@@ -348,7 +338,7 @@ public:
                 int index = HS::get_applet_index_by_id( hem_active_preset->GetAppletId(h) );
                 applet_data[h] = hem_active_preset->GetData(HEM_SIDE(h));
                 SetApplet(HEM_SIDE(h), index);
-                HS::available_applets[index].instance[h]->OnDataReceive(applet_data[h]);
+                HS::applet_in(h)->OnDataReceive(applet_data[h]);
             }
 
 
@@ -356,16 +346,30 @@ public:
         preset_id = id;
         PokePopup(PRESET_POPUP);
     }
+    // ISR side: applets can only change hands in loop()
     void ProcessQueue() {
-      LoadFromPreset(queued_preset);
+      pending_preset = queued_preset;
+    }
+    // loop side: preset loads and applet changes queued since last time
+    void ApplyChanges() {
+      // take and clear in one go, or a preset queued in between is lost
+      __disable_irq();
+      const int id = pending_preset;
+      pending_preset = -1;
+      __enable_irq();
+      if (id >= 0)
+        LoadFromPreset(id);
+      for (int h = 0; h < 2; h++)
+      {
+        if (my_applet[h] != next_applet[h])
+          SetApplet(HEM_SIDE(h), next_applet[h]);
+      }
     }
 
     // does not modify the preset, only the manager
     void SetApplet(HEM_SIDE hemisphere, int index) {
-        //if (my_applet[hemisphere]) // TODO: special case for first load?
-        HS::available_applets[my_applet[hemisphere]].instance[hemisphere]->Unload();
         next_applet[hemisphere] = my_applet[hemisphere] = index;
-        HS::available_applets[index].instance[hemisphere]->BaseStart(hemisphere);
+        HS::StartApplet(hemisphere, index);
     }
     void ChangeApplet(HEM_SIDE h, int dir) {
         int index = HS::get_next_applet_index(next_applet[h], dir);
@@ -377,19 +381,12 @@ public:
     }
 
 #if defined(__IMXRT1062__)
-  #if defined(ARDUINO_TEENSY41)
-    template <typename T1, typename T2, typename T3>
-    void ProcessMIDI(T1 &device, T2 &next_device, T3 &dev3) {
-  #else
-    template <typename T1, typename T2>
-    void ProcessMIDI(T1 &device, T2 &next_device) {
-  #endif
+    template <typename T>
+    void PollMIDI(T &device, HS::MIDIPort port) {
 #else
-    template <typename T1>
-    void ProcessMIDI(T1 &device) {
+    template <typename T>
+    void PollMIDI(T &device) {
 #endif
-        HS::IOFrame &f = HS::frame;
-
         while (device.read()) {
             const int message = device.getType();
             const int data1 = device.getData1();
@@ -400,55 +397,63 @@ public:
                 continue;
             }
 
-            if (message == usbMIDI.ProgramChange) {
-                int slot = device.getData1();
+#if defined(__IMXRT1062__)
+            HS::RouteMIDIInput(port, message, device.getChannel(), data1, data2);
+#else
+            HS::PushMIDIEvent(message, device.getChannel(), data1, data2);
+#endif
+        }
+    }
+
+    // Called from loop(): reads all MIDI ports, routes messages to the other
+    // ports and queues them for ProcessMIDI()
+    void PollMIDI() {
+#if defined(__IMXRT1062__)
+        PollMIDI(usbMIDI, HS::MIDI_PORT_USB);
+        thisUSB.Task();
+        PollMIDI(usbHostMIDI, HS::MIDI_PORT_USB_HOST);
+  #if defined(ARDUINO_TEENSY41)
+        PollMIDI(MIDI1, HS::MIDI_PORT_DIN);
+  #endif
+#else
+        PollMIDI(usbMIDI);
+#endif
+    }
+
+    // ISR side: handles a bounded number of queued events per tick
+    void ProcessMIDI() {
+        HS::MIDIEvent event;
+        for (int i = 0; i < HS::kMIDIEventsPerTick && HS::midi_events.Pop(event); ++i) {
+            if (event.message == usbMIDI.ProgramChange) {
+                int slot = event.data1;
                 if (slot < HEM_NR_OF_PRESETS) {
                   if (HS::clock_m.IsRunning()) {
                     queued_preset = slot;
                     HS::clock_m.BeatSync( &BeatSyncProcess );
                   }
                   else
-                    LoadFromPreset(slot);
+                    pending_preset = slot;
                 }
                 continue;
             }
 
-            f.MIDIState.ProcessMIDIMsg(device.getChannel(), message, data1, data2);
-#if defined(__IMXRT1062__)
-            next_device.send(message, data1, data2, device.getChannel(), 0);
-  #if defined(ARDUINO_TEENSY41)
-            dev3.send((midi::MidiType)message, data1, data2, device.getChannel());
-  #endif
-#endif
+            HS::frame.MIDIState.ProcessMIDIMsg(event.channel, event.message, event.data1, event.data2);
         }
     }
 
     void Controller() {
         // top-level MIDI-to-CV handling - alters frame outputs
-#if defined(__IMXRT1062__)
-  #if defined(ARDUINO_TEENSY41)
-        ProcessMIDI(usbMIDI, usbHostMIDI, MIDI1);
-        thisUSB.Task();
-        ProcessMIDI(usbHostMIDI, usbMIDI, MIDI1);
-        ProcessMIDI(MIDI1, usbMIDI, usbHostMIDI);
-  #else
-        ProcessMIDI(usbMIDI, usbHostMIDI);
-        thisUSB.Task();
-        ProcessMIDI(usbHostMIDI, usbMIDI);
-  #endif
-#else
-        ProcessMIDI(usbMIDI);
-#endif
+        ProcessMIDI();
 
         // Clock Setup applet handles internal clock duties
-        ClockSetup_instance.Controller();
+        {
+          OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::CLOCK_cycles);
+          ClockSetup_instance.Controller();
+        }
 
         // execute Applets
         for (int h = 0; h < 2; h++)
         {
-            if (my_applet[h] != next_applet[h]) {
-              SetApplet(HEM_SIDE(h), next_applet[h]);
-            }
             int index = my_applet[h];
 
             // MIDI signals mixed with inputs to applets
@@ -466,24 +471,37 @@ public:
                         HS::frame.inputs[chan] += HS::frame.MIDIState.outputs[chan];
                         break;
                     case HEM_MIDI_GATE_OUT:
-                        HS::frame.gate_high[chan] |= (HS::frame.MIDIState.outputs[chan] > (12 << 7));
+                        HS::frame.gate_mask |= (HS::frame.MIDIState.outputs[chan] > (12 << 7)) << chan;
                         break;
                     case HEM_MIDI_TRIG_OUT:
                     case HEM_MIDI_CLOCK_OUT:
                     case HEM_MIDI_START_OUT:
-                        HS::frame.clocked[chan] |= HS::frame.MIDIState.trigout_q[chan];
+                        HS::frame.clocked_mask |= HS::frame.MIDIState.trigout_q[chan] << chan;
                         HS::frame.MIDIState.trigout_q[chan] = 0;
                         break;
                     }
                 }
             }
             if (HS::clock_m.auto_reset)
-                HS::available_applets[index].instance[h]->Reset();
-
-            HS::available_applets[index].instance[h]->BaseController();
+                HS::applet_in(h)->Reset();
         }
         HS::clock_m.auto_reset = false;
 
+        // upstream applets first, so chained outputs arrive this tick
+        const uint8_t *order = scheduler.Update(HS::trigger_mapping, HS::cvmapping);
+        uint8_t slow_mask = 0;
+        for (int h = 0; h < 2; h++) {
+            if (HS::applet_in(h)->GetControlRate() != HS::CONTROL_RATE_FULL) slow_mask |= 1 << h;
+        }
+        const uint8_t due = control_rate.Update(slow_mask);
+        for (int i = 0; i < 2; i++)
+        {
+            const int h = order[i];
+            const int index = my_applet[h];
+            OC_DEBUG_PROFILE_APPLET(h, HS::available_applets[index].id);
+            HS::applet_in(h)->BaseController(due & (1 << h));
+        }
+
 #ifdef ARDUINO_TEENSY41
         // auto-trigger outputs E..H
         for (int ch = 0; ch < 4; ++ch) {
@@ -543,14 +561,12 @@ public:
 
         if (draw_applets) {
           if (help_hemisphere > -1) {
-            int index = my_applet[help_hemisphere];
-            HS::available_applets[index].instance[help_hemisphere]->BaseView(true);
+            HS::applet_in(help_hemisphere)->BaseView(true);
             draw_applets = false;
           } else {
             for (int h = 0; h < 2; h++)
             {
-                int index = my_applet[h];
-                HS::available_applets[index].instance[h]->BaseView();
+                HS::applet_in(h)->BaseView();
             }
 
             if (select_mode == LEFT_HEMISPHERE) graphics.drawFrame(0, 0, 64, 64);
@@ -572,6 +588,9 @@ public:
         if (OC::CORE::ticks - HS::popup_tick < HEMISPHERE_CURSOR_TICKS * 2) {
           HS::DrawPopup(config_cursor, preset_id, CursorBlink());
         }
+
+        // Settings pages can change what applets show; redraw them all on the way back
+        if (!draw_applets) HemisphereApplet::InvalidateViews();
     }
 
     void DelegateEncoderPush(const UI::Event &event) {
@@ -603,8 +622,8 @@ public:
             select_mode = -1; // Pushing a button for the selected side turns off select mode
         } else if (!clock_setup) {
             // regular applets get button release
-            int index = my_applet[h];
-            HS::available_applets[index].instance[h]->OnButtonPress();
+            HS::applet_in(h)->OnButtonPress();
+            HS::applet_in(h)->MarkDirty();
         }
     }
 
@@ -705,12 +724,12 @@ public:
 
         // -- button release
         if (!clock_setup) {
-          const int index = my_applet[hemisphere];
-          HemisphereApplet* applet = HS::available_applets[index].instance[hemisphere];
+          HemisphereApplet* applet = HS::applet_in(hemisphere);
 
           if (applet->EditMode()) {
             // select button becomes aux button while editing a param
             applet->AuxButton();
+            applet->MarkDirty();
           } else {
             // Select Mode
             if (hemisphere == select_mode) select_mode = -1; // Exit Select Mode if same button is pressed
@@ -747,8 +766,8 @@ public:
         } else if (select_mode == h) {
             ChangeApplet(HEM_SIDE(h), event.value);
         } else {
-            int index = my_applet[h];
-            HS::available_applets[index].instance[h]->OnEncoderMove(event.value);
+            HS::applet_in(h)->OnEncoderMove(event.value);
+            HS::applet_in(h)->MarkDirty();
         }
     }
 
@@ -816,9 +835,12 @@ public:
 private:
     int preset_id = 0;
     int queued_preset = 0;
+    volatile int pending_preset = -1; // from the ISR, loaded by ApplyChanges()
     int preset_cursor = 0;
     int my_applet[2]; // Indexes to available_applets
-    int next_applet[2]; // queued from UI thread, handled by Controller
+    int next_applet[2]; // queued from UI thread, handled by ApplyChanges()
+    HS::AppletScheduler<2, OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST, ADC_CHANNEL_LAST> scheduler;
+    HS::ControlRateScheduler<2, HS::CONTROL_RATE_INTERVAL> control_rate;
     uint64_t clock_data, global_data, applet_data[2]; // cache of applet data
     bool clock_setup;
     int config_cursor = 0;
@@ -853,6 +875,8 @@ private:
         SCREENSAVER_MODE,
         CURSOR_MODE,
         AUTO_MIDI,
+        MIDI_CC_RES,
+        MIDI_CC_RATE,
 
         // Global Quantizers: 4x(Scale, Root, Octave, Mask?)
         QUANT1, QUANT2, QUANT3, QUANT4,
@@ -867,6 +891,9 @@ private:
 
         MAX_CURSOR = CVMAP4
     };
+public:
+    static constexpr int CONFIG_CURSOR_COUNT = MAX_CURSOR + 1;
+private:
 
     enum HEMConfigPage {
       LOADSAVE_POPUP,
@@ -893,7 +920,7 @@ private:
             config_cursor = constrain(config_cursor, 0, MAX_CURSOR);
 
             if (config_cursor < CONFIG_DUMMY) config_page = LOADSAVE_POPUP;
-            else if (config_cursor <= AUTO_MIDI) config_page = CONFIG_SETTINGS;
+            else if (config_cursor <= MIDI_CC_RATE) config_page = CONFIG_SETTINGS;
             else if (config_cursor < TRIGMAP1) config_page = QUANTIZER_SETTINGS;
             else if (config_cursor < SHOWHIDELIST) config_page = INPUT_SETTINGS;
             //else config_page = SHOWHIDE_APPLETS;
@@ -921,6 +948,9 @@ private:
         case TRIG_LENGTH:
             HS::trig_length = (uint32_t) constrain( int(HS::trig_length + dir), 1, 127);
             break;
+        case MIDI_CC_RATE:
+            HS::frame.MIDIState.cc_rate = constrain(HS::frame.MIDIState.cc_rate + dir, 0, HS::MIDI_CC_RATE_COUNT - 1);
+            break;
         //case SCREENSAVER_MODE:
             // TODO?
             //break;
@@ -1004,6 +1034,10 @@ private:
             HS::frame.autoMIDIOut = !HS::frame.autoMIDIOut;
             break;
 
+        case MIDI_CC_RES:
+            ++HS::frame.MIDIState.cc_resolution %= util::MIDI_CC_RESOLUTION_LAST;
+            break;
+
         case SHOWHIDELIST:
             if (h == 0) // left encoder inverts selection
             {
@@ -1110,8 +1144,8 @@ private:
            ++current, y += LineH) {
 
         if (!HS::applet_is_hidden(current))
-          gfxIcon(  12, y + 1, HS::available_applets[current].instance[0]->applet_icon());
-        gfxPrint( 23, y + 2, HS::available_applets[current].instance[0]->applet_name());
+          gfxIcon(  12, y + 1, HS::applet_icon(current));
+        gfxPrint( 23, y + 2, HS::applet_name(current));
 
         if (current == showhide_cursor.cursor_pos())
           gfxIcon(1, y + 1, RIGHT_ICON);
@@ -1143,6 +1177,12 @@ private:
         gfxPrint(1, 45, "Auto MIDI-Out:  ");
         gfxPrint( HS::frame.autoMIDIOut ? "On" : "Off" );
 
+        const char * const cc_res_name[util::MIDI_CC_RESOLUTION_LAST] = { "7bit", "14bit", "NRPN" };
+        gfxPrint(1, 55, "CC Out:  ");
+        gfxPrint(cc_res_name[HS::frame.MIDIState.cc_resolution]);
+        gfxPrint(91, 55, HS::MIDI_CC_RATES[HS::frame.MIDIState.cc_rate]);
+        gfxPrint("Hz");
+
         switch (config_cursor) {
         case CVMAP1:
         case CVMAP2:
@@ -1163,6 +1203,12 @@ private:
         case AUTO_MIDI:
             gfxIcon(90, 45, RIGHT_ICON);
             break;
+        case MIDI_CC_RES:
+            gfxIcon(43, 55, RIGHT_ICON);
+            break;
+        case MIDI_CC_RATE:
+            gfxCursor(91, 63, 36);
+            break;
         case CONFIG_DUMMY:
             gfxIcon(2, 1, LEFT_ICON);
             break;
@@ -1188,11 +1234,11 @@ private:
             if (!hem_presets[i].is_valid())
                 gfxPrint(18, y, "(empty)");
             else {
-                gfxIcon(18, y, hem_presets[i].GetApplet(0)->applet_icon());
-                gfxPrint(26, y, hem_presets[i].GetApplet(0)->applet_name());
+                gfxIcon(18, y, HS::applet_icon(hem_presets[i].GetAppletIndex(0)));
+                gfxPrint(26, y, HS::applet_name(hem_presets[i].GetAppletIndex(0)));
                 gfxPrint(", ");
-                gfxPrint(hem_presets[i].GetApplet(1)->applet_name());
-                gfxIcon(120, y, hem_presets[i].GetApplet(1)->applet_icon());
+                gfxPrint(HS::applet_name(hem_presets[i].GetAppletIndex(1)));
+                gfxIcon(120, y, HS::applet_icon(hem_presets[i].GetAppletIndex(1)));
             }
 
             y += 10;
@@ -1225,8 +1271,10 @@ SETTINGS_DECLARE(HemispherePreset, HEMISPHERE_SETTING_LAST) {
 HemisphereManager manager;
 
 void ReceiveManagerSysEx() {
+    static AppletProfileSysEx applet_profile;
     if (hem_active_preset)
         hem_active_preset->OnReceiveSysEx();
+    applet_profile.OnReceiveSysEx();
 }
 void BeatSyncProcess() {
   manager.ProcessQueue();
@@ -1275,6 +1323,7 @@ void FASTRUN HEMISPHERE_isr() {
 void HEMISPHERE_handleAppEvent(OC::AppEvent event) {
     switch (event) {
     case OC::APP_EVENT_RESUME:
+        HS::midi_events.Flush();
         manager.Resume();
         break;
 
@@ -1287,7 +1336,11 @@ void HEMISPHERE_handleAppEvent(OC::AppEvent event) {
     }
 }
 
-void HEMISPHERE_loop() {} // Essentially deprecated in favor of ISR
+void HEMISPHERE_loop() {
+    manager.ApplyChanges();
+    manager.PollMIDI();
+    HS::PollQuantizers();
+}
 
 void HEMISPHERE_menu() {
     manager.View();
@@ -411,6 +411,7 @@ public:
     bytebeat_.Init();
     int_seq_.Init(get_int_seq_start(), get_int_seq_length());
     quantizer_.Init();
+    quantizer_.EnableLookupTable(&quantizer_table_);
     update_scale(true, false);
     trigger_display_.Init();
     update_enabled_settings();
@@ -1092,6 +1093,7 @@ private:
   peaks::ByteBeat bytebeat_ ;
   util::IntegerSequence int_seq_ ;
   braids::Quantizer quantizer_;
+  braids::QuantizerLookupTable quantizer_table_;
   OC::DigitalInputDisplay trigger_display_;
 
   int num_enabled_settings_;
@@ -35,6 +35,7 @@
 #include "HSicons.h"
 #include "HSMIDI.h"
 #include "HSClockManager.h"
+#include "HSAppletScheduler.h"
 #include "AudioSetup.h"
 
 #include "hemisphere_config.h"
@@ -92,9 +93,8 @@ public:
     int GetAppletId(HEM_SIDE h) {
         return values_[QUADRANTS_SELECTED_LEFT_ID + h];
     }
-    HemisphereApplet* GetApplet(HEM_SIDE h) {
-      int idx = HS::get_applet_index_by_id( GetAppletId(h) );
-      return HS::available_applets[idx].instance[h];
+    int GetAppletIndex(HEM_SIDE h) {
+      return HS::get_applet_index_by_id( GetAppletId(h) );
     }
     void SetAppletId(HEM_SIDE h, int id) {
         apply_value(h, id);
@@ -248,7 +248,7 @@ public:
         for (int i = 0; i < 4; ++i) {
             quant_scale[i] = OC::Scales::SCALE_SEMI;
             quantizer[i].Init();
-            quantizer[i].Configure(OC::Scales::GetScale(quant_scale[i]), 0xffff);
+            quantizer_bank.Configure(i, OC::Scales::GetScale(quant_scale[i]), 0xffff);
         }
 
         SetApplet(HEM_SIDE(0), HS::get_applet_index_by_id(18)); // DualTM
@@ -258,6 +258,13 @@ public:
     }
 
     void Resume() {
+        OC::DEBUG::ResetAppletCycles();
+        // Hemisphere shares the slots, and may have put its own applets there
+        for (int h = 0; h < APPLET_SLOTS; h++)
+        {
+            if (HS::applet_slots[h].index != active_applet_index[h] || !HS::applet_in(h))
+                SetApplet(HEM_SIDE(h), active_applet_index[h]);
+        }
         if (!quad_active_preset)
             LoadFromPreset(0);
         // TODO: restore quantizer settings...
@@ -280,7 +287,7 @@ public:
                 doSave = 1;
             quad_active_preset->SetAppletId(HEM_SIDE(h), HS::available_applets[index].id);
 
-            uint64_t data = HS::available_applets[index].instance[h]->OnDataRequest();
+            uint64_t data = active_applet[h]->OnDataRequest();
             if (data != applet_data[h]) doSave = 1;
             applet_data[h] = data;
             quad_active_preset->SetData(HEM_SIDE(h), data);
@@ -323,14 +330,15 @@ public:
                 int index = HS::get_applet_index_by_id( quad_active_preset->GetAppletId(HEM_SIDE(h)) );
                 applet_data[h] = quad_active_preset->GetData(HEM_SIDE(h));
                 SetApplet(HEM_SIDE(h), index);
-                HS::available_applets[index].instance[h]->OnDataReceive(applet_data[h]);
+                active_applet[h]->OnDataReceive(applet_data[h]);
             }
         }
         preset_id = id;
         PokePopup(PRESET_POPUP);
     }
+    // ISR side: applets can only change hands in loop()
     void ProcessQueue() {
-      LoadFromPreset(queued_preset);
+      pending_preset = queued_preset;
     }
     void QueuePresetLoad(int id) {
       if (HS::clock_m.IsRunning()) {
@@ -338,25 +346,36 @@ public:
         HS::clock_m.BeatSync( &QuadrantBeatSync );
       }
       else
+        pending_preset = id;
+    }
+    // loop side: preset loads and applet changes queued since last time
+    void ApplyChanges() {
+      // take and clear in one go, or a preset queued in between is lost
+      __disable_irq();
+      const int id = pending_preset;
+      pending_preset = -1;
+      __enable_irq();
+      if (id >= 0)
         LoadFromPreset(id);
+      for (int h = 0; h < APPLET_SLOTS; h++)
+      {
+        if (active_applet_index[h] != next_applet_index[h])
+          SetApplet(HEM_SIDE(h), next_applet_index[h]);
+      }
     }
 
     // does not modify the preset, only the quad_manager
     void SetApplet(HEM_SIDE hemisphere, int index) {
-        if (active_applet[hemisphere])
-          active_applet[hemisphere]->Unload();
-
         next_applet_index[hemisphere] = active_applet_index[hemisphere] = index;
-        active_applet[hemisphere] = HS::available_applets[index].instance[hemisphere];
-        active_applet[hemisphere]->BaseStart(hemisphere);
+        active_applet[hemisphere] = HS::StartApplet(hemisphere, index);
     }
     void ChangeApplet(HEM_SIDE h, int dir) {
         int index = HS::get_next_applet_index(next_applet_index[h], dir);
         next_applet_index[h] = index;
     }
 
-    template <typename T1, typename T2, typename T3>
-    void ProcessMIDI(T1 &device, T2 &next_device, T3 &dev3) {
+    template <typename T>
+    void PollMIDI(T &device, HS::MIDIPort port) {
         while (device.read()) {
             const int message = device.getType();
             const int data1 = device.getData1();
@@ -367,37 +386,48 @@ public:
                 continue;
             }
 
-            if (message == usbMIDI.ProgramChange) {
-                int slot = device.getData1();
+            HS::RouteMIDIInput(port, message, device.getChannel(), data1, data2);
+        }
+    }
+
+    // Called from loop(): reads all MIDI ports, routes messages to the other
+    // ports and queues them for ProcessMIDI()
+    void PollMIDI() {
+        PollMIDI(usbMIDI, HS::MIDI_PORT_USB);
+        thisUSB.Task();
+        PollMIDI(usbHostMIDI, HS::MIDI_PORT_USB_HOST);
+        PollMIDI(MIDI1, HS::MIDI_PORT_DIN);
+    }
+
+    // ISR side: handles a bounded number of queued events per tick
+    void ProcessMIDI() {
+        HS::MIDIEvent event;
+        for (int i = 0; i < HS::kMIDIEventsPerTick && HS::midi_events.Pop(event); ++i) {
+            if (event.message == usbMIDI.ProgramChange) {
+                int slot = event.data1;
                 if (slot < QUAD_PRESET_COUNT) {
                   QueuePresetLoad(slot);
                 }
                 continue;
             }
 
-            HS::frame.MIDIState.ProcessMIDIMsg(device.getChannel(), message, data1, data2);
-            next_device.send(message, data1, data2, device.getChannel(), 0);
-            dev3.send((midi::MidiType)message, data1, data2, device.getChannel());
+            HS::frame.MIDIState.ProcessMIDIMsg(event.channel, event.message, event.data1, event.data2);
         }
     }
 
     void Controller() {
         // top-level MIDI-to-CV handling - alters frame outputs
-        ProcessMIDI(usbMIDI, usbHostMIDI, MIDI1);
-        thisUSB.Task();
-        ProcessMIDI(usbHostMIDI, usbMIDI, MIDI1);
-        ProcessMIDI(MIDI1, usbMIDI, usbHostMIDI);
+        ProcessMIDI();
 
         // Clock Setup applet handles internal clock duties
-        ClockSetup_instance.Controller();
+        {
+          OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::CLOCK_cycles);
+          ClockSetup_instance.Controller();
+        }
 
         // execute Applets
         for (int h = 0; h < APPLET_SLOTS; h++)
         {
-            if (active_applet_index[h] != next_applet_index[h]) {
-              SetApplet(HEM_SIDE(h), next_applet_index[h]);
-            }
-
             // MIDI signals mixed with inputs to applets
             if (HS::available_applets[ active_applet_index[h] ].id != 150) // not MIDI In
             {
@@ -413,12 +443,12 @@ public:
                         HS::frame.inputs[chan] += HS::frame.MIDIState.outputs[chan];
                         break;
                     case HEM_MIDI_GATE_OUT:
-                        HS::frame.gate_high[chan] |= (HS::frame.MIDIState.outputs[chan] > (12 << 7));
+                        HS::frame.gate_mask |= (HS::frame.MIDIState.outputs[chan] > (12 << 7)) << chan;
                         break;
                     case HEM_MIDI_TRIG_OUT:
                     case HEM_MIDI_CLOCK_OUT:
                     case HEM_MIDI_START_OUT:
-                        HS::frame.clocked[chan] |= HS::frame.MIDIState.trigout_q[chan];
+                        HS::frame.clocked_mask |= HS::frame.MIDIState.trigout_q[chan] << chan;
                         HS::frame.MIDIState.trigout_q[chan] = 0;
                         break;
                     }
@@ -426,10 +456,22 @@ public:
             }
             if (HS::clock_m.auto_reset)
                 active_applet[h]->Reset();
-
-            active_applet[h]->BaseController();
         }
         HS::clock_m.auto_reset = false;
+
+        // upstream applets first, so chained outputs arrive this tick
+        const uint8_t *order = scheduler.Update(HS::trigger_mapping, HS::cvmapping);
+        uint8_t slow_mask = 0;
+        for (int h = 0; h < APPLET_SLOTS; h++) {
+            if (active_applet[h]->GetControlRate() != HS::CONTROL_RATE_FULL) slow_mask |= 1 << h;
+        }
+        const uint8_t due = control_rate.Update(slow_mask);
+        for (int i = 0; i < APPLET_SLOTS; i++)
+        {
+            const int h = order[i];
+            OC_DEBUG_PROFILE_APPLET(h, HS::available_applets[ active_applet_index[h] ].id);
+            active_applet[h]->BaseController(due & (1 << h));
+        }
     }
 
     void View() {
@@ -513,6 +555,9 @@ public:
         if (OC::CORE::ticks - HS::popup_tick < HEMISPHERE_CURSOR_TICKS * 2) {
           HS::DrawPopup(config_cursor, preset_id, CursorBlink());
         }
+
+        // Settings pages can change what applets show; redraw them all on the way back
+        if (!draw_applets) HemisphereApplet::InvalidateViews();
     }
 
     // always act-on-press for encoder
@@ -535,6 +580,7 @@ public:
         }
 
         active_applet[slot]->OnButtonPress();
+        active_applet[slot]->MarkDirty();
     }
 
     const HEM_SIDE ButtonToSlot(const UI::Event &event) {
@@ -593,6 +639,7 @@ public:
         // A/B/X/Y buttons becomes aux button while editing a param
         if (SlotIsVisible(slot) && active_applet[slot]->EditMode()) {
           active_applet[slot]->AuxButton();
+          active_applet[slot]->MarkDirty();
           return true;
         }
 
@@ -627,6 +674,7 @@ public:
             ChangeApplet(slot, event.value);
         } else {
             active_applet[slot]->OnEncoderMove(event.value);
+            active_applet[slot]->MarkDirty();
         }
     }
 
@@ -768,12 +816,15 @@ public:
 private:
     int preset_id = 0;
     int queued_preset = 0;
+    volatile int pending_preset = -1; // from the ISR, loaded by ApplyChanges()
     int preset_cursor = 0;
     HemisphereApplet *active_applet[4]; // Pointers to actual applets
     int active_applet_index[4]; // Indexes to available_applets
                       // Left side: 0,2
                       // Right side: 1,3
-    int next_applet_index[4]; // queued from UI thread, handled by Controller
+    int next_applet_index[4]; // queued from UI thread, handled by ApplyChanges()
+    HS::AppletScheduler<APPLET_SLOTS, OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST, ADC_CHANNEL_LAST> scheduler;
+    HS::ControlRateScheduler<APPLET_SLOTS, HS::CONTROL_RATE_INTERVAL> control_rate;
     uint64_t clock_data, global_data, applet_data[4]; // cache of applet data
     bool view_slot[2] = {0, 0}; // Two applets on each side, only one visible at a time
     int config_cursor = 0;
@@ -1096,9 +1147,9 @@ private:
             if (!quad_presets[i].is_valid())
                 gfxPrint(18, y, "(empty)");
             else {
-                gfxPrint(18, y, quad_presets[i].GetApplet(LEFT_HEMISPHERE)->applet_name());
+                gfxPrint(18, y, HS::applet_name(quad_presets[i].GetAppletIndex(LEFT_HEMISPHERE)));
                 gfxPrint(", ");
-                gfxPrint(quad_presets[i].GetApplet(RIGHT_HEMISPHERE)->applet_name());
+                gfxPrint(HS::applet_name(quad_presets[i].GetAppletIndex(RIGHT_HEMISPHERE)));
             }
 
             y += 10;
@@ -1145,8 +1196,10 @@ SETTINGS_DECLARE(QuadrantsPreset, QUADRANTS_SETTING_LAST) {
 QuadAppletManager quad_manager;
 
 void QuadrantSysExHandler() {
+    static AppletProfileSysEx applet_profile;
     if (quad_active_preset)
         quad_active_preset->OnReceiveSysEx();
+    applet_profile.OnReceiveSysEx();
 }
 void QuadrantBeatSync() {
   quad_manager.ProcessQueue();
@@ -1188,6 +1241,7 @@ void FASTRUN QUADRANTS_isr() {
 void QUADRANTS_handleAppEvent(OC::AppEvent event) {
     switch (event) {
     case OC::APP_EVENT_RESUME:
+        HS::midi_events.Flush();
         quad_manager.Resume();
         break;
 
@@ -1200,7 +1254,11 @@ void QUADRANTS_handleAppEvent(OC::AppEvent event) {
     }
 }
 
-void QUADRANTS_loop() {} // Essentially deprecated in favor of ISR
+void QUADRANTS_loop() {
+    quad_manager.ApplyChanges();
+    quad_manager.PollMIDI();
+    HS::PollQuantizers();
+}
 
 void QUADRANTS_menu() {
     quad_manager.View();
@@ -30,6 +30,7 @@
 #include "OC_strings.h"
 #include "util/util_settings.h"
 #include "OC_autotuner.h"
+#include "HSFixed.h"
 #include "src/drivers/FreqMeasure/OC_FreqMeasure.h"
 
 // 
@@ -256,13 +257,14 @@ public:
       freq_count_ = freq_count_ + 1;
       
       if (milliseconds_since_last_freq_ > 750) {
-        frequency_ = FreqMeasure.countToFrequency(freq_sum_ / freq_count_);
+        // clock / (sum / count), in Q16 Hz
+        frequency_ = HS::Q16Ratio(uint64_t(FreqMeasure.timer_clock()) * freq_count_, freq_sum_);
         freq_sum_ = 0;
         freq_count_ = 0;
         milliseconds_since_last_freq_ = 0;
        }
      } else if (milliseconds_since_last_freq_ > 100000) {
-      frequency_ = 0.0f;
+      frequency_ = 0;
      }
   }
 
@@ -278,7 +280,7 @@ public:
   ReferenceChannel channels_[DAC_CHANNEL_LAST];
 
   float get_frequency( ) {
-    return(frequency_) ;
+    return(HS::q162float(frequency_)) ;
   }
 
   float get_ppqn() {
@@ -322,7 +324,7 @@ public:
   }
 
   float get_bpm( ) {
-    return((60.0 * frequency_)/get_ppqn()) ;
+    return((60.0 * get_frequency())/get_ppqn()) ;
   }
 
   bool get_notes_or_bpm( ) {
@@ -334,9 +336,9 @@ public:
   }
 
 private:
-  double freq_sum_;
+  uint64_t freq_sum_;
   uint32_t freq_count_;
-  float frequency_ ;
+  uint32_t frequency_ ; // Q16 Hz, the display converts
   elapsedMillis milliseconds_since_last_freq_;
 };
 
@@ -144,12 +144,7 @@ public:
 
         // initiate actual EEPROM save - ONLY if necessary!
         if (preset_modified) {
-            OC::CORE::app_isr_enabled = false;
-            OC::draw_save_message(60);
-            delay(1);
             OC::save_app_data();
-            delay(1);
-            OC::CORE::app_isr_enabled = true;
         }
 
         preset_modified = 0;
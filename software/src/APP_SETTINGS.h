@@ -392,7 +392,9 @@ public:
     }
     void Reflash() {
       uint32_t start = millis();
-      while(millis() < start + SETTINGS_SAVE_TIMEOUT_MS) {
+      // Settings saved just before still need writing out
+      while(millis() < start + SETTINGS_SAVE_TIMEOUT_MS || OC::app_data_pending()) {
+        OC::poll_app_data();
         GRAPHICS_BEGIN_FRAME(true);
         graphics.setPrintPos(5, 10);
         graphics.print("Flash Upgrade Mode");
@@ -0,0 +1,235 @@
+#pragma once
+
+// Block-based Q15 kernels for the T4.1 audio chain
+//
+// Both audio channels travel together: each uint32_t holds one sample
+// frame, left channel in the bottom half and right channel in the top half.
+// That way one qadd16/qsub16 steps both channels, and the per-channel
+// coefficients are packed the same way.
+//
+// Each kernel has a scalar reference (suffix _Ref) that works on plain int16
+// per channel. The packed versions must produce bit-identical results; the
+// host tests in software/test check that and time both. On Cortex-M4/M7
+// the q15:: primitives below are single DSP instructions from dspinst.h.
+// Elsewhere they are plain C with the same rounding and saturation, which
+// makes the packed path slower than the reference on the host.
+
+#include <stdint.h>
+#if defined(__ARM_ARCH_7EM__)
+#include "extern/dspinst.h"
+#endif
+
+namespace OC {
+  namespace AudioDSP {
+
+    // Parameters are stepped once per kernel block
+    static constexpr int KERNEL_BLOCK_SIZE = 32;
+
+    namespace q15 {
+
+      static inline int16_t saturate(int32_t val) {
+#if defined(__ARM_ARCH_7EM__)
+        return saturate16(val);
+#else
+        if (val > 32767) val = 32767;
+        else if (val < -32768) val = -32768;
+        return val;
+#endif
+      }
+
+      static inline int32_t lo(uint32_t a) { return (int16_t)(a & 0xffff); }
+      static inline int32_t hi(uint32_t a) { return (int16_t)(a >> 16); }
+      // lo for channel 0 (left), hi for channel 1 (right)
+      static inline int32_t half(uint32_t a, int ch) { return ch ? hi(a) : lo(a); }
+
+      // (hi << 16) | (lo & 0xffff)
+      static inline uint32_t pack(int32_t hi, int32_t lo) {
+#if defined(__ARM_ARCH_7EM__)
+        return pack_16b_16b(hi, lo);
+#else
+        return ((uint32_t)hi << 16) | ((uint32_t)lo & 0xffff);
+#endif
+      }
+
+      // Saturating add/subtract of both halves
+      static inline uint32_t add(uint32_t a, uint32_t b) {
+#if defined(__ARM_ARCH_7EM__)
+        return signed_add_16_and_16(a, b);
+#else
+        return pack(saturate(hi(a) + hi(b)), saturate(lo(a) + lo(b)));
+#endif
+      }
+
+      static inline uint32_t sub(uint32_t a, uint32_t b) {
+#if defined(__ARM_ARCH_7EM__)
+        return (uint32_t)signed_subtract_16_and_16(a, b);
+#else
+        return pack(saturate(hi(a) - hi(b)), saturate(lo(a) - lo(b)));
+#endif
+      }
+
+      // Products of the bottom and top halves
+      static inline int32_t mul_lo(uint32_t a, uint32_t b) {
+#if defined(__ARM_ARCH_7EM__)
+        return multiply_16bx16b(a, b);
+#else
+        return lo(a) * lo(b);
+#endif
+      }
+
+      static inline int32_t mul_hi(uint32_t a, uint32_t b) {
+#if defined(__ARM_ARCH_7EM__)
+        return multiply_16tx16t(a, b);
+#else
+        return hi(a) * hi(b);
+#endif
+      }
+
+      // Dual MAC: lo(a) * lo(b) + hi(a) * hi(b)
+      static inline int32_t dot(uint32_t a, uint32_t b) {
+#if defined(__ARM_ARCH_7EM__)
+        return multiply_16tx16t_add_16bx16b(a, b);
+#else
+        return lo(a) * lo(b) + hi(a) * hi(b);
+#endif
+      }
+
+      // Both halves of (a * b) >> shift, saturated
+      template <int shift>
+      static inline uint32_t mul(uint32_t a, uint32_t b) {
+        return pack(saturate(mul_hi(a, b) >> shift), saturate(mul_lo(a, b) >> shift));
+      }
+
+    } // namespace q15
+
+    /* ---- VCA ----
+     * out = in * gain >> 15, gain in [-32767, 32767]; negative gain inverts.
+     * The gain ramps linearly from its previous value to the target over the
+     * block, so CV changes don't zipper. The step is truncated, so the last
+     * sample snaps to the target rather than leaving the remainder for a jump
+     * at the start of the next block. Returns with state.gain == target.
+     */
+    struct VCAState {
+      uint32_t gain; // packed
+    };
+
+    static inline void VCABlock(uint32_t *io, int n, VCAState &state, uint32_t target) {
+      const uint32_t gain0 = state.gain;
+      const uint32_t step = q15::pack((q15::hi(target) - q15::hi(gain0)) / n,
+                                      (q15::lo(target) - q15::lo(gain0)) / n);
+      uint32_t gain = gain0;
+      for (int i = 0; i < n - 1; ++i) {
+        gain = q15::add(gain, step);
+        io[i] = q15::mul<15>(io[i], gain);
+      }
+      io[n - 1] = q15::mul<15>(io[n - 1], target);
+      state.gain = target;
+    }
+
+    static inline void VCABlock_Ref(int16_t *io, int n, int16_t &state, int16_t target) {
+      const int32_t step = (target - state) / n;
+      int32_t gain = state;
+      for (int i = 0; i < n - 1; ++i) {
+        gain = q15::saturate(gain + step);
+        io[i] = q15::saturate((io[i] * gain) >> 15);
+      }
+      io[n - 1] = q15::saturate((io[n - 1] * target) >> 15);
+      state = target;
+    }
+
+    /* ---- State-variable filter ----
+     * Chamberlin SVF, one sample per iteration. f = 2 sin(pi * fc / fs) in
+     * Q15 and damping q = 1 / Q in Q14 (so 0..2). The topology is only stable
+     * for f < 2 - q; AudioSetup.cpp caps f at kMaxSVF_f for its fixed q.
+     */
+    enum SVFOutput {
+      SVF_LOWPASS,
+      SVF_BANDPASS,
+      SVF_HIGHPASS,
+    };
+
+    struct SVFState {
+      uint32_t lp, bp; // packed
+    };
+
+    static inline void SVFBlock(uint32_t *io, int n, SVFState &state,
+                                uint32_t f, uint32_t q, SVFOutput output) {
+      uint32_t lp = state.lp;
+      uint32_t bp = state.bp;
+      for (int i = 0; i < n; ++i) {
+        lp = q15::add(lp, q15::mul<15>(f, bp));
+        const uint32_t hp = q15::sub(q15::sub(io[i], lp), q15::mul<14>(q, bp));
+        bp = q15::add(bp, q15::mul<15>(f, hp));
+        io[i] = output == SVF_LOWPASS ? lp : output == SVF_BANDPASS ? bp : hp;
+      }
+      state.lp = lp;
+      state.bp = bp;
+    }
+
+    static inline void SVFBlock_Ref(int16_t *io, int n, int16_t &lp, int16_t &bp,
+                                    int16_t f, int16_t q, SVFOutput output) {
+      for (int i = 0; i < n; ++i) {
+        lp = q15::saturate(lp + q15::saturate((f * bp) >> 15));
+        int16_t hp = q15::saturate(io[i] - lp);
+        hp = q15::saturate(hp - q15::saturate((q * bp) >> 14));
+        bp = q15::saturate(bp + q15::saturate((f * hp) >> 15));
+        io[i] = output == SVF_LOWPASS ? lp : output == SVF_BANDPASS ? bp : hp;
+      }
+    }
+
+    /* ---- Wavefolder ----
+     * The input is amplified by drive (Q12, so up to 8x) and reflected back
+     * into range at full scale, then crossfaded with the dry signal by amount
+     * (Q15). Both channels go through one dual MAC each for the crossfade.
+     */
+    static inline int32_t Fold(int32_t x) {
+      // triangle with a period of 2^17 that is the identity on [-32768, 32767]
+      int32_t t = (x + 32768) & 0x1ffff;
+      if (t > 65535) t = 131071 - t;
+      return t - 32768;
+    }
+
+    struct WavefoldParams {
+      uint32_t drive; // packed Q12
+      uint32_t mix_left; // (amount << 16) | (32767 - amount), Q15
+      uint32_t mix_right;
+    };
+
+    static inline uint32_t WavefoldMix(int16_t amount) {
+      return q15::pack(amount, 32767 - amount);
+    }
+
+    static inline void WavefoldBlock(uint32_t *io, int n, const WavefoldParams &params) {
+      for (int i = 0; i < n; ++i) {
+        const uint32_t dry = io[i];
+        const uint32_t folded = q15::pack(Fold(q15::mul_hi(dry, params.drive) >> 12),
+                                          Fold(q15::mul_lo(dry, params.drive) >> 12));
+        // (folded, dry) pairs per channel against (amount, 1 - amount)
+        const int32_t left = q15::dot(q15::pack(q15::lo(folded), q15::lo(dry)), params.mix_left);
+        const int32_t right = q15::dot(q15::pack(q15::hi(folded), q15::hi(dry)), params.mix_right);
+        io[i] = q15::pack(q15::saturate(right >> 15), q15::saturate(left >> 15));
+      }
+    }
+
+    static inline void WavefoldBlock_Ref(int16_t *io, int n, int16_t drive, int16_t amount) {
+      for (int i = 0; i < n; ++i) {
+        const int32_t folded = Fold((io[i] * drive) >> 12);
+        io[i] = q15::saturate((folded * amount + io[i] * (32767 - amount)) >> 15);
+      }
+    }
+
+    /* ---- Packing ---- */
+    static inline void Interleave(const int16_t *left, const int16_t *right, uint32_t *out, int n) {
+      for (int i = 0; i < n; ++i)
+        out[i] = q15::pack(right[i], left[i]);
+    }
+
+    static inline void Deinterleave(const uint32_t *in, int16_t *left, int16_t *right, int n) {
+      for (int i = 0; i < n; ++i) {
+        left[i] = q15::lo(in[i]);
+        right[i] = q15::hi(in[i]);
+      }
+    }
+
+  } // AudioDSP namespace
+} // OC namespace
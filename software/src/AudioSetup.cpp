@@ -6,6 +6,121 @@
 #include "HSUtils.h"
 #include "HSicons.h"
 #include "OC_strings.h"
+#include "OC_options.h"
+
+#if defined(AUDIO_BLOCK_KERNELS)
+#include "AudioKernels.h"
+
+// Both channels run through one AudioKernelChain: VCA, then SVF, then
+// wavefolder, in Q15 (see AudioKernels.h). Parameters are latched from the
+// Controller thread and stepped every KERNEL_BLOCK_SIZE samples.
+//
+// By default each channel goes through the scalar _Ref kernels. With
+// AUDIO_PACKED_KERNELS the chain runs the packed stereo kernels instead;
+// that is only a win if the DSP instructions pay for the interleaving, so
+// compare AudioProcessorUsage() on the debug page before switching.
+class AudioKernelChain : public AudioStream {
+public:
+  AudioKernelChain() : AudioStream(2, inputQueueArray) { }
+
+  // Targets, written from Process(); each is a single 32-bit store
+  volatile uint32_t gain = 0x7fff7fff;
+  volatile uint32_t svf_f = 0;
+  volatile uint32_t svf_q = 0;
+  volatile uint32_t fold_drive = 0;
+  volatile uint32_t fold_mix[2] = { 0, 0 };
+  volatile uint8_t svf_enabled = 0; // bitmask of channels
+  volatile OC::AudioDSP::SVFOutput svf_output = OC::AudioDSP::SVF_LOWPASS;
+
+  virtual void update(void);
+
+private:
+  audio_block_t *inputQueueArray[2];
+#if defined(AUDIO_PACKED_KERNELS)
+  OC::AudioDSP::VCAState vca_ = { 0 };
+  OC::AudioDSP::SVFState svf_ = { 0, 0 };
+  uint32_t frames_[AUDIO_BLOCK_SAMPLES];
+#else
+  int16_t gain_[2] = { 0, 0 };
+  int16_t lp_[2] = { 0, 0 }, bp_[2] = { 0, 0 };
+#endif
+};
+
+void AudioKernelChain::update(void) {
+  using namespace OC::AudioDSP;
+
+  audio_block_t *left = receiveWritable(0);
+  audio_block_t *right = receiveWritable(1);
+  if (!left || !right) {
+    if (left) release(left);
+    if (right) release(right);
+    return;
+  }
+
+  const uint8_t filter = svf_enabled;
+  const SVFOutput output = svf_output;
+
+#if defined(AUDIO_PACKED_KERNELS)
+  Interleave(left->data, right->data, frames_, AUDIO_BLOCK_SAMPLES);
+
+  WavefoldParams fold = { fold_drive, fold_mix[0], fold_mix[1] };
+  const bool folding = (fold.mix_left | fold.mix_right) & 0xffff0000;
+
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i += KERNEL_BLOCK_SIZE) {
+    uint32_t *block = frames_ + i;
+    VCABlock(block, KERNEL_BLOCK_SIZE, vca_, gain);
+    if (filter) {
+      uint32_t dry[KERNEL_BLOCK_SIZE];
+      if (filter != 0x3) memcpy(dry, block, sizeof(dry));
+      SVFBlock(block, KERNEL_BLOCK_SIZE, svf_, svf_f, svf_q, output);
+      // one side bypassed: put its dry half back
+      if (filter == 0x1) {
+        for (int j = 0; j < KERNEL_BLOCK_SIZE; ++j)
+          block[j] = (dry[j] & 0xffff0000) | (block[j] & 0xffff);
+      } else if (filter == 0x2) {
+        for (int j = 0; j < KERNEL_BLOCK_SIZE; ++j)
+          block[j] = (block[j] & 0xffff0000) | (dry[j] & 0xffff);
+      }
+    }
+    if (folding)
+      WavefoldBlock(block, KERNEL_BLOCK_SIZE, fold);
+  }
+
+  Deinterleave(frames_, left->data, right->data, AUDIO_BLOCK_SAMPLES);
+#else
+  const uint32_t target = gain, f = svf_f, q = svf_q, drive = fold_drive;
+  audio_block_t *blocks[2] = { left, right };
+
+  for (int ch = 0; ch < 2; ++ch) {
+    const int16_t amount = q15::hi(fold_mix[ch]); // see WavefoldMix()
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i += KERNEL_BLOCK_SIZE) {
+      int16_t *block = blocks[ch]->data + i;
+      VCABlock_Ref(block, KERNEL_BLOCK_SIZE, gain_[ch], q15::half(target, ch));
+      if (filter & (1 << ch))
+        SVFBlock_Ref(block, KERNEL_BLOCK_SIZE, lp_[ch], bp_[ch],
+                     q15::half(f, ch), q15::half(q, ch), output);
+      if (amount)
+        WavefoldBlock_Ref(block, KERNEL_BLOCK_SIZE, q15::half(drive, ch), amount);
+    }
+  }
+#endif
+
+  transmit(left, 0);
+  transmit(right, 1);
+  release(left);
+  release(right);
+}
+
+AudioInputI2S2           i2s1;
+AudioKernelChain         kernels;
+AudioOutputI2S2          i2s2;
+
+AudioConnection          patchCord1(i2s1, 0, kernels, 0);
+AudioConnection          patchCord2(i2s1, 1, kernels, 1);
+AudioConnection          patchCord3(kernels, 0, i2s2, 0);
+AudioConnection          patchCord4(kernels, 1, i2s2, 1);
+
+#else
 
 // Use the web GUI tool as a guide: https://www.pjrc.com/teensy/gui/
 
@@ -54,6 +169,7 @@ AudioConnection          patchCord21(mixer3, 0, i2s2, 0);
 //AudioConnection          patchCord25(freeverb1, 0, mixer3, 1);
 //AudioConnection          patchCord26(freeverb1, 0, mixer4, 2);
 // GUItool: end automatically generated code
+#endif
 
 // Notes:
 //
@@ -103,6 +219,58 @@ namespace OC {
     float foldamt[2] = { 0.0, 0.0 };
 
 
+#if defined(AUDIO_BLOCK_KERNELS)
+    // Kernel chain parameters, per channel, unpacked
+    static int16_t svf_f[2], fold_amount[2];
+    static uint8_t filter_enabled = 0;
+    static constexpr float kAttenuation = 0.85; // before filter, as amp1/amp2
+    static constexpr float kResonance = 1.05;
+    static constexpr int16_t kMaxSVF_f = 29491; // 0.9 in Q15, ~6.5kHz
+
+    // Symmetric, so a negative level inverts as the mixer gains did
+    static int16_t to_q15(float x) {
+      return (int16_t)constrain(x * 32767.0f, -32767.0f, 32767.0f);
+    }
+
+    static void UpdateGains() {
+      int16_t gain[2];
+      for (int ch = 0; ch < 2; ++ch)
+        gain[ch] = to_q15(amplevel[ch] * kAttenuation);
+      kernels.gain = q15::pack(gain[1], gain[0]);
+    }
+
+    void BypassFilter(int ch) {
+      filter_enabled &= ~(1 << ch);
+      kernels.svf_enabled = filter_enabled;
+    }
+
+    void EnableFilter(int ch) {
+      filter_enabled |= (1 << ch);
+      kernels.svf_enabled = filter_enabled;
+    }
+
+    void ModFilter(int ch, int cv) {
+      // same cutoff curve as the Audio library filters
+      float freq = abs(cv) / 64 + bias[ch][FILTER_CUTOFF];
+      freq *= freq;
+      // past Nyquist the sine folds back down and then goes negative
+      freq = constrain(freq, 0.0f, AUDIO_SAMPLE_RATE_EXACT / 2);
+
+      svf_f[ch] = min(to_q15(2.0f * sinf(PI * freq / AUDIO_SAMPLE_RATE_EXACT)), kMaxSVF_f);
+      kernels.svf_f = q15::pack(svf_f[1], svf_f[0]);
+    }
+
+    void Wavefold(int ch, int cv) {
+      foldamt[ch] = (float)cv / MAX_CV + bias[ch][WAVEFOLD_MOD];
+      fold_amount[ch] = to_q15(abs(foldamt[ch]) * 0.9);
+      kernels.fold_mix[ch] = WavefoldMix(fold_amount[ch]);
+    }
+
+    void AmpLevel(int ch, int cv) {
+      amplevel[ch] = (float)cv / MAX_CV + bias[ch][AMP_LEVEL];
+      UpdateGains();
+    }
+#else
     // Right side state variable filter functions
     void SelectHPF() {
       mixer2.gain(0, 0.0); // LPF
@@ -185,9 +353,21 @@ namespace OC {
         mixer4.gain(0, amplevel[ch] * (1.0 - abs(foldamt[ch])));
     }
 
+#endif
+
     // Designated Integration Functions
     // ----- called from setup() in Main.cpp
     void Init() {
+#if defined(AUDIO_BLOCK_KERNELS)
+      AudioMemory(16);
+
+      const int16_t q = 16384 / kResonance; // damping, Q14
+      kernels.svf_q = q15::pack(q, q);
+      kernels.fold_drive = q15::pack(4 << 12, 4 << 12); // 4x into the folder
+      BypassFilter(0);
+      BypassFilter(1);
+      UpdateGains();
+#else
       AudioMemory(128);
 
       amp1.gain(0.85); // attenuate before filter
@@ -218,7 +398,7 @@ namespace OC {
       mixer4.gain(1, 0.08); // verb2
       mixer4.gain(2, 0.05); // verb1
       */
-      
+#endif
     }
 
     // ----- called from Controller thread
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace HS {
+
+// AppletScheduler: per-tick order of applet Controller() calls
+//
+// An applet reading another applet's output through trigger_mapping or
+// cvmapping used to see last tick's value, since slots always ran in order.
+// The scheduler builds the dependency graph from the mappings and runs each
+// upstream applet before the ones it feeds.
+//
+// Mapping values follow HemisphereApplet::Clock()/Gate()/In(): 0 is "none",
+// values above TRIG_OUT (trigger_mapping) or CV_OUT (cvmapping) select
+// output (value - 1 - offset). Each slot owns two consecutive channels.
+//
+// Cycles are broken deterministically: when no slot is ready, the lowest
+// slot that is part of a cycle runs next. For inputs inside the cycle it
+// keeps reading the previous tick, which is what it did before.
+template <int SLOTS, int TRIG_OUT, int CV_OUT>
+class AppletScheduler {
+public:
+  static constexpr int kChannels = SLOTS * 2;
+
+  // Returns the slot order for this tick, rebuilding it if the mappings
+  // changed since the last call. trigmap and cvmap are indexed by channel.
+  const uint8_t *Update(const int *trigmap, const int *cvmap) {
+    bool changed = !valid_;
+    for (int i = 0; i < kChannels; ++i) {
+      if (trigmap[i] != trigmap_[i] || cvmap[i] != cvmap_[i]) {
+        trigmap_[i] = trigmap[i];
+        cvmap_[i] = cvmap[i];
+        changed = true;
+      }
+    }
+    if (changed) Build();
+    return order_;
+  }
+
+  void Invalidate() { valid_ = false; }
+
+  const uint8_t *order() const { return order_; }
+
+  // Slots that had an input dropped to break a cycle
+  uint8_t cycle_mask() const { return cycle_mask_; }
+
+  // Upstream slots of each slot, as a bitmask
+  uint8_t depends_on(int slot) const { return depends_[slot]; }
+
+private:
+  static_assert(SLOTS <= 8, "slot masks are 8 bits");
+
+  bool valid_ = false;
+  int trigmap_[kChannels];
+  int cvmap_[kChannels];
+  uint8_t depends_[SLOTS];
+  uint8_t order_[SLOTS];
+  uint8_t cycle_mask_ = 0;
+
+  // Slot whose output a mapping value refers to, or -1
+  static int source_slot(int value, int offset) {
+    const int output = value - 1 - offset;
+    if (value <= offset || output >= kChannels) return -1;
+    return output / 2;
+  }
+
+  // Lowest slot not yet scheduled that can reach itself through the
+  // remaining dependencies. One always exists when Kahn's algorithm stalls.
+  int LowestInCycle(uint8_t done) const {
+    uint8_t reach[SLOTS];
+    for (int slot = 0; slot < SLOTS; ++slot)
+      reach[slot] = depends_[slot] & ~done;
+    for (int pass = 0; pass < SLOTS; ++pass) {
+      for (int slot = 0; slot < SLOTS; ++slot) {
+        for (int up = 0; up < SLOTS; ++up) {
+          if (reach[slot] & (1 << up)) reach[slot] |= reach[up];
+        }
+      }
+    }
+    for (int slot = 0; slot < SLOTS; ++slot) {
+      if (!(done & (1 << slot)) && (reach[slot] & (1 << slot))) return slot;
+    }
+    int slot = 0;
+    while (done & (1 << slot)) ++slot;
+    return slot;
+  }
+
+  void Build() {
+    for (int slot = 0; slot < SLOTS; ++slot) {
+      uint8_t deps = 0;
+      for (int ch = slot * 2; ch < slot * 2 + 2; ++ch) {
+        const int t = source_slot(trigmap_[ch], TRIG_OUT);
+        const int c = source_slot(cvmap_[ch], CV_OUT);
+        if (t >= 0) deps |= 1 << t;
+        if (c >= 0) deps |= 1 << c;
+      }
+      // reading your own output is a one-tick feedback loop either way
+      depends_[slot] = deps & ~(1 << slot);
+    }
+
+    // Kahn's algorithm, lowest ready slot first so unrelated slots keep
+    // their natural order
+    uint8_t done = 0;
+    cycle_mask_ = 0;
+    for (int n = 0; n < SLOTS; ++n) {
+      int next = -1;
+      for (int slot = 0; slot < SLOTS && next < 0; ++slot) {
+        if (!(done & (1 << slot)) && !(depends_[slot] & ~done)) next = slot;
+      }
+      if (next < 0) {
+        next = LowestInCycle(done);
+        cycle_mask_ |= 1 << next;
+      }
+      done |= 1 << next;
+      order_[n] = next;
+    }
+    valid_ = true;
+  }
+};
+
+// ControlRateScheduler: which slots' Controller() is due on each tick
+//
+// Slots that don't need the full ISR rate (see HemisphereApplet::
+// GetControlRate()) only run once every INTERVAL ticks. Their phases are
+// spread evenly over the interval, so two of them never land on the same
+// tick when they don't have to. Full-rate slots are due on every tick.
+//
+// Phases are reassigned when the set of slow slots changes, which can move
+// one run of a slow slot up to INTERVAL - 1 ticks.
+template <int SLOTS, int INTERVAL>
+class ControlRateScheduler {
+public:
+  // slow_mask: slots running at the reduced rate. Returns the due mask.
+  uint8_t Update(uint8_t slow_mask) {
+    if (slow_mask != slow_mask_ || !valid_) Build(slow_mask);
+    if (++tick_ >= INTERVAL) tick_ = 0;
+    return due_[tick_];
+  }
+
+  void Invalidate() { valid_ = false; }
+
+  // Tick within the interval a slow slot runs on
+  uint8_t phase(int slot) const { return phase_[slot]; }
+
+private:
+  static_assert(SLOTS <= 8, "slot masks are 8 bits");
+
+  bool valid_ = false;
+  uint8_t slow_mask_ = 0;
+  uint8_t tick_ = 0;
+  uint8_t phase_[SLOTS] = { 0 };
+  uint8_t due_[INTERVAL];
+
+  void Build(uint8_t slow_mask) {
+    const uint8_t all = (1 << SLOTS) - 1;
+    slow_mask &= all;
+    int count = 0;
+    for (int slot = 0; slot < SLOTS; ++slot) count += (slow_mask >> slot) & 1;
+
+    for (int t = 0; t < INTERVAL; ++t) due_[t] = all & ~slow_mask;
+    int n = 0;
+    for (int slot = 0; slot < SLOTS; ++slot) {
+      if (!(slow_mask & (1 << slot))) continue;
+      phase_[slot] = n++ * INTERVAL / count;
+      due_[phase_[slot]] |= 1 << slot;
+    }
+    slow_mask_ = slow_mask;
+    valid_ = true;
+  }
+};
+
+} // namespace HS
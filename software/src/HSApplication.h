@@ -107,7 +107,7 @@ public:
             }
 
             // trigger/gate indicators
-            const bool trig = (ch < 4) ? HS::frame.gate_high[ch] : false;
+            const bool trig = (ch < 4) ? HS::frame.gate_high(ch) : false;
             if (trig) gfxIcon(4 + w*ch, 0, CLOCK_ICON);
 
             // input
@@ -151,7 +151,7 @@ public:
     }
 
     bool Changed(int ch) {
-        return frame.changed_cv[ch];
+        return frame.changed_cv(ch);
     }
 
     bool Gate(int ch) {
@@ -159,7 +159,7 @@ public:
         const int offset = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
         if (!t) return false;
         return (t <= offset)
-          ? frame.gate_high[t - 1]
+          ? frame.gate_high(t - 1)
           : (frame.outputs[t - 1 - offset] > GATE_THRESHOLD);
     }
 
@@ -176,11 +176,9 @@ public:
         else if (trmap > 0) {
           const int offset = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
           if (trmap <= offset)
-            clocked = frame.clocked[ trmap - 1 ];
-          else {
-            clocked = frame.clockout_q[ trmap - 1 - offset ];
-            frame.clockout_q[ trmap - 1 - offset ] = false;
-          }
+            clocked = frame.clocked( trmap - 1 );
+          else
+            clocked = frame.TakeClockOut( trmap - 1 - offset );
         }
 
         // manual triggers
@@ -20,6 +20,11 @@
 
 // A "tick" is one ISR cycle, which happens 16666.667 times per second, or a million
 // times per minute. A "tock" is a metronome beat.
+//
+// Beat position and length are kept to 1/256 tick ("fine" units), using the
+// sub-tick timestamps of the clock input (IOFrame::clock_phase). Tocks still
+// fire on whole ticks, but the grid they're quantized to no longer drifts by
+// up to a tick per clock pulse.
 
 #pragma once
 
@@ -34,6 +39,8 @@ static constexpr uint16_t CLOCK_TEMPO_MIN = 1;
 static constexpr uint16_t CLOCK_TEMPO_MAX = 300;
 static constexpr uint32_t CLOCK_TICKS_MIN = 1000000 / CLOCK_TEMPO_MAX;
 static constexpr uint32_t CLOCK_TICKS_MAX = 1000000 / CLOCK_TEMPO_MIN;
+static constexpr int CLOCK_FINE_BITS = OC::kClockPhaseBits;
+static constexpr uint32_t CLOCK_FINE_MASK = (1 << CLOCK_FINE_BITS) - 1;
 
 constexpr int MIDI_OUT_PPQN = 24;
 constexpr int CLOCK_MAX_MULTIPLE = 24;
@@ -56,6 +63,7 @@ public:
 
     uint16_t tempo; // The set tempo, for display somewhere else
     uint32_t ticks_per_beat; // Based on the selected tempo in BPM
+    uint8_t ticks_per_beat_frac = 0; // ...plus this many 1/256 ticks
     bool running = 0; // Specifies whether the clock is running for interprocess communication
     bool paused = 0; // Specifies whethr the clock is paused
     bool auto_reset = 0; // on clock start
@@ -64,7 +72,9 @@ public:
     bool tickno = 0;
     bool extsync = false; // locked into an external clock; will stop after timeout
     uint32_t clock_tick[2] = {0,0}; // previous ticks when a physical clock was received on DIGITAL 1
+    uint8_t clock_phase[2] = {0,0}; // ...and how long before those ticks they arrived (1/256 ticks)
     uint32_t beat_tick = 0; // The tick to count from
+    uint8_t beat_phase = 0; // The beat was this many 1/256 ticks before beat_tick
     bool tock[NR_OF_CLOCKS] = {0,0,0,0,0,0,0,0,0}; // The current tock value
     int16_t tocks_per_beat[NR_OF_CLOCKS] = {0,0, 0,0, 0,0, 0,0, MIDI_OUT_PPQN}; // Multiplier
     int count[NR_OF_CLOCKS] = {0,0,0,0, 0,0,0,0, 0}; // Multiple counter, 0 is a special case when first starting the clock
@@ -101,6 +111,7 @@ public:
     void SetTempoBPM(uint16_t bpm) {
         bpm = constrain(bpm, CLOCK_TEMPO_MIN, CLOCK_TEMPO_MAX);
         ticks_per_beat = 1000000 / bpm;
+        ticks_per_beat_frac = ((1000000 % bpm) << CLOCK_FINE_BITS) / bpm;
         tempo = bpm;
     }
     
@@ -113,6 +124,7 @@ public:
         // update the tempo
         uint32_t clock_diff = total / count;
         ticks_per_beat = constrain(clock_diff, CLOCK_TICKS_MIN, CLOCK_TICKS_MAX); // time since last clock is new tempo
+        ticks_per_beat_frac = (ticks_per_beat == clock_diff) ? ((total % count) << CLOCK_FINE_BITS) / count : 0;
         tempo = 1000000 / ticks_per_beat; // imprecise, for display purposes
     }
 
@@ -139,9 +151,28 @@ public:
       }
     }
 
+    uint32_t FineTicksPerBeat() const {
+        return (ticks_per_beat << CLOCK_FINE_BITS) + ticks_per_beat_frac;
+    }
+
+    // Time since the beat, in 1/256 ticks; negative if it was nudged ahead of now.
+    // SyncTrig() doesn't run while another app has the ISR, so the gap can be
+    // minutes; it's capped at a couple of the longest beats so it still fits.
+    int32_t FineTicksSinceBeat(uint32_t now) const {
+        static constexpr int32_t kMaxAge = 2 * CLOCK_TICKS_MAX;
+        const int32_t age = constrain(int32_t(now - beat_tick), -kMaxAge, kMaxAge);
+        return age * (1 << CLOCK_FINE_BITS) + beat_phase;
+    }
+
+    // Place the beat the given number of 1/256 ticks before now
+    void SetBeat(uint32_t now, int32_t age) {
+        beat_tick = now - (age >> CLOCK_FINE_BITS);
+        beat_phase = age & CLOCK_FINE_MASK;
+    }
+
     // Reset - Resync multipliers, optionally skipping the first tock
-    void Reset(bool count_skip = 0) {
-        beat_tick = OC::CORE::ticks;
+    void Reset(bool count_skip = 0, int32_t beat_age = 0) {
+        SetBeat(OC::CORE::ticks, beat_age);
         if (0 == count_skip) {
             clock_tick[0] = 0;
             clock_tick[1] = 0;
@@ -155,18 +186,29 @@ public:
 
     // Nudge - Used to align the internal clock with incoming clock pulses
     // The rationale is that it's better to be short by 1 than to overshoot by 1
+    // (diff is in 1/256 ticks)
     void Nudge(int diff) {
-        if (diff > 0) diff--;
-        if (diff < 0) diff++;
-        beat_tick += diff;
+        const int one = 1 << CLOCK_FINE_BITS;
+        if (diff > 0) diff = (diff > one) ? diff - one : 0;
+        if (diff < 0) diff = (diff < -one) ? diff + one : 0;
+        SetBeat(OC::CORE::ticks, FineTicksSinceBeat(OC::CORE::ticks) - diff);
     }
 
     // call this on every tick when clock is running, before all Controllers
-    void SyncTrig(bool clocked, bool hard_reset = false) {
+    // clock_age: how long before this tick the clock arrived, in 1/256 ticks
+    void SyncTrig(bool clocked, bool hard_reset = false, uint8_t clock_age = 0) {
         //if (!IsRunning()) return;
         if (hard_reset) Reset();
 
         const uint32_t now = OC::CORE::ticks;
+        const uint32_t beat_length = FineTicksPerBeat();
+        int32_t since_beat = FineTicksSinceBeat(now);
+        // Back after a gap: drop the beats that were missed, keeping the
+        // phase, rather than catching up on a tock per tick
+        if (since_beat >= 2 * int32_t(beat_length)) {
+            since_beat = beat_length + since_beat % beat_length;
+            SetBeat(now, since_beat);
+        }
 
         // Reset only when all multipliers have been met
         bool reset = 1;
@@ -180,19 +222,23 @@ public:
             }
 
             if (tocks_per_beat[ch] > 0) { // multiply
-                uint32_t next_tock_tick = beat_tick + count[ch]*ticks_per_beat / static_cast<uint32_t>(tocks_per_beat[ch]);
+                const uint32_t mult = static_cast<uint32_t>(tocks_per_beat[ch]);
+                // count * beat_length / mult without overflowing 32 bits
+                const uint32_t whole = count[ch] * ticks_per_beat;
+                int32_t next_tock = ((whole / mult) << CLOCK_FINE_BITS)
+                    + (((whole % mult) << CLOCK_FINE_BITS) + count[ch] * ticks_per_beat_frac) / mult;
                 if (shuffle && MIDI_CLOCK != ch && count[ch] % 2 == 1 && count[ch] < tocks_per_beat[ch])
-                    next_tock_tick += shuffle * ticks_per_beat / 100 / static_cast<uint32_t>(tocks_per_beat[ch]);
+                    next_tock += (shuffle * ticks_per_beat / 100 / mult) << CLOCK_FINE_BITS;
 
-                tock[ch] = now >= next_tock_tick;
+                tock[ch] = since_beat >= next_tock;
                 if (tock[ch]) ++count[ch]; // increment multiplier counter
 
                 beatsync = beatsync || (count[ch] > tocks_per_beat[ch]); // multiplier has been exceeded
                 reset = reset && (count[ch] > tocks_per_beat[ch]);
             } else { // division: -1 becomes /2, -2 becomes /3, etc.
                 int div = 1 - tocks_per_beat[ch];
-                uint32_t next_beat = beat_tick + (count[ch] ? ticks_per_beat : 0);
-                bool beat_exceeded = (now >= next_beat);
+                const int32_t next_beat = count[ch] ? beat_length : 0;
+                bool beat_exceeded = (since_beat >= next_beat);
                 if (beat_exceeded) {
                     ++count[ch];
                     tock[ch] = (count[ch] % div) == 1;
@@ -207,7 +253,9 @@ public:
             }
 
         }
-        if (reset) Reset(1); // skip the one we're already on
+        // skip the one we're already on; the new beat starts where the old
+        // one ended, not on this tick
+        if (reset) Reset(1, constrain(since_beat - int32_t(beat_length), 0, int32_t(CLOCK_FINE_MASK)));
         if (beatsync) ProcessBeatSync();
 
         // handle syncing to physical clocks
@@ -223,22 +271,28 @@ public:
 
             // if there are two previous clock ticks, update tempo and sync
             if (clock_tick[1-tickno] && clock_diff) {
-                uint32_t avg_diff = (clock_diff + (clock_tick[tickno] - clock_tick[1-tickno])) / 2;
+                const uint32_t fine_diff = (clock_diff << CLOCK_FINE_BITS) + clock_phase[tickno] - clock_age;
+                const uint32_t last_fine_diff = ((clock_tick[tickno] - clock_tick[1-tickno]) << CLOCK_FINE_BITS)
+                    + clock_phase[1-tickno] - clock_phase[tickno];
+                uint32_t avg_diff = (fine_diff + last_fine_diff) / 2;
 
                 // update the tempo
-                ticks_per_beat = constrain(clock_ppqn * avg_diff, CLOCK_TICKS_MIN, CLOCK_TICKS_MAX);
+                const uint32_t fine_beat = constrain(clock_ppqn * avg_diff,
+                    CLOCK_TICKS_MIN << CLOCK_FINE_BITS, CLOCK_TICKS_MAX << CLOCK_FINE_BITS);
+                ticks_per_beat = fine_beat >> CLOCK_FINE_BITS;
+                ticks_per_beat_frac = fine_beat & CLOCK_FINE_MASK;
                 tempo = 1000000 / ticks_per_beat; // imprecise, for display purposes
 
-                int ticks_per_clock = ticks_per_beat / clock_ppqn; // rounded down
+                int ticks_per_clock = fine_beat / clock_ppqn; // rounded down
 
-                // time since last beat
-                int tick_offset = now - beat_tick;
+                // time from beat to clock edge
+                int tick_offset = FineTicksSinceBeat(now) - clock_age;
 
                 // too long ago? time til next beat
-                if (tick_offset > ticks_per_clock / 2) tick_offset -= ticks_per_beat;
+                if (tick_offset > ticks_per_clock / 2) tick_offset -= int(fine_beat);
 
                 // within half a clock pulse of the nearest beat AND significantly large
-                if (abs(tick_offset) < ticks_per_clock / 2 && abs(tick_offset) > 4)
+                if (abs(tick_offset) < ticks_per_clock / 2 && abs(tick_offset) > (4 << CLOCK_FINE_BITS))
                     Nudge(tick_offset); // nudge the beat towards us
 
                 extsync = true;
@@ -248,6 +302,7 @@ public:
         if (clocked) {
             tickno = 1 - tickno;
             clock_tick[tickno] = now;
+            clock_phase[tickno] = clock_age;
         }
         else if (extsync && clock_ppqn && now - clock_tick[tickno] > ticks_per_beat * 2 / clock_ppqn) {
           // auto-stop
@@ -262,13 +317,7 @@ public:
         paused = p;
         auto_reset = !p;
         if (!p && midi_out_enabled) {
-            usbMIDI.sendRealTime(usbMIDI.Start);
-#if defined(__IMXRT1062__)
-            usbHostMIDI.sendRealTime(usbMIDI.Start);
-#ifdef ARDUINO_TEENSY41
-            MIDI1.sendRealTime(midi::MidiType(usbMIDI.Start));
-#endif
-#endif
+            HS::SendMIDI(usbMIDI.Start, 0, 0, 0);
         }
     }
 
@@ -277,13 +326,7 @@ public:
         paused = 0;
         extsync = false;
         if (midi_out_enabled) {
-            usbMIDI.sendRealTime(usbMIDI.Stop);
-#if defined(__IMXRT1062__)
-            usbHostMIDI.sendRealTime(usbMIDI.Stop);
-#ifdef ARDUINO_TEENSY41
-            MIDI1.sendRealTime(midi::MidiType(usbMIDI.Stop));
-#endif
-#endif
+            HS::SendMIDI(usbMIDI.Stop, 0, 0, 0);
         }
     }
 
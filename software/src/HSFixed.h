@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+
+// Q16.16 fixed point for ISR code, the big brother of simfloat (HSUtils.h).
+//
+// The T3.2's Cortex-M4 has no FPU, so every float op in a Controller() is a
+// libgcc call; these stick to 32x32->64 multiplies, shifts and clz, which
+// are single-cycle there. T4.x builds get the same results.
+//
+// Precision is 1/65536; values up to +/-32767, which covers pitch CV
+// (12 << 7 per volt) with plenty of headroom.
+
+namespace HS {
+
+typedef int32_t q16_t;
+
+static constexpr int Q16_BITS = 16;
+static constexpr q16_t Q16_ONE = 1 << Q16_BITS;
+
+constexpr q16_t int2q16(const int32_t x) {
+  return x * Q16_ONE;
+}
+
+// Rounds towards -inf, like >> on simfloat
+constexpr int32_t q162int(const q16_t x) {
+  return x >> Q16_BITS;
+}
+
+// For constants only; floats must not end up in the ISR
+constexpr q16_t float2q16(const float x) {
+  return q16_t(x * Q16_ONE + (x >= 0 ? 0.5f : -0.5f));
+}
+
+constexpr float q162float(const q16_t x) {
+  return float(x) / Q16_ONE;
+}
+
+static inline q16_t Q16Mul(const q16_t a, const q16_t b) {
+  return q16_t((int64_t(a) * b) >> Q16_BITS);
+}
+
+/* One-pole lowpass, state += (1 - alpha) * (target - state).
+ *
+ * state is kept at Q16 so slow settings creep all the way to the target
+ * instead of stalling a few units short, as an integer state would.
+ * alpha = 0 follows the target immediately, Q16_ONE holds forever.
+ */
+static inline q16_t Q16OnePole(const q16_t state, const int32_t target, const q16_t alpha) {
+  const q16_t t = int2q16(target);
+  return t + Q16Mul(alpha, state - t);
+}
+
+/* 2^x, for x in Q16. Results over 32767 saturate.
+ *
+ * The top 4 fractional bits come from a table, the rest from a 3rd order
+ * series; relative error is below 1e-6 (i.e. the Q16 rounding dominates).
+ */
+static inline q16_t Q16Exp2(const q16_t x) {
+  // round(2^(k/16) * 2^30)
+  static const uint32_t kExp2Table[16] = {
+    1073741824, 1121280436, 1170923762, 1222764986, 1276901417, 1333434672,
+    1392470869, 1454120821, 1518500250, 1585730000, 1655936265, 1729250827,
+    1805811301, 1885761398, 1969251188, 2056437387
+  };
+  static constexpr uint32_t kLn2Q30 = 744261118;
+
+  const int32_t whole = x >> Q16_BITS;
+  if (whole >= 15) return INT32_MAX;
+  if (whole < -Q16_BITS - 1) return 0;
+
+  // 2^lo = e^(lo*ln2) with lo < 1/16
+  const uint32_t u = (uint64_t(uint32_t(x & 0x0fff) << 14) * kLn2Q30) >> 30;
+  const uint32_t u2 = (uint64_t(u) * u) >> 30;
+  const uint32_t u3 = (uint64_t(u2) * u) >> 30;
+  const uint32_t poly = (1u << 30) + u + (u2 >> 1) + u3 / 6;
+  const uint32_t mantissa = (uint64_t(kExp2Table[(x >> 12) & 0x0f]) * poly) >> 30; // Q30, [1, 2)
+
+  const int shift = 30 - Q16_BITS - whole;
+  if (shift <= 0) return q16_t(mantissa << -shift);
+  return q16_t((mantissa + (1u << (shift - 1))) >> shift);
+}
+
+/* log2(x) in Q16, for x > 0 in Q16; 0 gives INT32_MIN.
+ *
+ * Mantissa bits by repeated squaring; within a couple of LSBs.
+ */
+static inline q16_t Q16Log2(const uint32_t x) {
+  if (!x) return INT32_MIN;
+  const int msb = 31 - __builtin_clz(x);
+  int32_t result = (msb - Q16_BITS) * Q16_ONE;
+
+  uint32_t z = msb > 30 ? x >> (msb - 30) : x << (30 - msb); // Q30, [1, 2)
+  for (int bit = Q16_ONE >> 1; bit; bit >>= 1) {
+    z = (uint64_t(z) * z) >> 30;
+    if (z >= (2u << 30)) {
+      z >>= 1;
+      result += bit;
+    }
+  }
+  return result;
+}
+
+/* 1/x in Q16, for x > 0 in Q16. Saturates to UINT32_MAX.
+ *
+ * Normalize with clz, then three Newton-Raphson steps from a linear
+ * estimate; no hardware divide needed, and good to within one LSB.
+ */
+static inline uint32_t Q16Reciprocal(const uint32_t x) {
+  if (!x) return UINT32_MAX;
+  const int shift = __builtin_clz(x);
+  const uint32_t d = x << shift; // Q32, [0.5, 1)
+
+  // r ~= 48/17 - 32/17 * d, then r = r * (2 - d * r); Q30
+  uint32_t r = 3031741621u - uint32_t((uint64_t(2021161080u) * d) >> 32);
+  for (int i = 0; i < 3; ++i) {
+    const uint32_t e = (2u << 30) - uint32_t((uint64_t(d) * r) >> 32);
+    r = (uint64_t(r) * e) >> 30;
+  }
+
+  // 1/x = r * 2^(shift - 30) in Q16
+  if (shift >= 30) {
+    const uint64_t q = uint64_t(r) << (shift - 30);
+    return q > UINT32_MAX ? UINT32_MAX : uint32_t(q);
+  }
+  return (r + (1u << (29 - shift))) >> (30 - shift);
+}
+
+// (num / den) in Q16; 64-bit divide, keep it out of per-tick code
+static inline uint32_t Q16Ratio(const uint64_t num, const uint64_t den) {
+  return den ? uint32_t((num << Q16_BITS) / den) : 0;
+}
+
+} // namespace HS
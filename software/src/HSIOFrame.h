@@ -10,6 +10,8 @@
 #pragma once
 
 #include "HSMIDI.h"
+#include "HSIOMask.h"
+#include "util/util_midi_cc_scheduler.h"
 
 #ifdef ARDUINO_TEENSY41
 namespace OC {
@@ -25,6 +27,11 @@ static constexpr int GATE_THRESHOLD = 15 << 7; // 1.25 volts
 static constexpr int TRIGMAP_MAX = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST + DAC_CHANNEL_LAST;
 static constexpr int CVMAP_MAX = ADC_CHANNEL_LAST + DAC_CHANNEL_LAST;
 
+// Auto MIDI-Out CC update rates per output, in Hz
+static constexpr uint16_t MIDI_CC_RATES[] = { 25, 50, 100, 200, 500, 1000 };
+static constexpr int MIDI_CC_RATE_COUNT = sizeof(MIDI_CC_RATES) / sizeof(MIDI_CC_RATES[0]);
+static constexpr int MIDI_CC_DEFAULT_RATE = 2;
+
 typedef struct MIDILogEntry {
     int message;
     int data1;
@@ -33,24 +40,51 @@ typedef struct MIDILogEntry {
 
 // shared IO Frame, updated every tick
 // this will allow chaining applets together, multiple stages of processing
+//
+// Everything Load()/Send() and the applets touch each tick comes first, as
+// tightly packed arrays and bitmasks; the MIDI state is at the end so it
+// doesn't share cache lines with the hot part.
 typedef struct IOFrame {
-    bool autoMIDIOut = false;
-    bool clocked[OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST];
-    bool gate_high[OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST];
+    static constexpr int TRIGGER_CHANNELS = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
+    static_assert(TRIGGER_CHANNELS <= 16, "trigger masks are 16 bits");
+
+    /* Hot: per-tick I/O */
     int inputs[ADC_CHANNEL_LAST];
-    int outputs[DAC_CHANNEL_LAST];
+    int outputs[DAC_CHANNEL_LAST]; // must follow inputs, see Send()
+    uint16_t clocked_mask; // digital inputs, then ADC inputs
+    uint16_t gate_mask; // same layout as clocked_mask
+    uint16_t changed_mask; // ADC inputs that moved more than 1/8 semitone since the last read
+    uint16_t clockout_mask; // rising output edges, for loopback
+    uint8_t trigger_phase[OC::DIGITAL_INPUT_LAST]; // sub-tick age of the clocks in clocked_mask
+    int last_cv[ADC_CHANNEL_LAST]; // For change detection
+    int clock_countdown[DAC_CHANNEL_LAST];
     int output_diff[DAC_CHANNEL_LAST];
     int outputs_smooth[DAC_CHANNEL_LAST];
-    int clock_countdown[DAC_CHANNEL_LAST];
-    uint8_t clockskip[DAC_CHANNEL_LAST] = {0};
-    bool clockout_q[DAC_CHANNEL_LAST]; // for loopback
     int adc_lag_countdown[ADC_CHANNEL_LAST]; // Time between a clock event and an ADC read event
     uint32_t last_clock[ADC_CHANNEL_LAST]; // Tick number of the last clock observed by the child class
     uint32_t cycle_ticks[ADC_CHANNEL_LAST]; // Number of ticks between last two clocks
-    bool changed_cv[ADC_CHANNEL_LAST]; // Has the input changed by more than 1/8 semitone since the last read?
-    int last_cv[ADC_CHANNEL_LAST]; // For change detection
+    uint8_t clockskip[DAC_CHANNEL_LAST] = {0};
+    bool autoMIDIOut = false;
+
+    bool clocked(int ch) const { return IOMask::Test(clocked_mask, ch); }
+    bool gate_high(int ch) const { return IOMask::Test(gate_mask, ch); }
+    bool changed_cv(int ch) const { return IOMask::Test(changed_mask, ch); }
 
-    /* MIDI message queue/cache */
+    // How long before this tick a clock arrived, in 1/256 ticks (see
+    // OC::DigitalInputs::clock_phase). CV inputs are only sampled once per
+    // tick, so they have no sub-tick timing.
+    uint8_t clock_phase(int ch) const {
+        return ch < OC::DIGITAL_INPUT_LAST ? trigger_phase[ch] : 0;
+    }
+
+    // Rising edge on an output since the last call?
+    bool TakeClockOut(int ch) {
+        const bool q = IOMask::Test(clockout_mask, ch);
+        clockout_mask &= ~(1u << ch);
+        return q;
+    }
+
+    /* Cold: MIDI message queue/cache */
     struct {
         int channel[ADC_CHANNEL_LAST]; // MIDI channel number
         int function[ADC_CHANNEL_LAST]; // Function for each channel
@@ -98,7 +132,11 @@ typedef struct IOFrame {
 #endif
         };
         uint8_t current_note[16]; // note number, per MIDI channel
-        uint8_t current_ccval[DAC_CHANNEL_LAST]; // level 0 - 127, per DAC channel
+        // CC outputs are rate limited; notes go out first
+        util::MIDIControlScheduler<DAC_CHANNEL_LAST> cc_out;
+        uint8_t cc_resolution = util::MIDI_CC_7BIT; // MIDIControlResolution
+        uint8_t cc_rate = MIDI_CC_DEFAULT_RATE; // index into MIDI_CC_RATES
+        bool note_sent; // this tick
         int note_countdown[DAC_CHANNEL_LAST];
         int inputs[DAC_CHANNEL_LAST]; // CV to be translated
         int last_cv[DAC_CHANNEL_LAST];
@@ -275,14 +313,14 @@ typedef struct IOFrame {
                 break;
 
               case HEM_MIDI_CC_OUT:
-              {
-                const uint8_t newccval = ProportionCV(abs(inputs[i]), 127);
-                if (newccval != current_ccval[i])
-                  SendCC(midi_ch, outccnum[i], newccval);
-                current_ccval[i] = newccval;
+                cc_out.Configure(i, midi_ch, outccnum[i], util::MIDIControlResolution(cc_resolution));
+                if (cc_resolution == util::MIDI_CC_7BIT)
+                  cc_out.Set(i, ProportionCV(abs(inputs[i]), 127) << 7);
+                else
+                  cc_out.Set(i, ProportionCV(abs(inputs[i]), 16383));
                 break;
-              }
             }
+            if (outfn[i] != HEM_MIDI_CC_OUT) cc_out.Disable(i);
 
             // Handle clock pulse timing
             if (note_countdown[i] > 0) {
@@ -310,49 +348,39 @@ typedef struct IOFrame {
             }
           }
 
+          // CCs wait for a tick without notes
+          cc_out.set_interval(HEMISPHERE_CLOCK_TICKS * 1000 / MIDI_CC_RATES[cc_rate]);
+          cc_out.Process([](uint8_t channel, uint8_t cc, uint8_t value) {
+            HS::SendMIDI(usbMIDI.ControlChange, channel + 1, cc, value);
+          }, note_sent);
+          note_sent = false;
+
           // I think this can cause the UI to lag and miss input
           //usbMIDI.send_now();
         }
 
         void SendAfterTouch(const int midi_ch, uint8_t val) {
-          usbMIDI.sendAfterTouch(val, midi_ch + 1);
-#ifdef ARDUINO_TEENSY41
-          usbHostMIDI.sendAfterTouch(val, midi_ch + 1);
-          MIDI1.sendAfterTouch(val, midi_ch + 1);
-#endif
+          HS::SendMIDI(usbMIDI.AfterTouchChannel, midi_ch + 1, val, 0);
         }
+        // bend is the raw 14-bit value, 8192 = center
         void SendPitchBend(const int midi_ch, uint16_t bend) {
-          usbMIDI.sendPitchBend(bend, midi_ch + 1);
-#ifdef ARDUINO_TEENSY41
-          usbHostMIDI.sendPitchBend(bend, midi_ch + 1);
-          MIDI1.sendPitchBend(bend, midi_ch + 1);
-#endif
+          HS::SendMIDI(usbMIDI.PitchBend, midi_ch + 1, bend & 0x7f, (bend >> 7) & 0x7f);
         }
 
         void SendCC(const int midi_ch, int ccnum, uint8_t val) {
-          usbMIDI.sendControlChange(ccnum, val, midi_ch + 1);
-#ifdef ARDUINO_TEENSY41
-          usbHostMIDI.sendControlChange(ccnum, val, midi_ch + 1);
-          MIDI1.sendControlChange(ccnum, val, midi_ch + 1);
-#endif
+          HS::SendMIDI(usbMIDI.ControlChange, midi_ch + 1, ccnum, val);
         }
         void SendNoteOn(const int midi_ch, int note = -1, uint8_t vel = 100) {
           if (note < 0) note = current_note[midi_ch];
           else current_note[midi_ch] = note;
 
-          usbMIDI.sendNoteOn(note, vel, midi_ch + 1);
-#ifdef ARDUINO_TEENSY41
-          usbHostMIDI.sendNoteOn(note, vel, midi_ch + 1);
-          MIDI1.sendNoteOn(note, vel, midi_ch + 1);
-#endif
+          HS::SendMIDI(usbMIDI.NoteOn, midi_ch + 1, note, vel);
+          note_sent = true;
         }
         void SendNoteOff(const int midi_ch, int note = -1, uint8_t vel = 0) {
           if (note < 0) note = current_note[midi_ch];
-          usbMIDI.sendNoteOff(note, vel, midi_ch + 1);
-#ifdef ARDUINO_TEENSY41
-          usbHostMIDI.sendNoteOff(note, vel, midi_ch + 1);
-          MIDI1.sendNoteOff(note, vel, midi_ch + 1);
-#endif
+          HS::SendMIDI(usbMIDI.NoteOff, midi_ch + 1, note, vel);
+          note_sent = true;
         }
 
     } MIDIState;
@@ -361,7 +389,7 @@ typedef struct IOFrame {
     void Out(DAC_CHANNEL channel, int value) {
         // rising edge detection for trigger loopback
         if (value > GATE_THRESHOLD && outputs[channel] < GATE_THRESHOLD)
-          clockout_q[channel] = true;
+          clockout_mask |= 1u << channel;
 
         output_diff[channel] = value - outputs[channel];
         outputs[channel] = value;
@@ -371,7 +399,7 @@ typedef struct IOFrame {
       if (0 == clockskip[ch] || random(100) >= clockskip[ch]) {
         clock_countdown[ch] = pulselength;
         outputs[ch] = PULSE_VOLTAGE * (12 << 7);
-        clockout_q[ch] = true;
+        clockout_mask |= 1u << ch;
       }
     }
     void NudgeSkip(int ch, int dir) {
@@ -381,31 +409,32 @@ typedef struct IOFrame {
     // TODO: Hardware IO should be extracted
     // --- Hard IO ---
     void Load() {
-        clocked[0] = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
-        clocked[1] = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_2>();
-        clocked[2] = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_3>();
-        clocked[3] = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_4>();
-        gate_high[0] = OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_1>();
-        gate_high[1] = OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_2>();
-        gate_high[2] = OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_3>();
-        gate_high[3] = OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_4>();
-        for (int i = 0; i < ADC_CHANNEL_LAST; ++i) {
-            // Set CV inputs
+        const uint16_t trigger_gates =
+            OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_1>() |
+            OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_2>() << 1 |
+            OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_3>() << 2 |
+            OC::DigitalInputs::read_immediate<OC::DIGITAL_INPUT_4>() << 3;
+
+        // Set CV inputs
+        for (int i = 0; i < ADC_CHANNEL_LAST; ++i)
             inputs[i] = OC::ADC::raw_pitch_value(ADC_CHANNEL(i));
 
-            // calculate gates/clocks for all ADC inputs as well
-            gate_high[OC::DIGITAL_INPUT_LAST + i] = inputs[i] > GATE_THRESHOLD;
-            clocked[OC::DIGITAL_INPUT_LAST + i] = (gate_high[OC::DIGITAL_INPUT_LAST + i] && last_cv[i] < GATE_THRESHOLD);
-
-            if (abs(inputs[i] - last_cv[i]) > HEMISPHERE_CHANGE_THRESHOLD) {
-                changed_cv[i] = 1;
-                last_cv[i] = inputs[i];
-            } else changed_cv[i] = 0;
-
-            // Handle clock pulse timing
-            if (clock_countdown[i] > 0) {
-                if (--clock_countdown[i] == 0) outputs[i] = 0;
-            }
+        // calculate gates/clocks for all ADC inputs as well; the edge is
+        // against the last *changed* value, as before
+        const uint16_t cv_gates = IOMask::Above<ADC_CHANNEL_LAST>(inputs, GATE_THRESHOLD);
+        const uint16_t cv_was_high = IOMask::Above<ADC_CHANNEL_LAST>(last_cv, GATE_THRESHOLD - 1);
+        gate_mask = trigger_gates | (cv_gates << OC::DIGITAL_INPUT_LAST);
+        clocked_mask = OC::DigitalInputs::clocked() | ((cv_gates & ~cv_was_high) << OC::DIGITAL_INPUT_LAST);
+        for (int i = 0; i < OC::DIGITAL_INPUT_LAST; ++i)
+            trigger_phase[i] = OC::DigitalInputs::clock_phase(OC::DigitalInput(i));
+
+        changed_mask = IOMask::Changed<ADC_CHANNEL_LAST>(inputs, last_cv, HEMISPHERE_CHANGE_THRESHOLD);
+
+        // Handle clock pulse timing
+        const uint16_t expired = IOMask::Countdown<DAC_CHANNEL_LAST>(clock_countdown);
+        if (expired) {
+            for (int i = 0; i < DAC_CHANNEL_LAST; ++i)
+                if (IOMask::Test(expired, i)) outputs[i] = 0;
         }
     }
 
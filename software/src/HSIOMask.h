@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace HS {
+
+// Per-channel helpers for IOFrame::Load/Send. Bit i of each mask is channel
+// i; the channel count is a template parameter so the loops unroll into
+// straight-line compare/shift/or sequences.
+namespace IOMask {
+
+static inline bool Test(const uint16_t mask, const int i) {
+    return (mask >> i) & 1;
+}
+
+// Channels whose value is above threshold
+template <int N>
+static inline uint16_t Above(const int *values, const int threshold) {
+    static_assert(N <= 16, "masks are 16 bits");
+    uint16_t mask = 0;
+    for (int i = 0; i < N; ++i)
+        mask |= uint16_t(values[i] > threshold) << i;
+    return mask;
+}
+
+// Channels that moved more than threshold away from last; last follows
+// only those channels, so slow drift still registers eventually
+template <int N>
+static inline uint16_t Changed(const int *values, int *last, const int threshold) {
+    static_assert(N <= 16, "masks are 16 bits");
+    uint16_t mask = 0;
+    for (int i = 0; i < N; ++i) {
+        const bool changed = abs(values[i] - last[i]) > threshold;
+        if (changed) last[i] = values[i];
+        mask |= uint16_t(changed) << i;
+    }
+    return mask;
+}
+
+// Count down the running timers; returns those that reached zero
+template <int N>
+static inline uint16_t Countdown(int *countdown) {
+    static_assert(N <= 16, "masks are 16 bits");
+    uint16_t mask = 0;
+    for (int i = 0; i < N; ++i) {
+        if (countdown[i] > 0)
+            mask |= uint16_t(--countdown[i] == 0) << i;
+    }
+    return mask;
+}
+
+} // namespace IOMask
+
+} // namespace HS
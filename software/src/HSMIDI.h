@@ -30,6 +30,10 @@
 #ifndef HSMIDI_H
 #define HSMIDI_H
 
+#include "OC_debug.h"
+#include "util/util_midi_router.h"
+#include "util/util_spsc_queue.h"
+
 // Teensyduino USB MIDI Library message numbers
 // See https://www.pjrc.com/teensy/td_midi.html
 
@@ -92,6 +96,84 @@ enum MIDIFunctions {
 };
 const char* const midi_fn_name[HEM_MIDI_MAX_FUNCTION + 1] = {"None", "Note#", "Trig", "Gate", "Veloc", "CC#", "Aft", "Bend", "Clock", "Run", "Start"};
 
+namespace HS {
+
+// MIDI input is read in loop() and handed to the ISR as pre-parsed events,
+// so a burst of incoming traffic can't blow the tick budget. SysEx is
+// handled in loop() and never queued.
+struct MIDIEvent {
+    uint8_t message;
+    uint8_t channel; // 1-16, as returned by getChannel()
+    uint8_t data1;
+    uint8_t data2;
+};
+
+static constexpr size_t kMIDIEventQueueDepth = 128;
+// Events consumed per ISR tick. DIN MIDI delivers about one message every
+// 20 ticks; USB can burst, but the queue absorbs that.
+static constexpr int kMIDIEventsPerTick = 4;
+
+// Flushed on APP_EVENT_RESUME, while the app ISR (the consumer) is held off,
+// so an app never sees events queued before it was suspended
+extern util::SPSCQueue<MIDIEvent, kMIDIEventQueueDepth> midi_events;
+
+// loop() side; the event is dropped if the ISR has fallen behind
+inline void PushMIDIEvent(int message, int channel, int data1, int data2) {
+    const MIDIEvent event = { uint8_t(message), uint8_t(channel), uint8_t(data1), uint8_t(data2) };
+    if (!midi_events.Push(event))
+        ++OC::DEBUG::MIDI_queue_overflow;
+    ++OC::DEBUG::MIDI_event_count;
+    const uint32_t depth = midi_events.readable();
+    if (depth > OC::DEBUG::MIDI_max_queue_depth)
+        OC::DEBUG::MIDI_max_queue_depth = depth;
+}
+
+#if defined(__IMXRT1062__)
+// MIDI output and thru go through a router (util/util_midi_router.h) that
+// runs in loop(): messages are filtered per source and destination port,
+// queued per output, and written out only as fast as each device takes them.
+// Sends from the ISR are handed over through midi_out_events first.
+enum MIDIPort {
+    MIDI_PORT_USB,
+    MIDI_PORT_USB_HOST,
+    MIDI_PORT_DIN,
+    MIDI_PORT_INTERNAL, // Hemisphere etc.: output from the ISR, input to midi_events
+
+    MIDI_PORT_COUNT,
+    MIDI_OUTPUT_PORTS = MIDI_PORT_INTERNAL
+};
+
+static constexpr size_t kMIDIOutQueueDepth = 64;
+// USB messages handed to the driver per loop(); it blocks once its own
+// buffers are full
+static constexpr size_t kMIDIUSBMessagesPerPoll = 16;
+
+extern util::MIDIRouter<MIDI_PORT_COUNT, MIDI_OUTPUT_PORTS, kMIDIOutQueueDepth> midi_router;
+extern util::SPSCQueue<MIDIEvent, kMIDIEventQueueDepth> midi_out_events;
+
+void InitMIDIRouter();
+
+// loop() side: a message read from an input port goes to the ISR and out the
+// other ports, as far as the routes let it
+inline void RouteMIDIInput(MIDIPort port, int message, int channel, int data1, int data2) {
+    const util::MIDIMessage msg = {
+        uint8_t(message < 0xf0 ? message | ((channel - 1) & 0x0f) : message), uint8_t(data1), uint8_t(data2)
+    };
+    if (midi_router.Passes(port, MIDI_PORT_INTERNAL, msg))
+        PushMIDIEvent(message, channel, data1, data2);
+    midi_router.Route(port, msg);
+}
+
+// loop() side: queued output from the ISR into the router, then out to the devices
+void PollMIDIOut();
+#endif
+
+// Send from the ISR or loop(); message is the usbMIDI type, channel is 1-16
+// (ignored for system messages)
+void SendMIDI(int message, int channel, int data1, int data2);
+
+} // namespace HS
+
 
 /* Hemisphere Suite Data Packing
  *
@@ -324,6 +406,61 @@ private:
     char last_app_code; // The most recent application code received
 };
 
+/*
+ * Applet cycle accounting dump, for finding heavy applets in a live patch.
+ *
+ * Sending an empty SysEx message with target 'P' (F0 7D 62 50 F7) requests
+ * the counters in OC::DEBUG::APPLET_cycles. The reply, also to target 'P',
+ * unpacks to a header byte with the number of entries, then one 7-byte entry
+ * per applet slot followed by one for Clock Setup:
+ *
+ *   applet id (0xff = slot not running), min, avg, max
+ *
+ * Times are 16-bit little-endian, in tenths of a microsecond. The min/max
+ * window restarts after each dump.
+ */
+class AppletProfileSysEx : public SystemExclusiveHandler {
+public:
+    void OnSendSysEx() {
+        uint8_t V[1 + (OC::DEBUG::kAppletSlots + 1) * 7];
+        uint8_t size = 0;
+        V[size++] = OC::DEBUG::kAppletSlots + 1;
+        for (int slot = 0; slot < OC::DEBUG::kAppletSlots; ++slot) {
+            const int id = OC::DEBUG::APPLET_ids[slot];
+            PackEntry(V, size, id == OC::DEBUG::kNoApplet ? 0xff : id, OC::DEBUG::APPLET_cycles[slot]);
+        }
+        PackEntry(V, size, 0xff, OC::DEBUG::CLOCK_cycles);
+
+        UnpackedData unpacked;
+        unpacked.set_data(size, V);
+        PackedData packed = unpacked.pack();
+        SendSysEx(packed, 'P');
+
+        OC::DEBUG::ResetAppletCycles();
+    }
+
+    void OnReceiveSysEx() {
+        uint8_t V[SYSEX_DATA_MAX_SIZE];
+        if (ExtractSysExData(V, 'P')) OnSendSysEx();
+    }
+
+private:
+    static void PackEntry(uint8_t *V, uint8_t &size, uint8_t id, const debug::AveragedCycles &cycles) {
+        const bool empty = !cycles.max_value();
+        const uint32_t values[3] = {
+            empty ? 0 : cycles.min_value(), cycles.value(), cycles.max_value()
+        };
+        V[size++] = id;
+        for (uint32_t value : values) {
+            // cycles to 0.1us, saturated
+            value = value * 10 / (F_CPU / 1000000);
+            if (value > 0xffff) value = 0xffff;
+            V[size++] = value & 0xff;
+            V[size++] = (value >> 8) & 0xff;
+        }
+    }
+};
+
 /*
  * MIDI Quantizer: Converts pitch CV values to MIDI note numbers,
  * and vice versa. CV values are (12 << 7) steps per volt, or
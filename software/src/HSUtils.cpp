@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include "OC_apps.h"
 #include "OC_core.h"
 #include "HemisphereApplet.h"
 #include "HSUtils.h"
@@ -17,6 +18,7 @@ namespace HS {
   OC::SemitoneQuantizer input_quant[ADC_CHANNEL_LAST];
 
   braids::Quantizer quantizer[QUANT_CHANNEL_COUNT]; // global shared quantizers
+  braids::QuantizerBank<QUANT_CHANNEL_COUNT, QUANT_TABLE_COUNT, QuantizerBankLock> quantizer_bank(quantizer);
   int quant_scale[QUANT_CHANNEL_COUNT];
   int8_t root_note[QUANT_CHANNEL_COUNT];
   int8_t q_octave[QUANT_CHANNEL_COUNT];
@@ -76,6 +78,15 @@ namespace HS {
     if (root == 0) root = (root_note[ch] << 7);
     return quantizer[ch].Process(cv, root, transpose) + (q_octave[ch] * 12 << 7);
   }
+  void QuantizeAll(uint32_t channels, const int32_t *cv, const int32_t *transpose, int32_t *out) {
+    int32_t root[QUANT_CHANNEL_COUNT];
+    for (int ch = 0; ch < QUANT_CHANNEL_COUNT; ++ch)
+      root[ch] = root_note[ch] << 7;
+    quantizer_bank.Process(channels, cv, root, transpose, out);
+    for (int ch = 0; ch < QUANT_CHANNEL_COUNT; ++ch) {
+      if (channels & (1u << ch)) out[ch] += q_octave[ch] * 12 << 7;
+    }
+  }
   int QuantizerLookup(int ch, int note) {
     return quantizer[ch].Lookup(note) + (root_note[ch] << 7) + (q_octave[ch] * 12 << 7);
   }
@@ -83,7 +94,10 @@ namespace HS {
     CONSTRAIN(scale, 0, OC::Scales::NUM_SCALES - 1);
     quant_scale[ch] = scale;
     q_mask[ch] = mask;
-    quantizer[ch].Configure(OC::Scales::GetScale(scale), mask);
+    quantizer_bank.Configure(ch, OC::Scales::GetScale(scale), mask);
+  }
+  void PollQuantizers() {
+    quantizer_bank.Poll();
   }
   int GetScale(int ch) {
     return quant_scale[ch];
@@ -149,7 +163,7 @@ namespace HS {
     }
     mask |= ~used_bits; // fill upper bits
 
-    quantizer[ch].Configure(OC::Scales::GetScale(quant_scale[ch]), mask);
+    quantizer_bank.Configure(ch, OC::Scales::GetScale(quant_scale[ch]), mask);
   }
   void QuantizerEdit(int ch) {
     qview = constrain(ch, 0, QUANT_CHANNEL_COUNT - 1);
@@ -231,6 +245,15 @@ namespace HS {
         graphics.print("> Preset ");
         graphics.print(OC::Strings::capital_letters[preset_id]);
         break;
+      case SAVE_POPUP:
+        // stays up until the write is done
+        if (OC::app_data_pending()) {
+          graphics.print("Saving...");
+          popup_tick = OC::CORE::ticks;
+        } else {
+          graphics.print("Saved");
+        }
+        break;
       case QUANTIZER_POPUP:
       {
         const int root = (next_ch > -1) ? next_root_note : root_note[qview];
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "OC_scales.h"
+#include "HSFixed.h"
 
 // misc. utility functions extracted from Hemisphere
 // -NJM
@@ -173,6 +174,7 @@ namespace HS {
     MENU_POPUP,
     CLOCK_POPUP, PRESET_POPUP,
     QUANTIZER_POPUP,
+    SAVE_POPUP,
   };
 
   enum QUANT_CHANNEL {
@@ -197,6 +199,18 @@ namespace HS {
   extern OC::SemitoneQuantizer input_quant[ADC_CHANNEL_LAST];
 
   extern braids::Quantizer quantizer[QUANT_CHANNEL_COUNT]; // global shared quantizers
+  // lookup tables for the above, one per distinct scale/mask in use
+#ifdef __IMXRT1062__
+  static constexpr int QUANT_TABLE_COUNT = QUANT_CHANNEL_COUNT;
+#else
+  static constexpr int QUANT_TABLE_COUNT = 4; // RAM; the rest search
+#endif
+  // Configure from anywhere, tables are built in loop(); see PollQuantizers()
+  struct QuantizerBankLock {
+    QuantizerBankLock() { __disable_irq(); }
+    ~QuantizerBankLock() { __enable_irq(); }
+  };
+  extern braids::QuantizerBank<QUANT_CHANNEL_COUNT, QUANT_TABLE_COUNT, QuantizerBankLock> quantizer_bank;
   extern int quant_scale[QUANT_CHANNEL_COUNT];
   extern int8_t root_note[QUANT_CHANNEL_COUNT];
   extern int8_t q_octave[QUANT_CHANNEL_COUNT];
@@ -218,8 +232,12 @@ namespace HS {
   // --- Quantizer helpers
   int GetLatestNoteNumber(int ch);
   int Quantize(int ch, int cv, int root = 0, int transpose = 0);
+  // Quantize for each channel bit set, with their root and octave settings
+  void QuantizeAll(uint32_t channels, const int32_t *cv, const int32_t *transpose, int32_t *out);
   int QuantizerLookup(int ch, int note);
   void QuantizerConfigure(int ch, int scale, uint16_t mask = 0xffff);
+  // From loop(): lookup tables for quantizers configured since the last call
+  void PollQuantizers();
   int GetScale(int ch);
   int GetRootNote(int ch);
   int SetRootNote(int ch, int root);
@@ -2,11 +2,88 @@
 
 HS::IOFrame HS::frame;
 HS::ClockManager HS::clock_m;
+util::SPSCQueue<HS::MIDIEvent, HS::kMIDIEventQueueDepth> HS::midi_events;
+
+#if defined(__IMXRT1062__)
+util::MIDIRouter<HS::MIDI_PORT_COUNT, HS::MIDI_OUTPUT_PORTS, HS::kMIDIOutQueueDepth> HS::midi_router;
+util::SPSCQueue<HS::MIDIEvent, HS::kMIDIEventQueueDepth> HS::midi_out_events;
+
+static util::MIDIMessage midi_message(const HS::MIDIEvent &event) {
+    const uint8_t status = event.message < 0xf0 ? event.message | ((event.channel - 1) & 0x0f) : event.message;
+    return { status, event.data1, event.data2 };
+}
+
+// The router belongs to loop(); sends from the ISR are queued for it
+static inline bool in_isr() {
+    uint32_t ipsr;
+    __asm__ volatile("mrs %0, ipsr" : "=r" (ipsr));
+    return ipsr != 0;
+}
+
+void HS::InitMIDIRouter() {
+    midi_router.Init();
+    // Thru as before: everything but program changes, which select presets here
+    for (int src = 0; src < MIDI_OUTPUT_PORTS; ++src) {
+        for (int dst = 0; dst < MIDI_OUTPUT_PORTS; ++dst) {
+            if (src != dst) midi_router.route(src, dst).types &= ~util::MIDI_ROUTE_PROGRAM;
+        }
+    }
+#ifdef ARDUINO_TEENSY41
+    if (!MIDI_Uses_Serial8)
+#endif
+    {
+        for (int port = 0; port < MIDI_PORT_COUNT; ++port) {
+            midi_router.route(port, MIDI_PORT_DIN).types = util::MIDI_ROUTE_NONE;
+            midi_router.route(MIDI_PORT_DIN, port).types = util::MIDI_ROUTE_NONE;
+        }
+    }
+}
+
+void HS::PollMIDIOut() {
+    MIDIEvent event;
+    while (midi_out_events.Pop(event))
+        midi_router.Route(MIDI_PORT_INTERNAL, midi_message(event));
+
+    midi_router.Drain(MIDI_PORT_USB, [](const util::MIDIMessage &msg) {
+        usbMIDI.send(msg.is_channel() ? msg.status & 0xf0 : msg.status, msg.data1, msg.data2, msg.channel() + 1, 0);
+        return true;
+    }, kMIDIUSBMessagesPerPoll);
+    midi_router.Drain(MIDI_PORT_USB_HOST, [](const util::MIDIMessage &msg) {
+        usbHostMIDI.send(msg.is_channel() ? msg.status & 0xf0 : msg.status, msg.data1, msg.data2, msg.channel() + 1, 0);
+        return true;
+    }, kMIDIUSBMessagesPerPoll);
+#ifdef ARDUINO_TEENSY41
+    if (MIDI_Uses_Serial8)
+        midi_router.DrainBytes(MIDI_PORT_DIN, Serial8);
+    else
+#endif
+        midi_router.ClearQueue(MIDI_PORT_DIN);
+}
+
+void HS::SendMIDI(int message, int channel, int data1, int data2) {
+    const MIDIEvent event = { uint8_t(message), uint8_t(channel), uint8_t(data1), uint8_t(data2) };
+    if (!in_isr())
+        midi_router.Route(MIDI_PORT_INTERNAL, midi_message(event));
+    else if (!midi_out_events.Push(event))
+        ++OC::DEBUG::MIDI_out_overflow;
+}
+#else
+void HS::SendMIDI(int message, int channel, int data1, int data2) {
+    if (message >= 0xf8)
+        usbMIDI.sendRealTime(message);
+    else
+        usbMIDI.send(message, data1, data2, channel, 0);
+}
+#endif
 
 int HemisphereApplet::cursor_countdown[APPLET_SLOTS];
 const char* HemisphereApplet::help[HELP_LABEL_COUNT];
+#ifdef __IMXRT1062__
+HemisphereApplet *HemisphereApplet::view_owner[APPLET_SLOTS];
+uint8_t HemisphereApplet::view_cache[APPLET_SLOTS][kViewWidth * weegfx::Graphics::kHeight / 8];
+#endif
 
-void HemisphereApplet::BaseController() {
+void HemisphereApplet::BaseController(bool due) {
     // I moved the IO-related stuff to the parent HemisphereManager app.
     // The IOFrame gets loaded before calling Controllers, and outputs are handled after.
     // -NJM
@@ -14,15 +91,88 @@ void HemisphereApplet::BaseController() {
     // Cursor countdowns. See CursorBlink(), ResetCursor(), gfxCursor()
     if (--cursor_countdown[hemisphere] < -HEMISPHERE_CURSOR_TICKS) cursor_countdown[hemisphere] = HEMISPHERE_CURSOR_TICKS;
 
-    Controller();
+    const ControlRate rate = GetControlRate();
+    if (rate == CONTROL_RATE_FULL) {
+        ramp_ticks = 0;
+        Controller();
+        return;
+    }
+
+    // Gates can't wait for the next turn
+    const uint8_t gates = Gate(0) | (Gate(1) << 1);
+    if (gates != last_gates) {
+        last_gates = gates;
+        due = true;
+    }
+
+    if (due && rate == CONTROL_RATE_SMOOTH) {
+        // What Controller() writes becomes the target; the ramp below moves the
+        // outputs there through frame.Out(), so output_diff and the loopback
+        // edges follow the ramp as if it had been computed every tick
+        const uint16_t ours = 3u << io_offset;
+        const uint16_t edges = frame.clockout_mask & ours;
+        const int from[2] = { frame.outputs[io_offset], frame.outputs[io_offset + 1] };
+        Controller();
+        ramp_ticks = 0;
+        ForEachChannel(ch) {
+            frame.outputs_smooth[io_offset + ch] = frame.outputs[io_offset + ch];
+            frame.outputs[io_offset + ch] = from[ch];
+            if (frame.outputs_smooth[io_offset + ch] != from[ch]) ramp_ticks = CONTROL_RATE_INTERVAL;
+        }
+        frame.clockout_mask = (frame.clockout_mask & ~ours) | edges;
+    } else if (due) {
+        Controller();
+        return;
+    }
+
+    if (!ramp_ticks) {
+        // Settled, as if Controller() had written the same values again
+        frame.output_diff[io_offset] = frame.output_diff[io_offset + 1] = 0;
+        return;
+    }
+    ForEachChannel(ch) {
+        const DAC_CHANNEL channel = (DAC_CHANNEL)(io_offset + ch);
+        const int value = frame.outputs[channel];
+        frame.Out(channel, value + (frame.outputs_smooth[channel] - value) / ramp_ticks);
+    }
+    --ramp_ticks;
 }
 
 void HemisphereApplet::BaseView(bool full_screen) {
+#ifdef __IMXRT1062__
+    const bool blink = CursorBlink();
+    const bool lazy = !full_screen && LazyView();
+    if (lazy) {
+        if (!view_dirty && view_blink == blink && view_owner[hemisphere] == this) {
+            graphics.restoreColumns(gfx_offset, kViewWidth, view_cache[hemisphere]);
+            return;
+        }
+        // Cleared before drawing, so a MarkDirty() from the ISR while View() runs
+        // is kept for the next frame
+        view_dirty = false;
+    }
+#endif
+
     //if (HS::select_mode == hemisphere)
     gfxHeader(applet_name(), (HS::ALWAYS_SHOW_ICONS || full_screen) ? applet_icon() : nullptr);
     // If active, draw the full screen view instead of the application screen
     if (full_screen) this->DrawFullScreen();
     else this->View();
+
+#ifdef __IMXRT1062__
+    if (lazy) {
+        // Managers draw their overlays after this, so the copy is the applet alone
+        graphics.saveColumns(gfx_offset, kViewWidth, view_cache[hemisphere]);
+        view_owner[hemisphere] = this;
+        view_blink = blink;
+    }
+#endif
+}
+
+void HemisphereApplet::InvalidateViews() {
+#ifdef __IMXRT1062__
+    for (auto &owner : view_owner) owner = nullptr;
+#endif
 }
 
 /*
@@ -52,11 +202,9 @@ bool HemisphereApplet::Clock(int ch, bool physical) {
         clocked = HS::clock_m.Tock(virt_chan);
     else if (trmap > 0) {
       if (trmap <= offset)
-        clocked = frame.clocked[ trmap - 1 ];
-      else {
-        clocked = frame.clockout_q[ trmap - 1 - offset ];
-        frame.clockout_q[ trmap - 1 - offset ] = false;
-      }
+        clocked = frame.clocked( trmap - 1 );
+      else
+        clocked = frame.TakeClockOut( trmap - 1 - offset );
     }
 
     // Try to eat a boop
@@ -52,11 +52,21 @@ namespace HS {
 typedef struct Applet {
   const int id;
   const uint8_t categories;
-  std::array<HemisphereApplet *, APPLET_SLOTS> instance;
+  // Applets only exist while a slot holds them; see HS::StartApplet()
+  HemisphereApplet *(*construct)(void *storage);
+  void (*destroy)(HemisphereApplet *applet);
 } Applet;
 
 extern IOFrame frame;
 
+// How often an applet's Controller() has to run; see GetControlRate()
+enum ControlRate : uint8_t {
+  CONTROL_RATE_FULL,   // every tick
+  CONTROL_RATE_HELD,   // every CONTROL_RATE_INTERVAL ticks, outputs held in between
+  CONTROL_RATE_SMOOTH, // every CONTROL_RATE_INTERVAL ticks, outputs ramped in between
+};
+static constexpr int CONTROL_RATE_INTERVAL = 16; // ~1kHz
+
 static constexpr bool ALWAYS_SHOW_ICONS = false;
 } // namespace HS
 
@@ -83,11 +93,36 @@ public:
     virtual void OnEncoderMove(int direction) = 0;
 
     //void BaseStart(const HEM_SIDE hemisphere_);
-    void BaseController();
+    // due is false on the ticks a slow applet skips, see GetControlRate()
+    void BaseController(bool due = true);
     void BaseView(bool full_screen = false);
 
+    /* Lazy redraw: applets that return true from LazyView() only have View() called
+     * when they've been marked dirty; otherwise their half of the screen is restored
+     * from the copy taken after the last View(). UI events, cursor blink and BaseStart
+     * mark dirty already, so Controller() only needs to call MarkDirty() when
+     * something that View() shows changes on its own.
+     * T4.x only: the copies take 512 bytes per slot, which T3.2 doesn't have, so
+     * it draws every frame as before.
+     */
+    virtual bool LazyView() { return false; }
+
+    /* Control rate: applets that only follow CV at modulation speed can skip the
+     * full ISR rate. The manager runs them every CONTROL_RATE_INTERVAL ticks,
+     * staggered against each other, and right away whenever one of their Gate()
+     * inputs changes. In between, HELD keeps the outputs where Controller() left
+     * them; SMOOTH ramps them there over the interval, so the outputs settle
+     * within two intervals (still inside HEMISPHERE_ADC_LAG) of an input change.
+     * Applets that use Clock() or ClockOut() need CONTROL_RATE_FULL.
+     */
+    virtual ControlRate GetControlRate() { return CONTROL_RATE_FULL; }
+    void MarkDirty() { view_dirty = true; }
+    // Forget all cached halves, e.g. after something else took over the screen
+    static void InvalidateViews();
+
     void BaseStart(const HEM_SIDE hemisphere_) {
         hemisphere = hemisphere_;
+        MarkDirty();
 
         // Initialize some things for startup
         cursor_countdown[hemisphere] = HEMISPHERE_CURSOR_TICKS;
@@ -185,7 +220,7 @@ public:
     int ViewIn(int ch) {return frame.inputs[io_offset + ch];}
     int ViewOut(int ch) {return frame.outputs[io_offset + ch];}
     uint32_t ClockCycleTicks(int ch) {return frame.cycle_ticks[io_offset + ch];}
-    bool Changed(int ch) {return frame.changed_cv[io_offset + ch];}
+    bool Changed(int ch) {return frame.changed_cv(io_offset + ch);}
 
     //////////////// Offset I/O methods
     ////////////////////////////////////////////////////////////////////////////////
@@ -219,7 +254,7 @@ public:
         const int t = trigger_mapping[ch + io_offset];
         const int offset = OC::DIGITAL_INPUT_LAST + ADC_CHANNEL_LAST;
         if (!t) return false;
-        return (t <= offset) ? frame.gate_high[t - 1] : (frame.outputs[t - 1 - offset] > GATE_THRESHOLD);
+        return (t <= offset) ? frame.gate_high(t - 1) : (frame.outputs[t - 1 - offset] > GATE_THRESHOLD);
     }
     void Out(int ch, int value, int octave = 0) {
         frame.Out( (DAC_CHANNEL)(ch + io_offset), value + (octave * (12 << 7)));
@@ -502,7 +537,17 @@ protected:
     }
 
 private:
+#ifdef __IMXRT1062__
+    static constexpr int kViewWidth = 64;
+    static HemisphereApplet *view_owner[APPLET_SLOTS];
+    static uint8_t view_cache[APPLET_SLOTS][kViewWidth * weegfx::Graphics::kHeight / 8];
+#endif
+
     bool applet_started; // Allow the app to maintain state during switching
+    volatile bool view_dirty = true; // set by Controller() in the ISR, too
+    bool view_blink = false; // CursorBlink() when the cached view was drawn
+    uint8_t last_gates = 0; // Gate() inputs at the last Controller(), for slow applets
+    uint8_t ramp_ticks = 0; // left until the outputs reach frame.outputs_smooth
     int16_t cursor_start_x;
     int16_t cursor_start_y;
 };
@@ -41,6 +41,7 @@
 #include "src/drivers/display.h"
 #include "src/drivers/ADC/OC_util_ADC.h"
 #include "util/util_debugpins.h"
+#include "util/util_framestream.h"
 #include "VBiasManager.h"
 #include "HSMIDI.h"
 
@@ -61,6 +62,9 @@ uint_fast8_t MENU_REDRAW = true;
 OC::UiMode ui_mode = OC::UI_MODE_MENU;
 const bool DUMMY = false;
 
+// Remote screen, over USB serial
+util::FrameStreamer<SH1106_128x64_Driver::kFrameSize, SH1106_128x64_Driver::kPageSize> screen_stream;
+
 /*  ------------------------ UI timer ISR ---------------------------   */
 
 IntervalTimer UI_timer;
@@ -85,7 +89,10 @@ void FASTRUN CORE_timer_ISR() {
   // next ISR, the display transfer is finalized (CS update).
 
   display::Flush();
-  OC::DAC::Update();
+  {
+    OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::DAC_cycles);
+    OC::DAC::Update();
+  }
   display::Update();
 
   // see OC_ADC.h for details; empirically (with current parameters), Scan_DMA() picks up new samples @ 5.55kHz
@@ -136,6 +143,7 @@ void setup() {
 
   // USB Host support for both 4.0 and 4.1
   usbHostMIDI.begin();
+  HS::InitMIDIRouter();
 #endif
 #if defined(__MK20DX256__)
   NVIC_SET_PRIORITY(IRQ_PORTB, 0); // TR1 = 0 = PTB16
@@ -255,11 +263,23 @@ void FASTRUN loop() {
         MENU_REDRAW = 0;
         LAST_REDRAW_TIME = millis();
       GRAPHICS_END_FRAME();
+
+      // Pages the link had no room for go out with the next redraw
+      if (screen_stream.active() && Serial)
+        screen_stream.Poll(display::frame_buffer.last_written_frame(), Serial);
     }
 
     // Run current app
     OC::apps::current_app->loop();
 
+    // Write out pending app data, if any
+    OC::poll_app_data();
+
+#if defined(__IMXRT1062__)
+    // MIDI output from all apps and thru
+    HS::PollMIDIOut();
+#endif
+
     // UI events
     OC::UiMode mode = OC::ui.DispatchEvents(OC::apps::current_app);
 
@@ -277,11 +297,20 @@ void FASTRUN loop() {
 
     static size_t cap_idx = 0;
     static elapsedMicros cap_send_time = 0;
-    // check for request from PC to capture the screen
+    // check for request from PC: 's' starts streaming the screen (see
+    // res/oc_screen.py), 'q' stops it, anything else captures one frame
     if (Serial && Serial.available() > 0) {
-      do { Serial.read(); } while (Serial.available() > 0);
-      display::frame_buffer.capture_request();
-      cap_idx = 0;
+      bool capture = false;
+      do {
+        const int c = Serial.read();
+        if (c == 's') screen_stream.Start();
+        else if (c == 'q') screen_stream.Stop();
+        else capture = true;
+      } while (Serial.available() > 0);
+      if (capture) {
+        display::frame_buffer.capture_request();
+        cap_idx = 0;
+      }
     }
 
     // check for frame buffer to have capture data ready
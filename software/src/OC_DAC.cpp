@@ -119,6 +119,7 @@ void DAC::Init(CalibrationData *calibration_data, bool flip180) {
 #endif
 
   set_all(0xffff);
+  Invalidate();
   Update();
 }
 
@@ -277,100 +278,73 @@ uint16_t DAC::history_[DAC_CHANNEL_LAST][DAC::kHistoryDepth];
 volatile size_t DAC::history_tail_;
 /*static*/ 
 uint8_t DAC::DAC_scaling[DAC_CHANNEL_LAST];
+/*static*/
+uint32_t DAC::written_[DAC_CHANNEL_LAST];
+/*static*/
+uint32_t DAC::update_mask_;
+/*static*/
+int DAC::refresh_channel_;
+/*static*/
+int DAC::channels_written_;
 }; // namespace OC
 
-#if defined(__MK20DX256__)
-void set8565_CHA(uint32_t data) {
+static inline uint32_t dac8565_data(uint32_t data) {
   #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
+  return data;
   #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
+  return OC::DAC::MAX_VALUE - data;
   #endif
-  SPIFIFO.write(0b00010000, SPI_CONTINUE);
-  SPIFIFO.write16(_data);
-  SPIFIFO.read();
-  SPIFIFO.read();
 }
 
-void set8565_CHB(uint32_t data) {
-  #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
-  #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
-  #endif
-  SPIFIFO.write(0b00010010, SPI_CONTINUE);
-  SPIFIFO.write16(_data);
-  SPIFIFO.read();
-  SPIFIFO.read();
-}
-
-void set8565_CHC(uint32_t data) {
-  #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
-  #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
-  #endif
-  SPIFIFO.write(0b00010100, SPI_CONTINUE);
-  SPIFIFO.write16(_data);
-  SPIFIFO.read();
-  SPIFIFO.read(); 
-}
-
-void set8565_CHD(uint32_t data) {
-  #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
-  #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
-  #endif
-  SPIFIFO.write(0b00010110, SPI_CONTINUE);
-  SPIFIFO.write16(_data);
-  SPIFIFO.read();
-  SPIFIFO.read();
+#if defined(__MK20DX256__)
+/*static*/
+void OC::DAC::WriteChannels(uint32_t mask, const uint32_t *values) {
+  // Queue the next frame before draining the previous one's RX entries, so
+  // the FIFO never runs dry between channels (at most two frames = 4 entries
+  // in flight).
+  bool pending = false;
+  for (int i = 0; i < DAC_CHANNEL_LAST; ++i) {
+    if (!(mask & (1 << i))) continue;
+    SPIFIFO.write(0b00010000 | (i << 1), SPI_CONTINUE);
+    SPIFIFO.write16(dac8565_data(values[i]));
+    if (pending) {
+      SPIFIFO.read();
+      SPIFIFO.read();
+    }
+    pending = true;
+  }
+  if (pending) {
+    SPIFIFO.read();
+    SPIFIFO.read();
+  }
 }
 
-#elif defined(__IMXRT1062__) // Teensy 4.1
-void set8565_CHA(uint32_t data) {
+#elif defined(__IMXRT1062__)
+/*static*/
+void OC::DAC::WriteChannels(uint32_t mask, const uint32_t *values) {
+#if defined(ARDUINO_TEENSY41)
+  if (DAC8568_Uses_SPI) {
+    for (int i = 0; i < DAC_CHANNEL_LAST; ++i) {
+      if (mask & (1 << i))
+        dac8568_set_channel(i, values[i]);
+    }
+    return;
+  }
+#endif
+  // mask always has at least the refresh channel set, so there is a last
+  // frame to clear the transmit complete flag before
   LPSPI4_TCR = (LPSPI4_TCR & 0xF8000000) | LPSPI_TCR_FRAMESZ(23)
     | LPSPI_TCR_PCS(0) | LPSPI_TCR_RXMSK;
-  #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
-  #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
-  #endif
-  _data = (0b00010000 << 16) | (_data & 0xFFFF);
-  LPSPI4_TDR = _data;
-}
-
-void set8565_CHB(uint32_t data) {
-  #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
-  #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
-  #endif
-  _data = (0b00010010 << 16) | (_data & 0xFFFF);
-  LPSPI4_TDR = _data;
-}
-void set8565_CHC(uint32_t data) {
-  #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
-  #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
-  #endif
-  _data = (0b00010100 << 16) | (_data & 0xFFFF);
-  LPSPI4_TDR = _data;
-}
-void set8565_CHD(uint32_t data) {
-  #if defined(NORTHERNLIGHT) && !defined(NLM_DIY)
-  uint32_t _data = data;
-  #else
-  uint32_t _data = OC::DAC::MAX_VALUE - data;
-  #endif
-  _data = (0b00010110 << 16) | (_data & 0xFFFF);
-  LPSPI4_SR = LPSPI_SR_TCF; //  clear transmit complete flag before last write to FIFO
-  LPSPI4_TDR = _data;
+  const int last = 31 - __builtin_clz(mask);
+  for (int i = 0; i <= last; ++i) {
+    if (!(mask & (1 << i))) continue;
+    const uint32_t frame = ((0b00010000 | (i << 1)) << 16) | (dac8565_data(values[i]) & 0xFFFF);
+    if (i == last)
+      LPSPI4_SR = LPSPI_SR_TCF; //  clear transmit complete flag before last write to FIFO
+    LPSPI4_TDR = frame;
+  }
 }
-
-#endif // __IMXRT1062__
+#endif
 
 // adapted from https://github.com/xxxajk/spi4teensy3 (MISO disabled) : 
 
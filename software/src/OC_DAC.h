@@ -9,10 +9,6 @@
 #include "util/util_math.h"
 #include "util/util_macros.h"
 
-extern void set8565_CHA(uint32_t data);
-extern void set8565_CHB(uint32_t data);
-extern void set8565_CHC(uint32_t data);
-extern void set8565_CHD(uint32_t data);
 #if defined(__IMXRT1062__) && defined(ARDUINO_TEENSY41)
 static inline void dac8568_raw_write(uint32_t data) {
   LPSPI4_TDR = data; // assume writes always at pace SPI FIFO can absorb
@@ -230,26 +226,26 @@ public:
     return calibration_data_->calibrated_octaves[channel][kOctaveZero + octave];
   }
 
+  // Only channels whose value changed since they were last written go out,
+  // as one batch. One channel per tick is rewritten regardless: every
+  // channel gets refreshed at least every DAC_CHANNEL_LAST ticks, and there
+  // is always a DAC frame for the display transfer to chain from (see
+  // SH1106_128x64_Driver::SendPage).
   static void Update() {
-    #if defined(__IMXRT1062__) && defined(ARDUINO_TEENSY41)
-      if (DAC8568_Uses_SPI) {
-        dac8568_set_channel(0, values_[DAC_CHANNEL_A]);
-        dac8568_set_channel(1, values_[DAC_CHANNEL_B]);
-        dac8568_set_channel(2, values_[DAC_CHANNEL_C]);
-        dac8568_set_channel(3, values_[DAC_CHANNEL_D]);
-        dac8568_set_channel(4, values_[DAC_CHANNEL_E]);
-        dac8568_set_channel(5, values_[DAC_CHANNEL_F]);
-        dac8568_set_channel(6, values_[DAC_CHANNEL_G]);
-        dac8568_set_channel(7, values_[DAC_CHANNEL_H]);
-      } else {
-    #endif
-        set8565_CHA(values_[DAC_CHANNEL_A]);
-        set8565_CHB(values_[DAC_CHANNEL_B]);
-        set8565_CHC(values_[DAC_CHANNEL_C]);
-        set8565_CHD(values_[DAC_CHANNEL_D]);
-    #if defined(__IMXRT1062__) && defined(ARDUINO_TEENSY41)
-      }
-    #endif
+    // snapshot in physical channel order; values_ may be set from loop()
+    uint32_t values[DAC_CHANNEL_LAST];
+    for (int i = 0; i < DAC_CHANNEL_LAST; ++i)
+      values[i] = values_[physical_channel(i)];
+
+    uint32_t mask = update_mask_ | (1 << refresh_channel_);
+    update_mask_ = 0;
+    refresh_channel_ = (refresh_channel_ + 1) % DAC_CHANNEL_LAST;
+    for (int i = 0; i < DAC_CHANNEL_LAST; ++i) {
+      if (values[i] != written_[i]) mask |= 1 << i;
+      written_[i] = values[i];
+    }
+    WriteChannels(mask, values);
+    channels_written_ = __builtin_popcount(mask);
 
     size_t tail = history_tail_;
     for (int i = 0; i < DAC_CHANNEL_LAST; ++i)
@@ -257,6 +253,16 @@ public:
     history_tail_ = (tail + 1) % kHistoryDepth;
   }
 
+  // Write all channels on the next Update()
+  static void Invalidate() {
+    update_mask_ = (1 << DAC_CHANNEL_LAST) - 1;
+  }
+
+  // Number of channels sent by the last Update()
+  static int channels_written() {
+    return channels_written_;
+  }
+
   static void getHistory(int channel, uint16_t *dst){
     size_t head = (history_tail_ + 1) % kHistoryDepth;
 
@@ -274,9 +280,31 @@ public:
 private:
   static CalibrationData *calibration_data_;
   static uint32_t values_[DAC_CHANNEL_LAST];
+  static uint32_t written_[DAC_CHANNEL_LAST]; // physical order
+  static uint32_t update_mask_;
+  static int refresh_channel_;
+  static int channels_written_;
   static uint16_t history_[DAC_CHANNEL_LAST][kHistoryDepth];
   static volatile size_t history_tail_;
   static uint8_t DAC_scaling[DAC_CHANNEL_LAST];
+
+  // Index into values_ of the Nth physical output (A, B, ...)
+  static DAC_CHANNEL physical_channel(int i) {
+  #if defined(__IMXRT1062__) && defined(ARDUINO_TEENSY41)
+    static DAC_CHANNEL * const channels[DAC_CHANNEL_LAST] = {
+      &DAC_CHANNEL_A, &DAC_CHANNEL_B, &DAC_CHANNEL_C, &DAC_CHANNEL_D,
+      &DAC_CHANNEL_E, &DAC_CHANNEL_F, &DAC_CHANNEL_G, &DAC_CHANNEL_H
+    };
+  #else
+    static DAC_CHANNEL * const channels[DAC_CHANNEL_LAST] = {
+      &DAC_CHANNEL_A, &DAC_CHANNEL_B, &DAC_CHANNEL_C, &DAC_CHANNEL_D
+    };
+  #endif
+    return *channels[i];
+  }
+
+  // Send the masked physical channels as a single batch
+  static void WriteChannels(uint32_t mask, const uint32_t *values);
 };
 
 }; // namespace OC
@@ -33,6 +33,10 @@
 #include "src/drivers/FreqMeasure/OC_FreqMeasure.h"
 #include "util/util_pagestorage.h"
 #include "util/EEPROMStorage.h"
+#ifdef OC_APP_STORAGE_FILE
+#include <LittleFS.h>
+#include "util/util_chunkstore.h"
+#endif
 #include "VBiasManager.h"
 #include "HSClockManager.h"
 
@@ -220,6 +224,24 @@ DMAMEM GlobalSettingsStorage global_settings_storage;
 DMAMEM AppData app_settings;
 DMAMEM AppDataStorage app_data_storage;
 
+#ifdef OC_APP_STORAGE_FILE
+// EEPROM app data is only read once, to migrate existing settings
+static constexpr uint32_t kAppStorageFlashSize = 256 * 1024;
+static const char * const kAppStoragePath = "/oc_apps.jnl";
+static const char * const kAppStorageTmpPath = "/oc_apps.tmp";
+
+typedef ChunkStore<LittleFS_Program, File, AppData::kAppDataSize, NUM_AVAILABLE_APPS> AppChunkStore;
+
+LittleFS_Program app_fs;
+DMAMEM AppChunkStore app_chunk_store;
+static bool app_fs_ready = false;
+#endif
+
+// EEPROM bytes per poll_app_data() call; each byte that changed takes a
+// while to write, and loop() runs often enough that a page is out in well
+// under a second anyway
+static constexpr size_t kStorageBytesPerPoll = 16;
+
 static constexpr int DEFAULT_APP_INDEX = 1;
 static const uint16_t DEFAULT_APP_ID = available_apps[DEFAULT_APP_INDEX].id;
 
@@ -238,8 +260,8 @@ void save_global_settings() {
   // scaling settings:
   global_settings.DAC_scaling = OC::DAC::store_scaling();
 
-  global_settings_storage.Save(global_settings);
-  SERIAL_PRINTLN("Saved global settings: page_index %d", global_settings_storage.page_index());
+  if (global_settings_storage.BeginSave(global_settings))
+    SERIAL_PRINTLN("Saving global settings: page_index %d", global_settings_storage.page_index());
 }
 
 static constexpr size_t total_storage_size() {
@@ -255,8 +277,31 @@ static constexpr size_t totalsize = total_storage_size();
 static_assert(totalsize < OC::AppData::kAppDataSize, "EEPROM Allocation Exceeded");
 
 void save_app_data() {
+  // Apps' state is changed by the app ISR, so it's held off while taking the
+  // snapshot; that's only the Save() calls and a copy into the storage's page
+  // buffer, the writes happen in poll_app_data()
+  const bool isr_enabled = CORE::app_isr_enabled;
+  CORE::app_isr_enabled = false;
+
   save_global_settings(); // yeah, why not
 
+#ifdef OC_APP_STORAGE_FILE
+  if (app_fs_ready) {
+    // app_settings is only used as scratch space here
+    size_t changed = 0;
+    for (const App &app : available_apps) {
+      const size_t storage_size = app.storageSize();
+      if (!storage_size || !app.Save) continue;
+      app.Save(app_settings.data);
+      if (app_chunk_store.Stage(app.id, app_settings.data, storage_size))
+        ++changed;
+    }
+    CORE::app_isr_enabled = isr_enabled;
+    SERIAL_PRINTLN("App data: %u of %u chunks changed", changed, app_chunk_store.num_chunks());
+    return;
+  }
+#endif
+
   SERIAL_PRINTLN("Save app data... (%u bytes available)", OC::AppData::kAppDataSize);
 
   app_settings.used = 0;
@@ -286,11 +331,62 @@ void save_app_data() {
       data += chunk->length;
     }
   }
+  const bool changed = app_data_storage.BeginSave(app_settings);
+  CORE::app_isr_enabled = isr_enabled;
+
   SERIAL_PRINTLN("App settings used: %u/%u", app_settings.used, EEPROM_APPDATA_BINARY_SIZE);
-  app_data_storage.Save(app_settings);
-  SERIAL_PRINTLN("Saved app settings in page_index %d", app_data_storage.page_index());
+  if (changed)
+    SERIAL_PRINTLN("Saving app settings in page_index %d", app_data_storage.page_index());
+}
+
+void poll_app_data() {
+  if (global_settings_storage.Poll(kStorageBytesPerPoll))
+    return;
+#ifdef OC_APP_STORAGE_FILE
+  if (app_fs_ready) {
+    app_chunk_store.Poll();
+    return;
+  }
+#endif
+  app_data_storage.Poll(kStorageBytesPerPoll);
 }
 
+bool app_data_pending() {
+#ifdef OC_APP_STORAGE_FILE
+  if (app_fs_ready && app_chunk_store.pending())
+    return true;
+#endif
+  return global_settings_storage.busy() || app_data_storage.busy();
+}
+
+#ifdef OC_APP_STORAGE_FILE
+// Rebuild the chunk blob from the journal, so restore_app_data() works the
+// same for both sources
+static bool load_app_chunks() {
+  if (!app_fs_ready || !app_chunk_store.Begin(&app_fs, kAppStoragePath, kAppStorageTmpPath))
+    return false;
+
+  app_settings.used = 0;
+  char *data = app_settings.data;
+  char *data_end = data + AppData::kAppDataSize;
+  for (size_t i = 0; i < app_chunk_store.num_chunks(); ++i) {
+    size_t storage_size = app_chunk_store.chunk_length(i) + sizeof(AppChunkHeader);
+    if (storage_size & 1) ++storage_size;
+    if (data + storage_size > data_end) break;
+
+    AppChunkHeader *chunk = reinterpret_cast<AppChunkHeader *>(data);
+    chunk->id = app_chunk_store.chunk_id(i);
+    chunk->length = storage_size;
+    memset(chunk + 1, 0, storage_size - sizeof(AppChunkHeader));
+    memcpy(chunk + 1, app_chunk_store.chunk_data(i), app_chunk_store.chunk_length(i));
+    app_settings.used += storage_size;
+    data += storage_size;
+  }
+  SERIAL_PRINTLN("Loaded %u app chunks from %s (%u bytes)", app_chunk_store.num_chunks(), kAppStoragePath, app_chunk_store.journal_size());
+  return true;
+}
+#endif
+
 void restore_app_data() {
   SERIAL_PRINTLN("Restoring app data from page_index %d, used=%u", app_data_storage.page_index(), app_settings.used);
 
@@ -379,6 +475,11 @@ void Init(bool reset_settings) {
   global_settings.reserved1 = false;
   global_settings.DAC_scaling = VOLTAGE_SCALING_1V_PER_OCT;
 
+#ifdef OC_APP_STORAGE_FILE
+  app_fs_ready = app_fs.begin(kAppStorageFlashSize);
+  SERIAL_PRINTLN("App storage %s", app_fs_ready ? "on LittleFS" : "unavailable, using EEPROM");
+#endif
+
   if (reset_settings) {
     if (ui.ConfirmReset()) {
       SERIAL_PRINTLN("Erase EEPROM ...");
@@ -390,6 +491,12 @@ void Init(bool reset_settings) {
       SERIAL_PRINTLN("Skip settings, using defaults...");
       global_settings_storage.Init();
       app_data_storage.Init();
+#ifdef OC_APP_STORAGE_FILE
+      if (app_fs_ready) {
+        app_chunk_store.Begin(&app_fs, kAppStoragePath, kAppStorageTmpPath);
+        app_chunk_store.Clear();
+      }
+#endif
     } else {
       reset_settings = false;
     }
@@ -428,6 +535,11 @@ void Init(bool reset_settings) {
                   AppDataStorage::PAGES,
                   AppDataStorage::LENGTH);
 
+#ifdef OC_APP_STORAGE_FILE
+    if (load_app_chunks()) {
+      restore_app_data();
+    } else
+#endif
     if (!app_data_storage.Load(app_settings)) {
       SERIAL_PRINTLN("Data not loaded, using defaults!");
     } else {
@@ -567,8 +679,10 @@ void Ui::AppSettings() {
       save_app_data();
       // draw message:
       int cnt = 0;
-      while(idle_time() < SETTINGS_SAVE_TIMEOUT_MS)
+      while(idle_time() < SETTINGS_SAVE_TIMEOUT_MS || app_data_pending()) {
+        poll_app_data();
         draw_save_message((cnt++) >> 4);
+      }
     }
   }
 
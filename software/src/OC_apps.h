@@ -85,8 +85,19 @@ namespace apps {
 
 }; // namespace apps
 
+// save_app_data() only takes a snapshot of the settings, and poll_app_data()
+// writes it out from loop() a bit at a time; app_data_pending() is true until
+// it's all written.
+// On Teensy 4.x app data is kept in a journal file on LittleFS in program
+// flash, where only the chunks that changed are written, one per call.
+#if defined(__IMXRT1062__)
+#define OC_APP_STORAGE_FILE
+#endif
+
 void draw_save_message(uint8_t c);
 void save_app_data();
+void poll_app_data();
+bool app_data_pending();
 void start_calibration();
 
 }; // namespace OC
@@ -15,6 +15,7 @@ static constexpr uint32_t OC_UI_TIMER_RATE   = 1000UL;
 
 // From kinetis.h
 // Cortex-M4: 0,16,32,48,64,80,96,112,128,144,160,176,192,208,224,240
+static constexpr int OC_GPIO_PIN_PRIO   = 64;  // T4.x pin edges: above CORE, below display SPI (48)
 static constexpr int OC_CORE_TIMER_PRIO = 80;  // yet higher
 static constexpr int OC_GPIO_ISR_PRIO   = 112; // higher
 static constexpr int OC_UI_TIMER_PRIO   = 128; // default
@@ -1,6 +1,8 @@
 #include <Arduino.h>
 #include "HSicons.h"
+#include "HSMIDI.h"
 #include "OC_ADC.h"
+#include "OC_DAC.h"
 #include "OC_digital_inputs.h"
 #include "OC_config.h"
 #include "OC_core.h"
@@ -51,14 +53,27 @@ namespace DEBUG {
   debug::AveragedCycles ISR_cycles;
   debug::AveragedCycles UI_cycles;
   debug::AveragedCycles MENU_draw_cycles;
+  debug::AveragedCycles DAC_cycles;
   uint32_t UI_event_count;
   uint32_t UI_max_queue_depth;
   uint32_t UI_queue_overflow;
+  uint32_t MIDI_event_count;
+  uint32_t MIDI_max_queue_depth;
+  uint32_t MIDI_queue_overflow;
+  uint32_t MIDI_out_overflow;
+  debug::AveragedCycles APPLET_cycles[kAppletSlots];
+  debug::AveragedCycles CLOCK_cycles;
+  int APPLET_ids[kAppletSlots] = { kNoApplet, kNoApplet, kNoApplet, kNoApplet };
 
   void Init() {
     debug::CycleMeasurement::Init();
     DebugPins::Init();
   }
+
+  void ResetAppletCycles() {
+    for (auto &id : APPLET_ids) id = kNoApplet;
+    CLOCK_cycles.Clear();
+  }
 }; // namespace DEBUG
 
 static void debug_menu_core() {
@@ -83,8 +98,42 @@ static void debug_menu_core() {
 #ifdef OC_UI_DEBUG
   graphics.setPrintPos(2, 42);
   graphics.printf("UI   !%lu #%lu", DEBUG::UI_queue_overflow, DEBUG::UI_event_count);
-  graphics.setPrintPos(2, 52);
+#else
+  graphics.setPrintPos(2, 42);
+  graphics.printf("DAC %4lu/%4lu %dch",
+                  DEBUG::DAC_cycles.value(),
+                  DEBUG::DAC_cycles.max_value(),
+                  DAC::channels_written());
 #endif
+  graphics.setPrintPos(2, 52);
+  graphics.printf("MIDI !%lu #%lu ^%lu", DEBUG::MIDI_queue_overflow, DEBUG::MIDI_event_count, DEBUG::MIDI_max_queue_depth);
+}
+
+static void debug_menu_applets() {
+  static const char * const slot_names[DEBUG::kAppletSlots] = { "L1", "R1", "L2", "R2" };
+
+  if (!DEBUG::CLOCK_cycles.max_value()) {
+    graphics.setPrintPos(2, 12);
+    graphics.print("Hemisphere not run");
+    return;
+  }
+
+  graphics.setPrintPos(2, 12);
+  graphics.printf("CLK %5lu/%5lu/%5lu",
+                  DEBUG::CLOCK_cycles.min_value(),
+                  DEBUG::CLOCK_cycles.value(),
+                  DEBUG::CLOCK_cycles.max_value());
+
+  int y = 22;
+  for (int slot = 0; slot < DEBUG::kAppletSlots; ++slot) {
+    if (DEBUG::kNoApplet == DEBUG::APPLET_ids[slot])
+      continue;
+    const auto &cycles = DEBUG::APPLET_cycles[slot];
+    graphics.setPrintPos(2, y);
+    graphics.printf("%s  %5lu/%5lu/%5lu", slot_names[slot],
+                    cycles.min_value(), cycles.value(), cycles.max_value());
+    y += 10;
+  }
 }
 
 static void debug_menu_version()
@@ -195,6 +244,25 @@ static void debug_menu_audio() {
 }
 #endif
 
+#if defined(__IMXRT1062__)
+static void debug_menu_midi() {
+  static const char * const port_names[HS::MIDI_OUTPUT_PORTS] = { "USB", "HST", "DIN" };
+
+  graphics.setPrintPos(2, 12);
+  graphics.print("     sent drp coa flt");
+  for (int port = 0; port < HS::MIDI_OUTPUT_PORTS; ++port) {
+    const util::MIDIPortStats &stats = HS::midi_router.stats(port);
+    graphics.setPrintPos(2, 22 + port * 10);
+    graphics.printf("%s%6lu%4lu%4lu%4lu", port_names[port],
+                    stats.sent, stats.dropped, stats.coalesced, stats.filtered);
+  }
+  graphics.setPrintPos(2, 52);
+  graphics.printf("RS -%lu ISR !%lu",
+                  HS::midi_router.stats(HS::MIDI_PORT_DIN).running_status,
+                  DEBUG::MIDI_out_overflow);
+}
+#endif
+
 #ifdef PEWPEWPEW
 static void debug_menu_pewpewpew() {
   int i = 0;
@@ -211,6 +279,7 @@ struct DebugMenu {
 
 static const DebugMenu debug_menus[] = {
   { " CORE", debug_menu_core },
+  { " APPLETS (cyc)", debug_menu_applets },
   { " VERS", debug_menu_version },
   { " GFX", debug_menu_gfx },
   { " ADC (raw)", debug_menu_adc },
@@ -218,6 +287,9 @@ static const DebugMenu debug_menus[] = {
   { " ADC (value)", debug_menu_adc_value },
   { " AUDIO", debug_menu_audio },
 #endif
+#if defined(__IMXRT1062__)
+  { " MIDI OUT", debug_menu_midi },
+#endif
 #ifdef POLYLFO_DEBUG  
   { " POLYLFO", POLYLFO_debug },
 #endif // POLYLFO_DEBUG
@@ -16,9 +16,38 @@ namespace DEBUG {
   extern debug::AveragedCycles UI_cycles;
   extern debug::AveragedCycles MENU_draw_cycles;
 
+  // DAC::Update() inside the CORE ISR. On T4.x this is the time to fill the
+  // LPSPI FIFO; the bus itself is busy for DAC::channels_written() frames of
+  // 24 bits after that.
+  extern debug::AveragedCycles DAC_cycles;
+
   extern uint32_t UI_event_count;
   extern uint32_t UI_max_queue_depth;
   extern uint32_t UI_queue_overflow;
+
+  extern uint32_t MIDI_event_count;
+  extern uint32_t MIDI_max_queue_depth;
+  extern uint32_t MIDI_queue_overflow;
+  extern uint32_t MIDI_out_overflow;
+
+  // Hemisphere/Quadrants Controller() cycles per applet slot, and for the
+  // Clock Setup controller. A slot's counters restart when its applet changes.
+  static constexpr int kAppletSlots = 4;
+  static constexpr int kNoApplet = -1;
+  extern debug::AveragedCycles APPLET_cycles[kAppletSlots];
+  extern debug::AveragedCycles CLOCK_cycles;
+  extern int APPLET_ids[kAppletSlots];
+
+  inline debug::AveragedCycles &applet_cycles(int slot, int applet_id) {
+    if (APPLET_ids[slot] != applet_id) {
+      APPLET_ids[slot] = applet_id;
+      APPLET_cycles[slot].Clear();
+    }
+    return APPLET_cycles[slot];
+  }
+
+  // Forget all slots, e.g. when switching between Hemisphere and Quadrants
+  void ResetAppletCycles();
 };
 
 class DebugPins {
@@ -37,6 +66,9 @@ public:
 #define OC_DEBUG_PROFILE_SCOPE(var) \
   debug::ScopedCycleMeasurement cycles(var)
 
+#define OC_DEBUG_PROFILE_APPLET(slot, applet_id) \
+  debug::ScopedCycleMeasurement applet_cycles(OC::DEBUG::applet_cycles(slot, applet_id))
+
 #define OC_DEBUG_RESET_CYCLES(counter, count, var) \
   do { \
     if (!((counter) & (count - 1))) \
@@ -4,14 +4,18 @@
 #include "OC_gpio.h"
 #include "OC_options.h"
 
-#if defined(__MK20DX256__) // Teensy 3.2
-
 /*static*/
 uint32_t OC::DigitalInputs::clocked_mask_;
 
 /*static*/
 volatile uint32_t OC::DigitalInputs::clocked_[DIGITAL_INPUT_LAST];
 
+/*static*/
+volatile uint32_t OC::DigitalInputs::edge_cycles_[DIGITAL_INPUT_LAST];
+
+/*static*/
+uint8_t OC::DigitalInputs::clock_phase_[DIGITAL_INPUT_LAST];
+
 void FASTRUN OC::tr1_ISR() {
   OC::DigitalInputs::clock<OC::DIGITAL_INPUT_1>();
 }  // main clock
@@ -29,6 +33,9 @@ void FASTRUN OC::tr4_ISR() {
 }
 
 /*static*/
+#if defined(__IMXRT1062__)
+FLASHMEM
+#endif
 void OC::DigitalInputs::Init() {
 
   static const struct {
@@ -41,18 +48,35 @@ void OC::DigitalInputs::Init() {
     {TR4, tr4_ISR},
   };
 
+#if defined(__MK20DX256__)
   for (auto pin : pins) {
     pinMode(pin.pin, OC_GPIO_TRx_PINMODE);
     attachInterrupt(pin.pin, pin.isr_fn, FALLING);
   }
+#elif defined(__IMXRT1062__)
+  // Edges used to be latched in the GPIO ISR register and polled in Scan();
+  // pin interrupts give us a timestamp as well. T4.1 detects the rising
+  // edge, T4.0 the falling edge, as before.
+  for (auto pin : pins) {
+    pinMode(pin.pin, INPUT_PULLUP);
+#ifdef ARDUINO_TEENSY41
+    attachInterrupt(pin.pin, pin.isr_fn, RISING);
+#else
+    attachInterrupt(pin.pin, pin.isr_fn, FALLING);
+#endif
+  }
+  // All four inputs share the fast GPIO interrupt. It has to be able to
+  // preempt the CORE ISR or edges during it are timestamped late, but not
+  // the display's SPI page transfer ISR above it.
+  NVIC_SET_PRIORITY(IRQ_GPIO6789, OC_GPIO_PIN_PRIO);
+#endif
 
   clocked_mask_ = 0;
   std::fill(clocked_, clocked_ + DIGITAL_INPUT_LAST, 0);
+  std::fill(clock_phase_, clock_phase_ + DIGITAL_INPUT_LAST, 0);
 
-  // Assume the priority of pin change interrupts is lower or equal to the
-  // thread where ::Scan function is called. Otherwise a safer mechanism is
-  // required to avoid conflicts (LDREX/STREX or store ARM_DWT_CYCCNT in the
-  // array to check for changes.
+  // The pin change interrupts may have higher priority than the thread where
+  // ::Scan is called, so it masks them briefly while it collects the edges.
   //
   // A really nice approach would be to use the FTM timer mechanism and avoid
   // the ISR altogether, but this only works for one of the pins. Using more
@@ -69,82 +93,13 @@ void OC::DigitalInputs::Init() {
 
 /*static*/
 void OC::DigitalInputs::Scan() {
-  clocked_mask_ =
-    ScanInput<DIGITAL_INPUT_1>() |
-    ScanInput<DIGITAL_INPUT_2>() |
-    ScanInput<DIGITAL_INPUT_3>() |
-    ScanInput<DIGITAL_INPUT_4>();
-}
-
-#endif // Teensy 3.2
-
-
-#if defined(__IMXRT1062__) // Teensy 4.0 or 4.1
-
-uint8_t OC::DigitalInputs::clocked_mask_;
-IMXRT_GPIO_t * OC::DigitalInputs::port[DIGITAL_INPUT_LAST];
-uint32_t  OC::DigitalInputs::bitmask[DIGITAL_INPUT_LAST];
-
-FLASHMEM
-void OC::DigitalInputs::Init() {
-  pinMode(TR1, INPUT_PULLUP);
-  pinMode(TR2, INPUT_PULLUP);
-  pinMode(TR3, INPUT_PULLUP);
-  pinMode(TR4, INPUT_PULLUP);
-  port[0] = (IMXRT_GPIO_t *)digitalPinToPortReg(TR1);
-  port[1] = (IMXRT_GPIO_t *)digitalPinToPortReg(TR2);
-  port[2] = (IMXRT_GPIO_t *)digitalPinToPortReg(TR3);
-  port[3] = (IMXRT_GPIO_t *)digitalPinToPortReg(TR4);
-  bitmask[0] = digitalPinToBitMask(TR1);
-  bitmask[1] = digitalPinToBitMask(TR2);
-  bitmask[2] = digitalPinToBitMask(TR3);
-  bitmask[3] = digitalPinToBitMask(TR4);
-  for (unsigned int i=0; i < 4; i++) {
-    unsigned int bitnum = __builtin_ctz(bitmask[i]);
-#ifdef ARDUINO_TEENSY41
-    if (bitnum < 16) {
-      // rising edge detect, bits 0-15
-      port[i]->ICR1 = (port[i]->ICR1 & ~(0x03 << (bitnum * 2))) | (0x02 << (bitnum * 2));
-    } else {
-      // rising edge detect, bits 16-31
-      port[i]->ICR2 = (port[i]->ICR2 & ~(0x03 << ((bitnum - 16) * 2))) | (0x02 << ((bitnum-16) * 2));
-    }
-#else
-    if (bitnum < 16) {
-      port[i]->ICR1 |= (0x03 << (bitnum * 2)); // falling edge detect, bits 0-15
-    } else {
-      port[i]->ICR2 |= (0x03 << ((bitnum - 16) * 2)); // falling edge detect, bits 16-31
-    }
-#endif
-    port[i]->ISR = bitmask[i]; // clear any prior detected edge
-  }
-}
-
-void OC::DigitalInputs::Scan() {
-  uint32_t mask[4];
+  // The pin ISRs may have higher priority (TR1 on T3.2, all of them on T4.x)
   noInterrupts();
-  mask[0] = port[0]->ISR & bitmask[0];
-  port[0]->ISR = mask[0];
-  mask[1] = port[1]->ISR & bitmask[1];
-  port[1]->ISR = mask[1];
-  mask[2] = port[2]->ISR & bitmask[2];
-  port[2]->ISR = mask[2];
-  mask[3] = port[3]->ISR & bitmask[3];
-  port[3]->ISR = mask[3];
+  const uint32_t now = ARM_DWT_CYCCNT;
+  clocked_mask_ =
+    ScanInput<DIGITAL_INPUT_1>(now) |
+    ScanInput<DIGITAL_INPUT_2>(now) |
+    ScanInput<DIGITAL_INPUT_3>(now) |
+    ScanInput<DIGITAL_INPUT_4>(now);
   interrupts();
-  uint8_t new_clocked_mask = 0;
-  if (mask[0]) new_clocked_mask |= 0x01;
-  if (mask[1]) new_clocked_mask |= 0x02;
-  if (mask[2]) new_clocked_mask |= 0x04;
-  if (mask[3]) new_clocked_mask |= 0x08;
-  clocked_mask_ = new_clocked_mask;
-  #if 0
-  if (clocked_mask_) {
-    static elapsedMicros usec;
-    Serial.printf("%u  %u\n", clocked_mask_, (int)usec);
-    usec = 0;
-  }
-  #endif
 }
-
-#endif // Teensy 4.0 or 4.1
@@ -23,7 +23,11 @@ static constexpr uint32_t DIGITAL_INPUT_2_MASK = DIGITAL_INPUT_MASK(DIGITAL_INPU
 static constexpr uint32_t DIGITAL_INPUT_3_MASK = DIGITAL_INPUT_MASK(DIGITAL_INPUT_3);
 static constexpr uint32_t DIGITAL_INPUT_4_MASK = DIGITAL_INPUT_MASK(DIGITAL_INPUT_4);
 
-#if defined(__MK20DX256__) // Teensy 3.2
+// Sub-tick timing: clock_phase() is how long before the CORE tick's Scan()
+// the edge arrived, in 1/256ths of a tick.
+static constexpr int kClockPhaseBits = 8;
+static constexpr uint32_t kClockPhaseMax = (1 << kClockPhaseBits) - 1;
+static constexpr uint32_t kCyclesPerTick = F_CPU / OC_CORE_ISR_FREQ;
 
 void tr1_ISR();
 void tr2_ISR();
@@ -52,6 +56,12 @@ public:
     return clocked_mask_ & (0x1 << input);
   }
 
+  // @return sub-tick age of the edge if pin clocked since last call, else 0
+  static inline uint8_t clock_phase(DigitalInput input) {
+    return clock_phase_[input];
+  }
+
+#if defined(__MK20DX256__) // Teensy 3.2
   template <DigitalInput input> static inline bool read_immediate() {
     return !digitalReadFast(InputPinMap(input));
   }
@@ -59,6 +69,26 @@ public:
   static inline bool read_immediate(DigitalInput input) {
     return !digitalReadFast(InputPinMap(input));
   }
+#elif defined(__IMXRT1062__) // Teensy 4.0 or 4.1
+  template <DigitalInput input> static inline bool read_immediate() {
+    return read_immediate(input);
+  }
+  static inline bool read_immediate(DigitalInput input) {
+#ifdef ARDUINO_TEENSY41
+    auto activated = (ADC33131D_Uses_FlexIO ? HIGH : LOW);
+#else
+    auto activated = LOW;
+#endif
+    switch (input) {
+      case DIGITAL_INPUT_1: return (digitalRead(TR1) == activated);
+      case DIGITAL_INPUT_2: return (digitalRead(TR2) == activated);
+      case DIGITAL_INPUT_3: return (digitalRead(TR3) == activated);
+      case DIGITAL_INPUT_4: return (digitalRead(TR4) == activated);
+      case DIGITAL_INPUT_LAST: break;
+    }
+    return false;
+  }
+#endif
 
 private:
   // clock() only called from interrupt functions
@@ -67,6 +97,9 @@ private:
   friend void tr3_ISR();
   friend void tr4_ISR();
   template <DigitalInput input> static inline void clock() {
+    // keep the first edge if there are several within a tick
+    if (!clocked_[input])
+      edge_cycles_[input] = ARM_DWT_CYCCNT;
     clocked_[input] = 1;
   }
 
@@ -85,63 +118,25 @@ private:
 
   static uint32_t clocked_mask_;
   static volatile uint32_t clocked_[DIGITAL_INPUT_LAST];
+  static volatile uint32_t edge_cycles_[DIGITAL_INPUT_LAST];
+  static uint8_t clock_phase_[DIGITAL_INPUT_LAST];
 
   template <DigitalInput input>
-  static uint32_t ScanInput() {
+  static uint32_t ScanInput(uint32_t now) {
     if (clocked_[input]) {
+      const uint32_t age = now - edge_cycles_[input];
       clocked_[input] = 0;
+      clock_phase_[input] = age < kCyclesPerTick
+        ? (age << kClockPhaseBits) / kCyclesPerTick
+        : kClockPhaseMax;
       return DIGITAL_INPUT_MASK(input);
     } else {
+      clock_phase_[input] = 0;
       return 0;
     }
   }
 };
 
-#elif defined(__IMXRT1062__) // Teensy 4.0 or 4.1
-
-class DigitalInputs {
-public:
-  static void Init();
-  static void reInit() { Init(); }
-  static void Scan();
-
-  // @return mask of all pins clocked since last Scan()
-  static inline uint32_t clocked() {
-    return clocked_mask_;
-  }
-  // @return mask if pin clocked since last Scan()
-  template <DigitalInput input> static inline uint32_t clocked() {
-    return clocked(input);
-  }
-  static inline uint32_t clocked(DigitalInput input) {
-    return clocked_mask_ & (0x1 << input);
-  }
-  template <DigitalInput input> static inline bool read_immediate() {
-    return read_immediate(input);
-  }
-  static inline bool read_immediate(DigitalInput input) {
-#ifdef ARDUINO_TEENSY41
-    auto activated = (ADC33131D_Uses_FlexIO ? HIGH : LOW);
-#else
-    auto activated = LOW;
-#endif
-    switch (input) {
-      case DIGITAL_INPUT_1: return (digitalRead(TR1) == activated);
-      case DIGITAL_INPUT_2: return (digitalRead(TR2) == activated);
-      case DIGITAL_INPUT_3: return (digitalRead(TR3) == activated);
-      case DIGITAL_INPUT_4: return (digitalRead(TR4) == activated);
-      case DIGITAL_INPUT_LAST: break;
-    }
-    return false;
-  }
-private:
-  static uint8_t clocked_mask_;
-  static IMXRT_GPIO_t *port[DIGITAL_INPUT_LAST];
-  static uint32_t bitmask[DIGITAL_INPUT_LAST];
-};
-
-#endif
-
 // Helper class for visualizing digital inputs with decay
 // Uses 4 bits for decay
 class DigitalInputDisplay {
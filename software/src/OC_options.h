@@ -51,6 +51,10 @@
 // #define DRUMMAP_GRIDS2
 // 16 presets in Hemisphere
 // #define MOAR_PRESETS
+/* --- T4.1 audio: run VCA/VCF/wavefolder as packed Q15 block kernels (AudioKernels.h) --- */
+// #define AUDIO_BLOCK_KERNELS
+/* --- ...using the packed stereo kernels rather than one channel at a time --- */
+// #define AUDIO_PACKED_KERNELS
 
 
 /* Flags for the full-width apps, these enable/disable them in OC_apps.ino but also zero out the app   */
@@ -31,6 +31,7 @@ public:
         return "AttenOff";
     }
     const uint8_t* applet_icon() { return PhzIcons::dualAttenuverter; }
+    ControlRate GetControlRate() { return CONTROL_RATE_SMOOTH; }
 
     void Start() {
         ForEachChannel(ch) level[ch] = ATTENOFF_MAX_LEVEL;
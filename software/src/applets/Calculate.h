@@ -34,6 +34,10 @@ public:
         return "Calculate";
     }
     const uint8_t* applet_icon() { return PhzIcons::calculate; }
+    ControlRate GetControlRate() {
+        // S&H and Rand follow clocks
+        return (operation[0] < 5 && operation[1] < 5) ? CONTROL_RATE_SMOOTH : CONTROL_RATE_FULL;
+    }
 
     void Start() {
         selected = 0;
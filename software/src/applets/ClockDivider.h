@@ -38,6 +38,7 @@ public:
         return "Clk Div";
     }
     const uint8_t* applet_icon() { return PhzIcons::clockDivider; }
+    bool LazyView() { return true; }
 
     void Start() {
       divmult[0].steps = 2;
@@ -56,7 +57,10 @@ public:
         {
           int div_m = div[ch];
           Modulate(div_m, ch, -CLOCKDIV_MAX, CLOCKDIV_MAX);
-          divmult[ch*2].steps = div_m;
+          if (divmult[ch*2].steps != div_m) {
+            divmult[ch*2].steps = div_m;
+            MarkDirty();
+          }
         }
 
         if (Clock(1)) Reset();
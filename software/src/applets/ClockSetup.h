@@ -59,12 +59,14 @@ public:
 
     // The ClockSetup controller handles MIDI Clock and Transport Start/Stop
     void Controller() {
-        bool clock_sync = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+        bool clock_sync = frame.clocked(0);
+        uint8_t clock_age = frame.clock_phase(0);
 
         // MIDI Clock is filtered to 2 PPQN
         if (frame.MIDIState.clock_q) {
             frame.MIDIState.clock_q = 0;
             clock_sync = 1;
+            clock_age = 0;
         }
         if (frame.MIDIState.start_q) {
             frame.MIDIState.start_q = 0;
@@ -83,7 +85,7 @@ public:
 
         // Advance internal clock, sync to external clock / reset
         if (clock_m.IsRunning())
-            clock_m.SyncTrig( clock_sync );
+            clock_m.SyncTrig( clock_sync, false, clock_age );
 
         // ------------ //
         if (clock_m.IsRunning() && clock_m.MIDITock()) {
@@ -66,12 +66,14 @@ public:
 
     // The ClockSetup controller handles MIDI Clock and Transport Start/Stop
     void Controller() {
-        bool clock_sync = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+        bool clock_sync = frame.clocked(0);
+        uint8_t clock_age = frame.clock_phase(0);
 
         // MIDI Clock is filtered to 2 PPQN
         if (frame.MIDIState.clock_q) {
             frame.MIDIState.clock_q = 0;
             clock_sync = 1;
+            clock_age = 0;
         }
         if (frame.MIDIState.start_q) {
             frame.MIDIState.start_q = 0;
@@ -91,15 +93,11 @@ public:
 
         // Advance internal clock, sync to external clock / reset
         if (HS::clock_m.IsRunning())
-            HS::clock_m.SyncTrig( clock_sync );
+            HS::clock_m.SyncTrig( clock_sync, false, clock_age );
 
         // ------------ //
         if (HS::clock_m.IsRunning() && HS::clock_m.MIDITock()) {
-          usbMIDI.sendRealTime(usbMIDI.Clock);
-          usbHostMIDI.sendRealTime(usbMIDI.Clock);
-#ifdef ARDUINO_TEENSY41
-          MIDI1.sendRealTime(midi::MidiType(usbMIDI.Clock));
-#endif
+          HS::SendMIDI(usbMIDI.Clock, 0, 0, 0);
         }
 
         // 8 internal clock flashers
@@ -27,6 +27,7 @@ public:
         return "Compare";
     }
     const uint8_t* applet_icon() { return PhzIcons::compare; }
+    ControlRate GetControlRate() { return CONTROL_RATE_HELD; }
 
     void Start() {
         level = 128;
@@ -46,17 +46,12 @@ public:
     }
 
     int determineInterval(int scale, int rootNote, int currentNote) {
-      // TODO: Teensy 3.2 chokes on all these floats when loaded on both sides!
-
+        // (v / 2 - 0.25) volts, in integer math; the doubles choked the T3.2
         int one_volt = HSAPPLICATION_5V / 5;
-        double maj_temp = (voltage_maj / 2.0 - 0.25) * one_volt;
-        int maj_out = static_cast<int>(maj_temp);
-        double min_temp = (voltage_min / 2.0 - 0.25) * one_volt;
-        int min_out = static_cast<int>(min_temp);
-        double dim_temp = (voltage_dim / 2.0 - 0.25) * one_volt;
-        int dim_out = static_cast<int>(dim_temp);
-        double no_match_temp = (voltage_no_match / 2.0 - 0.25) * one_volt;
-        int no_match_out = static_cast<int>(no_match_temp);
+        int maj_out = (2 * voltage_maj - 1) * one_volt / 4;
+        int min_out = (2 * voltage_min - 1) * one_volt / 4;
+        int dim_out = (2 * voltage_dim - 1) * one_volt / 4;
+        int no_match_out = (2 * voltage_no_match - 1) * one_volt / 4;
     // Calculate the number of semitones between root and current note
         int interval = (currentNote - rootNote + 12) % 12;
 
@@ -45,6 +45,7 @@ public:
         return "Logic";
     }
     const uint8_t* applet_icon() { return PhzIcons::logic; }
+    ControlRate GetControlRate() { return CONTROL_RATE_HELD; }
 
     void Start() {
         selected = 0;
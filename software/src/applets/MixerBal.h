@@ -27,6 +27,7 @@ public:
         return "Mixer:Bal";
     }
     const uint8_t* applet_icon() { return PhzIcons::mixerBal; }
+    ControlRate GetControlRate() { return CONTROL_RATE_SMOOTH; }
 
     void Start() {
         balance = 127;
@@ -80,14 +80,14 @@ public:
                     continue;
                 }
                 int randInt = random(0, 1000);
-                int randStep = (float)(random(1, constrain(step+stepCv, 0, MAX_STEP)))/MAX_STEP*maxVal/2;
-                int rangeScaled = (int)( ((float)constrain(range + rangeCv, 0, MAX_RANGE))/MAX_RANGE * maxVal);
+                int randStep = random(1, constrain(step+stepCv, 0, MAX_STEP)) * maxVal / (2 * MAX_STEP);
+                int rangeScaled = constrain(range + rangeCv, 0, MAX_RANGE) * maxVal / MAX_RANGE;
                 currentVal[ch] += randStep * (((randInt > PROB_UP) && (currentVal[ch] < rangeScaled)) -
                                               ((randInt < PROB_DN) && (currentVal[ch] > -rangeScaled)));
             }
-            currentOut[ch] = alpha*currentOut[ch] + (1-alpha)*(float)currentVal[ch];
+            currentOut[ch] = HS::Q16OnePole(currentOut[ch], currentVal[ch], alpha);
 
-            Out(ch, constrain((int)currentOut[ch], -HEMISPHERE_MAX_CV, HEMISPHERE_MAX_CV));
+            Out(ch, constrain(HS::q162int(currentOut[ch]), -HEMISPHERE_MAX_CV, HEMISPHERE_MAX_CV));
         }
     }
 
@@ -185,12 +185,12 @@ private:
     uint8_t smoothness = 20; // 8 bits
     uint8_t cvRange = 3; // 2 bit
     uint8_t clkMod = 0; //not stored, used for clock division
-    float alpha; // not stored, used for smoothing
+    HS::q16_t alpha; // not stored, used for smoothing
 
     // Runtime parameters
     // unsigned int rndSeed[2];
     int currentVal[2];
-    float currentOut[2];
+    HS::q16_t currentOut[2];
     int cursor; // 0=Y clk src, 1=Y clk div, 2=Range,  3=step, 4=Smoothnes
     
     void DrawDisplay() {
@@ -264,7 +264,7 @@ private:
         ForEachChannel(ch) {
             int w = 0;
             if (range > 0) {
-                w = (currentOut[ch]/((float)range/MAX_RANGE*maxVal))*31;
+                w = HS::q162int(currentOut[ch]) * 31 * MAX_RANGE / (range * maxVal);
                 if (w > 31) {
                     w = 31;
                 }
@@ -283,7 +283,8 @@ private:
 
     void UpdateAlpha() {
         // Use log mapping for better feeling
-        alpha = log(1+smoothness)/log(1+MAX_SMOOTH);
+        // log2(1 + MAX_SMOOTH) is 8
+        alpha = HS::Q16Log2(HS::int2q16(1 + smoothness)) / 8;
         // alpha = (float)smoothness/(float)MAX_SMOOTH;
     }
 };
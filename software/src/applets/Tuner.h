@@ -43,7 +43,8 @@
 #define TUNER_ENABLED (hemisphere == 1 - OC::calibration_data.flipcontrols())
 #endif
 
-static constexpr double HEM_TUNER_AaboveMidCtoC0 = 0.03716272234383494188492;
+// 0.03716272234383494188492, C0 relative to A4, in Q24
+static constexpr uint32_t HEM_TUNER_AaboveMidCtoC0_Q24 = 623487;
 
 class Tuner : public HemisphereApplet {
 public:
@@ -52,6 +53,7 @@ public:
         return "Tuner";
     }
     const uint8_t* applet_icon() { return PhzIcons::tuner; }
+    bool LazyView() { return true; }
 
     void Start() {
         A4_Hz = 440;
@@ -79,13 +81,16 @@ public:
             freq_count_ = freq_count_ + 1;
 
             if (milliseconds_since_last_freq_ > 750) {
-                frequency_ = freq_measure.countToFrequency(freq_sum_ / freq_count_);
+                // clock / (sum / count), in Q16 Hz
+                frequency_ = HS::Q16Ratio(uint64_t(freq_measure.timer_clock()) * freq_count_, freq_sum_);
+                MarkDirty();
                 freq_sum_ = 0;
                 freq_count_ = 0;
                 milliseconds_since_last_freq_ = 0;
             }
-        } else if (milliseconds_since_last_freq_ > 100000) {
-            frequency_ = 0.0f;
+        } else if (milliseconds_since_last_freq_ > 100000 && frequency_) {
+            frequency_ = 0;
+            MarkDirty();
         }
     }
 
@@ -144,24 +149,27 @@ protected:
 
 private:
     // Port from References
-    double freq_sum_;
+    uint64_t freq_sum_;
     uint32_t freq_count_;
-    float frequency_ ;
+    uint32_t frequency_; // Q16 Hz
     elapsedMillis milliseconds_since_last_freq_;
     int A4_Hz; // Tuning reference
     FreqMeasureClass freq_measure;
 
     void DrawTuner() {
-        float frequency_ = get_frequency() ;
-        float c0_freq_ = get_C0_freq() ;
+        const uint32_t frequency_ = get_frequency();
 
-        int32_t deviation = round(12000.0 * log2f(frequency_ / c0_freq_)) + 500;
+        int32_t deviation = 500;
+        if (frequency_) {
+            const int64_t octaves = int64_t(HS::Q16Log2(frequency_)) - HS::Q16Log2(get_C0_freq());
+            deviation += (octaves * 12000 + (HS::Q16_ONE >> 1)) >> HS::Q16_BITS;
+        }
         int8_t octave = deviation / 12000;
         int8_t note = (deviation - (octave * 12000)) / 1000;
         note = constrain(note, 0, 12);
         int32_t residual = ((deviation - ((octave - 1) * 12000)) % 1000) - 500;
 
-        if (frequency_ > 0.0) {
+        if (frequency_ > 0) {
             gfxPrint(20, 30, OC::Strings::note_names[note]);
             gfxPrint(" ");
             gfxPrint(octave);
@@ -194,9 +202,8 @@ private:
             }
 
             // Draw frequency
-            const int f = int(floor(frequency_ * 100));
-            const int value = f / 100;
-            const int cents = f % 100;
+            const int value = frequency_ >> HS::Q16_BITS;
+            const int cents = ((frequency_ & 0xffff) * 100) >> HS::Q16_BITS;
             gfxPrint(6 + pad(10000, value), 54, value);
             gfxPrint(".");
             if (cents < 10) gfxPrint("0");
@@ -227,9 +234,10 @@ private:
       }
     }
 
-    float get_frequency() {return frequency_;}
+    // Q16 Hz
+    uint32_t get_frequency() {return frequency_;}
     
-    float get_C0_freq() {
-        return(static_cast<float>(A4_Hz * HEM_TUNER_AaboveMidCtoC0));
+    uint32_t get_C0_freq() {
+        return (A4_Hz * HEM_TUNER_AaboveMidCtoC0_Q24) >> 8;
     }
 };
@@ -27,6 +27,7 @@ public:
         return "Voltage";
     }
     const uint8_t* applet_icon() { return PhzIcons::voltage; }
+    bool LazyView() { return true; }
 
     void Start() {
         voltage[0] = (5 * (12 << 7)) / VOLTAGE_INCREMENTS; // 5V
@@ -46,7 +47,10 @@ public:
                 if (Gate(ch)) cv = 0;
                 else cv = voltage[ch] * VOLTAGE_INCREMENTS;
             }
-            view[ch] = cv ? 1 : 0;
+            if (view[ch] != (cv != 0)) {
+                view[ch] = (cv != 0);
+                MarkDirty();
+            }
             Out(ch, cv);
         }
     }
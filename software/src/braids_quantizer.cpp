@@ -71,22 +71,28 @@ int32_t Quantizer::Process(int32_t pitch, int32_t root, int32_t transpose) {
     int16_t octave = pitch / span_ - (pitch < 0 ? 1 : 0);
     int16_t rel_pitch = pitch - span_ * octave;
 
-    int16_t best_distance = 16384;
-    int16_t q = -1;
-    for (int16_t i = 0; i < num_notes_; i++) {
-      int16_t distance = abs(rel_pitch - notes_[i]);
-      if (distance < best_distance) {
-        best_distance = distance;
-        q = i;
+    int16_t q;
+    const int32_t table_pitch = pitch - span_ * octave;
+    if (lookup_table_ && lookup_table_->valid() && table_pitch >= 0 && table_pitch <= span_) {
+      q = lookup_table_->Lookup(table_pitch, octave);
+    } else {
+      int16_t best_distance = 16384;
+      q = -1;
+      for (int16_t i = 0; i < num_notes_; i++) {
+        int16_t distance = abs(rel_pitch - notes_[i]);
+        if (distance < best_distance) {
+          best_distance = distance;
+          q = i;
+        }
       }
-    }
 
-    if (abs(pitch - (octave + 1) * span_ - notes_[0]) < best_distance) {
-      octave++;
-      q = 0;
-    } else if (abs(pitch - (octave - 1) * span_ - notes_[num_notes_ - 1]) <= best_distance) {
-      octave--;
-      q = num_notes_ - 1;
+      if (abs(pitch - (octave + 1) * span_ - notes_[0]) < best_distance) {
+        octave++;
+        q = 0;
+      } else if (abs(pitch - (octave - 1) * span_ - notes_[num_notes_ - 1]) <= best_distance) {
+        octave--;
+        q = num_notes_ - 1;
+      }
     }
 
     // set boundaries for hysteresis
@@ -128,6 +134,70 @@ int32_t Quantizer::Process(int32_t pitch, int32_t root, int32_t transpose) {
   return pitch;
 }
 
+// For sorted, distinct notes the search in Process picks the nearest of
+// notes_[n-1] - span, notes_[0..n-1], notes_[0] + span, with ties going to the
+// lower one. So the result steps from one candidate to the next at
+// floor(midpoint) + 1. The buckets point at the step active at their first
+// pitch, which only works if no bucket contains more than one step.
+void Quantizer::BuildLookupTable(QuantizerLookupTable &table) const {
+  table.valid_ = false;
+
+  if (!enabled_ || span_ <= 0 || span_ >= 16384)
+    return;
+  for (int i = 0; i < num_notes_; ++i) {
+    if (notes_[i] < 0 || notes_[i] >= span_) return;
+    if (i && notes_[i] <= notes_[i - 1]) return;
+  }
+
+  table.shift_ = 0;
+  while ((span_ >> table.shift_) >= QuantizerLookupTable::kNumBuckets)
+    ++table.shift_;
+
+  // Candidates in ascending order
+  const int num_candidates = num_notes_ + 2;
+  auto candidate = [&](int k) -> int32_t {
+    if (k == 0) return notes_[num_notes_ - 1] - span_;
+    if (k == num_candidates - 1) return notes_[0] + span_;
+    return notes_[k - 1];
+  };
+
+  table.num_segments_ = 0;
+  for (int k = 0; k < num_candidates; ++k) {
+    int32_t start = k ? ((candidate(k - 1) + candidate(k)) >> 1) + 1 : 0;
+    if (start > span_) break;
+    if (start < 0) start = 0;
+    // a later candidate might already cover 0
+    if (table.num_segments_ && start == table.segment_start_[table.num_segments_ - 1])
+      --table.num_segments_;
+
+    const int s = table.num_segments_++;
+    table.segment_start_[s] = start;
+    if (k == 0) {
+      table.segment_note_[s] = num_notes_ - 1;
+      table.segment_octave_[s] = -1;
+    } else if (k == num_candidates - 1) {
+      table.segment_note_[s] = 0;
+      table.segment_octave_[s] = 1;
+    } else {
+      table.segment_note_[s] = k - 1;
+      table.segment_octave_[s] = 0;
+    }
+  }
+  table.segment_start_[table.num_segments_] = INT16_MAX;
+
+  int s = 0;
+  const int32_t num_buckets = (span_ >> table.shift_) + 1;
+  for (int32_t b = 0; b < num_buckets; ++b) {
+    const int32_t first = b << table.shift_;
+    const int32_t last = first + (1 << table.shift_) - 1;
+    while (table.segment_start_[s + 1] <= first) ++s;
+    if (s + 1 < table.num_segments_ && table.segment_start_[s + 2] <= last)
+      return;
+    table.buckets_[b] = s;
+  }
+  table.valid_ = true;
+}
+
 int32_t Quantizer::Lookup(int32_t index) const {
   index -= 64;
   int16_t octave = index / num_notes_;
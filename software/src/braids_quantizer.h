@@ -40,11 +40,48 @@ namespace braids {
 
 struct Scale {
   int16_t span;
-  size_t num_notes;
+  uint32_t num_notes;
   int16_t notes[16];
 };
 
 void SortScale(Scale &);
+
+// Optional lookup table for Quantizer::Process. For a scale with sorted,
+// distinct notes the nearest codeword is a step function of the pitch within
+// the octave; the table stores the steps and a coarse index into them, so a
+// requantize is one table read and one compare instead of a search over all
+// notes. Scales that don't fit fall back to the search.
+class QuantizerLookupTable {
+ public:
+  static constexpr int kNumBuckets = 64;
+  static constexpr int kMaxSegments = 16 + 2; // notes + octave wrap above/below
+
+  QuantizerLookupTable() : valid_(false) {}
+
+  bool valid() const {
+    return valid_;
+  }
+
+  // Valid for 0 <= rel_pitch <= span
+  inline int16_t Lookup(int32_t rel_pitch, int16_t &octave) const {
+    uint8_t s = buckets_[rel_pitch >> shift_];
+    if (rel_pitch >= segment_start_[s + 1]) ++s;
+    octave += segment_octave_[s];
+    return segment_note_[s];
+  }
+
+ private:
+  friend class Quantizer;
+
+  bool valid_;
+  uint8_t shift_;
+  uint8_t num_segments_;
+  uint8_t buckets_[kNumBuckets];
+  int16_t segment_start_[kMaxSegments + 1];
+  uint8_t segment_note_[kMaxSegments];
+  int8_t segment_octave_[kMaxSegments];
+};
+
 class Quantizer {
  public:
   Quantizer() {}
@@ -66,6 +103,43 @@ class Quantizer {
     }
     span_ = scale.span;
     enabled_ = notes_ != NULL && num_notes_ != 0 && span_ != 0;
+    // A shared table belongs to the old configuration
+    if (owned_table_) BuildLookupTable(*owned_table_);
+    lookup_table_ = owned_table_;
+  }
+
+  // Use the given table for requantizing; it's rebuilt on each Configure so
+  // best suited to quantizers that aren't reconfigured every tick.
+  // nullptr reverts to searching the notes.
+  void EnableLookupTable(QuantizerLookupTable *table) {
+    owned_table_ = table;
+    if (owned_table_) BuildLookupTable(*owned_table_);
+    lookup_table_ = owned_table_;
+    requantize_ = true;
+  }
+
+  // Use a table built elsewhere for the same configuration (see
+  // QuantizerBank). It isn't touched here, and the next Configure drops it.
+  // Results don't change, so the current note is kept.
+  void ShareLookupTable(const QuantizerLookupTable *table) {
+    owned_table_ = nullptr;
+    lookup_table_ = table;
+  }
+
+  const QuantizerLookupTable *lookup_table() const {
+    return lookup_table_;
+  }
+
+  // Build a table for the current configuration, e.g. for ShareLookupTable
+  void BuildLookupTable(QuantizerLookupTable &table) const;
+
+  // Same notes and span, i.e. Process gives the same results
+  bool SameConfig(const Quantizer &other) const {
+    if (enabled_ != other.enabled_ || span_ != other.span_ || num_notes_ != other.num_notes_)
+      return false;
+    for (int i = 0; i < num_notes_; ++i)
+      if (notes_[i] != other.notes_[i]) return false;
+    return true;
   }
 
   bool enabled() const {
@@ -91,9 +165,125 @@ class Quantizer {
   uint16_t note_number_;
   bool requantize_;
 
+  QuantizerLookupTable *owned_table_ = nullptr;
+  const QuantizerLookupTable *lookup_table_ = nullptr;
+
   DISALLOW_COPY_AND_ASSIGN(Quantizer);
 };
 
+// Lookup tables for a set of quantizers, shared between channels with the
+// same configuration.
+//
+// Patches usually run several channels on the same scale and mask, so one
+// table per distinct configuration is enough; num_tables can be less than
+// num_channels, and channels beyond that fall back to searching the notes.
+// A table is only built when the configuration isn't already in use on
+// another channel, and a table that's shared is never rebuilt.
+//
+// Configure can be called from anywhere, including the ISR: it only changes
+// the quantizer, which searches the notes until Poll (loop() only) shares or
+// builds a table for it. So tables are claimed and built in one place, with
+// the ISR running; Lock (an RAII type) only holds it off while a channel's
+// configuration changes or a table is attached.
+//
+// The quantizers stay separate, since each has its own hysteresis state;
+// Configure on a quantizer directly detaches it from its shared table.
+struct NoQuantizerBankLock { NoQuantizerBankLock() { } };
+
+template <int num_channels, int num_tables, typename Lock = NoQuantizerBankLock>
+class QuantizerBank {
+ public:
+  static_assert(num_channels <= 32, "pending channels are a 32-bit mask");
+
+  explicit QuantizerBank(Quantizer *quantizers) : quantizers_(quantizers) {}
+
+  void Configure(int ch, const Scale &scale, uint16_t mask = 0xffff) {
+    Lock lock;
+    quantizers_[ch].Configure(scale, mask);
+    quantizers_[ch].Requantize();
+    ++generation_[ch];
+    pending_ |= 1u << ch;
+  }
+
+  // From loop() only: find tables for the channels configured since the last
+  // call
+  void Poll() {
+    uint32_t pending;
+    {
+      Lock lock;
+      pending = pending_;
+      pending_ = 0;
+    }
+    for (int ch = 0; pending; ++ch, pending >>= 1) {
+      if (pending & 1) Attach(ch);
+    }
+  }
+
+  // Quantize the channels set in channels; arrays are indexed by channel
+  void Process(uint32_t channels, const int32_t *pitch, const int32_t *root,
+               const int32_t *transpose, int32_t *out) {
+    for (int ch = 0; channels && ch < num_channels; ++ch, channels >>= 1) {
+      if (channels & 1)
+        out[ch] = quantizers_[ch].Process(pitch[ch], root[ch], transpose[ch]);
+    }
+  }
+
+  // Index of the table channel ch is using, or -1 if it isn't
+  int table_index(int ch) const {
+    const QuantizerLookupTable *table = quantizers_[ch].lookup_table();
+    for (int t = 0; t < num_tables; ++t)
+      if (table == &tables_[t]) return t;
+    return -1;
+  }
+
+  int tables_in_use() const {
+    int count = 0;
+    for (int t = 0; t < num_tables; ++t)
+      if (in_use(t)) ++count;
+    return count;
+  }
+
+ private:
+  Quantizer *quantizers_;
+  QuantizerLookupTable tables_[num_tables];
+  volatile uint32_t pending_ = 0;
+  uint8_t generation_[num_channels] = { 0 }; // Configure calls, to spot one during a build
+
+  bool in_use(int t) const {
+    for (int i = 0; i < num_channels; ++i)
+      if (table_index(i) == t) return true;
+    return false;
+  }
+
+  void Attach(int ch) {
+    Quantizer &quantizer = quantizers_[ch];
+    uint8_t generation;
+    {
+      // Comparing is quick; the configurations mustn't change meanwhile
+      Lock lock;
+      if (!quantizer.enabled() || table_index(ch) >= 0) return;
+      for (int i = 0; i < num_channels; ++i) {
+        if (i != ch && table_index(i) >= 0 && quantizer.SameConfig(quantizers_[i])) {
+          quantizer.ShareLookupTable(quantizers_[i].lookup_table());
+          return;
+        }
+      }
+      generation = generation_[ch];
+    }
+
+    // Only this claims tables and Configure only frees them, so a free one
+    // stays free while it's built
+    for (int t = 0; t < num_tables; ++t) {
+      if (in_use(t)) continue;
+      quantizer.BuildLookupTable(tables_[t]);
+      Lock lock;
+      // Otherwise it was configured again during the build, and is pending
+      if (generation_[ch] == generation) quantizer.ShareLookupTable(&tables_[t]);
+      return;
+    }
+  }
+};
+
 }  // namespace braids
 
 #endif
@@ -37,7 +37,7 @@ static inline int32_t signed_saturate_rshift(int32_t val, int bits, int rshift)
 	int32_t out;
 	asm volatile("ssat %0, %1, %2, asr %3" : "=r" (out) : "I" (bits), "r" (val), "I" (rshift));
 	return out;
-#elif defined(KINETISL)
+#else
 	int32_t out, max;
 	out = val >> rshift;
 	max = 1 << (bits - 1);
@@ -75,7 +75,7 @@ static inline int32_t signed_multiply_32x16b(int32_t a, uint32_t b)
 	int32_t out;
 	asm volatile("smulwb %0, %1, %2" : "=r" (out) : "r" (a), "r" (b));
 	return out;
-#elif defined(KINETISL)
+#else
 	return ((int64_t)a * (int16_t)(b & 0xFFFF)) >> 16;
 #endif
 }
@@ -114,8 +114,8 @@ static inline uint32_t multiply_u32xu32_rshift32(uint32_t a, uint32_t b)
   uint32_t out, tmp;
   asm volatile("umull %0, %1, %2, %3" : "=r" (tmp), "=r" (out) : "r" (a), "r" (b));
   return out;
-#elif defined(KINETISL)
-  return 0; // TODO....
+#else
+  return ((uint64_t)a * b) >> 32;
 #endif
 }
 
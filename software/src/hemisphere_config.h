@@ -13,6 +13,9 @@
 // * Category filtering is deprecated at 1.8, but I'm leaving the per-applet categorization
 // alone to avoid breaking forked codebases by other developers.
 
+#include <algorithm>
+#include <new>
+
 #include "applets/ADSREG.h"
 #include "applets/ADEG.h"
 #include "applets/ASR.h"
@@ -100,27 +103,35 @@ struct DeclareApplet {
 };
 
 template <class... AppletClasses> struct AppletRegistry {
-  // Must be static or template specialization stick around. Must be inline or
-  // you get linker errors.
-  inline static std::tuple<AppletClasses...> pool[APPLET_SLOTS];
+  // Each slot holds one applet at a time, constructed in place when the slot
+  // switches applets, so the arena only needs to fit the largest one.
+  static constexpr size_t arena_size = std::max({sizeof(AppletClasses)...});
+  struct alignas(AppletClasses...) Arena {
+    uint8_t bytes[arena_size];
+  };
+  // Must be inline or you get linker errors.
+  inline static Arena arena[APPLET_SLOTS];
+  // What the applets would take as static instances in every slot
+  static constexpr size_t pool_size = (sizeof(AppletClasses) + ...) * APPLET_SLOTS;
+
   std::array<Applet, sizeof...(AppletClasses)> applets;
 
   // Constructor *must* be constexpr or all the template specializations will
   // cause code and memory size to increase
   constexpr AppletRegistry(DeclareApplet<AppletClasses>... applets)
       : applets{Applet{applets.id, applets.categories,
-                       PtrArray<AppletClasses, APPLET_SLOTS>()}...} {}
+                       &Construct<AppletClasses>, &Destroy<AppletClasses>}...} {}
 
 private:
-  template <class C, size_t N, size_t... Is>
-  static constexpr std::array<HemisphereApplet *, sizeof...(Is)>
-  PtrArray(std::index_sequence<Is...>) {
-    return std::array<HemisphereApplet *, sizeof...(Is)>{&std::get<C>(pool[Is])...};
+  // Value-initialized, i.e. zeroed first, like the static instances were
+  template <class C>
+  static HemisphereApplet *Construct(void *storage) {
+    return new (storage) C();
   }
 
-  template <class C, size_t N>
-  static constexpr std::array<HemisphereApplet *, N> PtrArray() {
-    return PtrArray<C, N>(std::make_index_sequence<N>());
+  template <class C>
+  static void Destroy(HemisphereApplet *applet) {
+    static_cast<C *>(applet)->~C();
   }
 };
 
@@ -205,6 +216,82 @@ namespace HS {
   static constexpr auto & available_applets = reg.applets;
   static constexpr int HEMISPHERE_AVAILABLE_APPLETS = ARRAY_SIZE(available_applets);
 
+  // The applet in each slot, and the settings of the ones that were there
+  // before, so switching back finds them as they were
+  struct AppletSlot {
+    HemisphereApplet *applet; // nullptr until the first StartApplet()
+    int index; // in available_applets
+    uint64_t data[HEMISPHERE_AVAILABLE_APPLETS];
+    uint64_t has_data[(HEMISPHERE_AVAILABLE_APPLETS + 63) / 64];
+  };
+  AppletSlot applet_slots[APPLET_SLOTS];
+
+  // Names and icons, which only an applet can tell, kept from a look at
+  // each one at startup
+  struct AppletInfo {
+    const char *name;
+    const uint8_t *icon;
+  };
+  AppletInfo applet_info[HEMISPHERE_AVAILABLE_APPLETS];
+  bool applet_info_loaded = false;
+
+  void LoadAppletInfo() {
+    for (int i = 0; i < HEMISPHERE_AVAILABLE_APPLETS; ++i) {
+      HemisphereApplet *applet = available_applets[i].construct(&reg.arena[0]);
+      applet_info[i] = { applet->applet_name(), applet->applet_icon() };
+      available_applets[i].destroy(applet);
+    }
+    applet_info_loaded = true;
+  }
+
+  const char *applet_name(int index) {
+    if (!applet_info_loaded) LoadAppletInfo();
+    return applet_info[index].name;
+  }
+  const uint8_t *applet_icon(int index) {
+    if (!applet_info_loaded) LoadAppletInfo();
+    return applet_info[index].icon;
+  }
+
+  HemisphereApplet *applet_in(int slot) {
+    return applet_slots[slot].applet;
+  }
+
+  /* Puts the applet at index into slot and starts it. The one that was there
+   * is unloaded, its settings kept (OnDataRequest) and destroyed; a new one
+   * gets the settings it had last time (OnDataReceive), if any. Same index:
+   * only unload and start again, as before.
+   *
+   * Called from loop() only; the app ISR is held off while the slot changes
+   * hands, and View() and UI events can't be running either.
+   */
+  HemisphereApplet *StartApplet(HEM_SIDE slot_id, int index) {
+    if (!applet_info_loaded) LoadAppletInfo();
+    AppletSlot &slot = applet_slots[slot_id];
+
+    const bool isr_enabled = OC::CORE::app_isr_enabled;
+    OC::CORE::app_isr_enabled = false;
+    if (slot.applet) slot.applet->Unload();
+
+    if (!slot.applet || slot.index != index) {
+      if (slot.applet) {
+        slot.data[slot.index] = slot.applet->OnDataRequest();
+        slot.has_data[slot.index / 64] |= uint64_t(1) << (slot.index % 64);
+        available_applets[slot.index].destroy(slot.applet);
+      }
+      slot.applet = available_applets[index].construct(&reg.arena[slot_id]);
+      slot.index = index;
+      slot.applet->BaseStart(slot_id);
+      if ((slot.has_data[index / 64] >> (index % 64)) & 1)
+        slot.applet->OnDataReceive(slot.data[index]);
+    } else {
+      slot.applet->BaseStart(slot_id);
+    }
+
+    OC::CORE::app_isr_enabled = isr_enabled;
+    return slot.applet;
+  }
+
   // TODO: figure out where to store this
   uint64_t hidden_applets[2] = { 0, 0 };
   bool applet_is_hidden(const int& index) {
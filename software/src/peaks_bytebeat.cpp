@@ -56,44 +56,35 @@ void ByteBeat::Init() {
   p2_ = 127;
   stepmode_ = false ;
   last_sample_ = 13 ;
-
+  equation_index_ = 0 ;
+  process_ = kProcessors[0];
+  render_ = kRenderers[0];
 }
 
-uint16_t ByteBeat::ProcessSingleSample(uint8_t control) {
+// Several equations divide by parameters or by t_, which can be 0. The
+// Cortex-M divide instructions return 0 then (and % leaves the dividend),
+// so these make that explicit instead of leaving it to the hardware.
+template <typename A, typename B>
+static inline auto Div(A a, B b) -> decltype(a / b) {
+  return b ? a / b : 0;
+}
 
-  uint16_t sample = 0;
-   
-  if (control & CONTROL_GATE_RISING) {
-    if (stepmode_) {
-      ++t_ ;
-    } else {
-      phase_ = 0;
-      if (loopmode_) {
-        t_ = loop_start_ ;
-      } else {
-        t_ = 0 ;
-      }
-    }
-  }
+template <typename A, typename B>
+static inline auto Mod(A a, B b) -> decltype(a % b) {
+  return b ? a % b : a;
+}
 
-  if (!stepmode_) {
-    ++phase_ ; 
-  }    
-  
-  if (loopmode_ && (t_ < loop_start_ || t_ > loop_end_)) {
-     t_ = loop_start_ ;
-     phase_ = 0 ;
-  }
+// One equation; the switch folds away in each instantiation
+template <int equation>
+static inline uint16_t Equation(uint32_t t_, uint16_t last_sample_, uint16_t pitch_,
+                                uint8_t p0, uint8_t p1, uint8_t p2) {
 
-  if (!stepmode_ && (phase_ % bytepitch_ == 0)) ++t_; 
+  uint16_t sample = 0;
 // These equations push the boundaries of precedence comprehension.
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wparentheses"
   uint8_t pitch = pitch_ ;
-  uint8_t p0 = p0_ ;
-  uint8_t p1 = p1_ ;
-  uint8_t p2 = p2_ ;
-    switch (equation_index_) {
+    switch (equation) {
         case 0: // hope - pitch OK
           // from http://royal-paw.com/2012/01/bytebeats-in-c-and-python-generative-symphonies-from-extremely-small-programs/
           // (atmospheric, hopeful)
@@ -107,11 +98,11 @@ uint16_t ByteBeat::ProcessSingleSample(uint8_t control) {
           break;
         case 2: // life - pitch OK
           // This one is the second one listed at from http://xifeng.weebly.com/bytebeats.html
-          sample = ((( ((((((t_*pitch) >> p0) | (t_*pitch)) | ((t_*pitch) >> p0)) * p2) & ((5 * (t_*pitch)) | ((t_*pitch) >> p2)) ) | ((t_*pitch) ^ (t_ % p1)) ) & 0xFF));
+          sample = ((( ((((((t_*pitch) >> p0) | (t_*pitch)) | ((t_*pitch) >> p0)) * p2) & ((5 * (t_*pitch)) | ((t_*pitch) >> p2)) ) | ((t_*pitch) ^ Mod(t_, p1)) ) & 0xFF));
           break;
        case 3:// age - pitch disabled
           // Arp rotator (equation 9 from Equation Composer Ptah bank)
-          sample = (((t_)>>(p2>>4))&((t_)<<3)/((t_)*p1*((t_)>>11)%(3+(((t_)>>(16-(p0>>4)))%22))));
+          sample = (((t_)>>(p2>>4))&Div(((t_)<<3),((t_)*p1*((t_)>>11)%(3+(((t_)>>(16-(p0>>4)))%22)))));
           break ;
         case 4: // clysm - pitch almost no effect
           //  BitWiz Transplant via Equation Composer Ptah bank 
@@ -119,11 +110,11 @@ uint16_t ByteBeat::ProcessSingleSample(uint8_t control) {
           break ;
         case 5: // monk - pitch OK
           // Vocaliser from Equation Composer Khepri bank         
-          sample = (((t_*pitch)%p0>>2)&p1)*(t_>>(p2>>5));
+          sample = ((Mod((t_*pitch),p0)>>2)&p1)*(t_>>(p2>>5));
           break;
         case 6: // NERV - horrible!
           // Chewie from Equation Composer Khepri bank         
-          sample = (p0-(((p2+1)/(t_*pitch))^p0|(t_*pitch)^922+p0))*(p2+1)/p0*(((t_*pitch)+p1)>>p1%19);
+          sample = Div((p0-((Div((p2+1),(t_*pitch)))^p0|(t_*pitch)^922+p0))*(p2+1),p0)*(((t_*pitch)+p1)>>p1%19);
           break;
         case 7: // Trurl - pitch OK
           // Tinbot from Equation Composer Sobek bank   
@@ -131,21 +122,21 @@ uint16_t ByteBeat::ProcessSingleSample(uint8_t control) {
           break;
         case 8: // Pirx  - pitch OK
           // My Loud Friend from Equation Composer Ptah bank   
-          sample = ((((t_*pitch)>>((p0>>12)%12))%(t_>>((p1%12)+1))-(t_>>((t_>>(p2%10))%12)))/((t_>>((p0>>2)%15))%15))<<4;
+          sample = (Div((Mod(((t_*pitch)>>((p0>>12)%12)),(t_>>((p1%12)+1)))-(t_>>((t_>>(p2%10))%12))),((t_>>((p0>>2)%15))%15)))<<4;
           break;
         case 9: //Snaut
           // GGT2 from Equation Composer Ptah bank
           // sample = ((p0|(t_>>(t_>>13)%14))*((t_>>(p0%12))-p1&249))>>((t_>>13)%6)>>((p2>>4)%12);
           // "A bit high-frequency, but keeper anyhow" from Equation Composer Khepri bank.
-          sample = ((t_*pitch)+last_sample_+p1/p0)%(p0|(t_*pitch)+p2);
+          sample = Mod(((t_*pitch)+last_sample_+Div(p1,p0)),(p0|(t_*pitch)+p2));
            break;
         case 10: // Hari
           // The Signs, from Equation Composer Ptah bank
-          sample = ((0&(251&((t_*pitch)/(100+p0))))|((last_sample_/(t_*pitch)|((t_*pitch)/(100*(p1+1))))*((t_*pitch)|p2)));
+          sample = ((0&(251&((t_*pitch)/(100+p0))))|((Div(last_sample_,(t_*pitch))|((t_*pitch)/(100*(p1+1))))*((t_*pitch)|p2)));
           break;
         case 11: // Kris - pitch OK
          // Light Reactor from Equation Composer Ptah bank
-          sample = (((t_*pitch)>>3)*(p0-643|(325%t_|p1)&t_)-((t_>>6)*35/p2%t_))>>6;
+          sample = (((t_*pitch)>>3)*(p0-643|(Mod(325,t_)|p1)&t_)-Mod(Div((t_>>6)*35,p2),t_))>>6;
           break;
         case 12: // Tichy
           sample = (t_*pitch_)>>7 & t_>>7 | t_>>8;
@@ -154,23 +145,67 @@ uint16_t ByteBeat::ProcessSingleSample(uint8_t control) {
           break;
         case 13: // Bregg - pitch OK
           // Hooks, from Equation Composer Khepri bank.
-          sample = ((t_*pitch)&(p0+2))-(t_/p1)/last_sample_/p2;
+          sample = ((t_*pitch)&(p0+2))-Div(Div(Div(t_,p1),last_sample_),p2);
           break;            
         case 14: // Avon - pitch OK
           // Widerange from Equation Composer Khepri bank
-          sample = (((p0^((t_*pitch)>>(p1>>3)))-(t_>>(p2>>2))-t_%(t_&p1)));
+          sample = (((p0^((t_*pitch)>>(p1>>3)))-(t_>>(p2>>2))-Mod(t_,(t_&p1))));
           break;        
         case 15: // Orac
           // Abducted, from Equation Composer Ptah bank
-          sample = (p0+(t_*pitch)>>p1%12)|((last_sample_%(p0+(t_*pitch)>>p0%4))+11+p2^t_)>>(p2>>12);
+          sample = (p0+(t_*pitch)>>p1%12)|((Mod(last_sample_,(p0+(t_*pitch)>>p0%4)))+11+p2^t_)>>(p2>>12);
           break;
         default:
           sample = 0 ;
           break;          
   }
 #pragma GCC diagnostic pop
-  last_sample_ = sample ;
-  return sample << 8 ;
+  return sample;
+}
+
+template <int equation>
+uint16_t ByteBeat::ProcessEquation(uint8_t control) {
+  uint32_t t = t_;
+  uint32_t phase = phase_;
+  Step(t, phase, control);
+  t_ = t;
+  phase_ = phase;
+  last_sample_ = Equation<equation>(t, last_sample_, pitch_, p0_, p1_, p2_);
+  return last_sample_ << 8;
+}
+
+template <int equation>
+void ByteBeat::RenderEquation(uint8_t control, uint16_t *out, size_t size) {
+  uint32_t t = t_;
+  uint32_t phase = phase_;
+  uint16_t sample = last_sample_;
+  for (size_t i = 0; i < size; ++i) {
+    Step(t, phase, control);
+    control = 0;
+    sample = Equation<equation>(t, sample, pitch_, p0_, p1_, p2_);
+    out[i] = sample << 8;
+  }
+  t_ = t;
+  phase_ = phase;
+  last_sample_ = sample;
+}
+
+const ByteBeat::Processor ByteBeat::kProcessors[16] = {
+  &ByteBeat::ProcessEquation<0>, &ByteBeat::ProcessEquation<1>, &ByteBeat::ProcessEquation<2>, &ByteBeat::ProcessEquation<3>,
+  &ByteBeat::ProcessEquation<4>, &ByteBeat::ProcessEquation<5>, &ByteBeat::ProcessEquation<6>, &ByteBeat::ProcessEquation<7>,
+  &ByteBeat::ProcessEquation<8>, &ByteBeat::ProcessEquation<9>, &ByteBeat::ProcessEquation<10>, &ByteBeat::ProcessEquation<11>,
+  &ByteBeat::ProcessEquation<12>, &ByteBeat::ProcessEquation<13>, &ByteBeat::ProcessEquation<14>, &ByteBeat::ProcessEquation<15>,
+};
+
+const ByteBeat::Renderer ByteBeat::kRenderers[16] = {
+  &ByteBeat::RenderEquation<0>, &ByteBeat::RenderEquation<1>, &ByteBeat::RenderEquation<2>, &ByteBeat::RenderEquation<3>,
+  &ByteBeat::RenderEquation<4>, &ByteBeat::RenderEquation<5>, &ByteBeat::RenderEquation<6>, &ByteBeat::RenderEquation<7>,
+  &ByteBeat::RenderEquation<8>, &ByteBeat::RenderEquation<9>, &ByteBeat::RenderEquation<10>, &ByteBeat::RenderEquation<11>,
+  &ByteBeat::RenderEquation<12>, &ByteBeat::RenderEquation<13>, &ByteBeat::RenderEquation<14>, &ByteBeat::RenderEquation<15>,
+};
+
+void ByteBeat::Render(uint16_t *out, size_t size) {
+  (this->*render_)(0, out, size);
 }
 
 // wrapper for use in QQ (Quantermain)
@@ -34,6 +34,7 @@
 
 // #include "peaks/drums/svf.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include "util/util_macros.h"
 
@@ -49,7 +50,11 @@ class ByteBeat {
   ~ByteBeat() { }
   
   void Init();
-  uint16_t ProcessSingleSample(uint8_t control);
+  inline uint16_t ProcessSingleSample(uint8_t control) {
+    return (this->*process_)(control);
+  }
+  // size samples ahead at the current settings, with no gate events
+  void Render(uint16_t *out, size_t size);
   uint16_t Clock();
  
   void Configure(int32_t* parameter, bool stepmode, bool loopmode) {
@@ -74,7 +79,13 @@ class ByteBeat {
 
    inline void set_equation(int32_t equation) {
     equation_ = equation ;
-    equation_index_ = equation_ >> 12 ;
+    // Configure() runs every tick, the equation rarely changes
+    const uint16_t index = equation_ >> 12 ;
+    if (index != equation_index_) {
+      equation_index_ = index ;
+      process_ = kProcessors[index & 0xf];
+      render_ = kRenderers[index & 0xf];
+    }
   }
 
    inline void set_step_mode(bool stepmode) {
@@ -146,6 +157,46 @@ class ByteBeat {
   }
   
  private:
+  // The equation is picked once when it changes, not for every sample:
+  // ProcessSingleSample() goes through process_, Render() through render_
+  typedef uint16_t (ByteBeat::*Processor)(uint8_t control);
+  typedef void (ByteBeat::*Renderer)(uint8_t control, uint16_t *out, size_t size);
+  static const Processor kProcessors[16];
+  static const Renderer kRenderers[16];
+
+  template <int equation>
+  uint16_t ProcessEquation(uint8_t control);
+  template <int equation>
+  void RenderEquation(uint8_t control, uint16_t *out, size_t size);
+
+  inline void Step(uint32_t &t, uint32_t &phase, uint8_t control) const {
+    if (control & CONTROL_GATE_RISING) {
+      if (stepmode_) {
+        ++t ;
+      } else {
+        phase = 0;
+        if (loopmode_) {
+          t = loop_start_ ;
+        } else {
+          t = 0 ;
+        }
+      }
+    }
+
+    if (!stepmode_) {
+      ++phase ;
+    }
+
+    if (loopmode_ && (t < loop_start_ || t > loop_end_)) {
+       t = loop_start_ ;
+       phase = 0 ;
+    }
+
+    if (!stepmode_ && (phase % bytepitch_ == 0)) ++t;
+  }
+
+  Processor process_;
+  Renderer render_;
   uint16_t equation_ ;
   uint16_t speed_;
   uint16_t pitch_;
@@ -15,6 +15,7 @@ public:
 	static uint8_t available(void);
 	static uint32_t read(void);
 	static float countToFrequency(uint32_t count);
+	static uint32_t timer_clock(void) { return F_BUS; } // counts per second
 	static void end(void);
 };
 
@@ -38,6 +39,7 @@ public:
 	uint8_t available(void);
 	uint32_t read(void);
 	float countToFrequency(uint32_t count) { return (float)F_BUS_ACTUAL / (float)count; }
+	uint32_t timer_clock(void) { return F_BUS_ACTUAL; } // counts per second
 	void end(void);
 	~FreqMeasureClass() { if (running) end(); }
 private:
@@ -37,9 +37,11 @@ void Init() {
 
 void AdjustOffset(uint8_t offset) {
 	SH1106_128x64_Driver::AdjustOffset(offset);
+	frame_buffer.invalidate();
 }
 void SetFlipMode(bool flip180) {
     SH1106_128x64_Driver::SetFlipMode(flip180);
+    frame_buffer.invalidate();
 }
 void SetContrast(uint8_t contrast) {
     SH1106_128x64_Driver::SetContrast(contrast);
@@ -34,6 +34,9 @@ namespace display {
 extern FrameBuffer<SH1106_128x64_Driver::kFrameSize, 2> frame_buffer;
 extern PagedDisplayDriver<SH1106_128x64_Driver> driver;
 
+static_assert(decltype(frame_buffer)::kBlockSize == SH1106_128x64_Driver::kSubpageSize,
+              "Frame buffer dirty blocks must match display subpages");
+
 void Init();
 void AdjustOffset(uint8_t offset);
 void SetFlipMode(bool flip180);
@@ -51,7 +54,7 @@ static inline void Update() {
     driver.Update();
   } else {
     if (frame_buffer.readable())
-      driver.Begin(frame_buffer.readable_frame());
+      driver.Begin(frame_buffer.readable_frame(), frame_buffer.readable_dirty_mask());
   }
 }
 
@@ -13,12 +13,22 @@
 // but allows a new frame to be written while the old one is being
 // transferred.
 // See https://gist.github.com/patrickdowling/0029f58fb20e63d7db9d
+//
+// Each written frame also gets a mask of the blocks that differ from the frame
+// written before it. Frames are transferred in order, so that's exactly what
+// changed on the display and the driver can skip the rest. The comparison runs
+// in written(), i.e. outside the ISR.
 
 template <size_t frame_size, size_t frames>
 class FrameBuffer {
 public:
 
   static const size_t kFrameSize = frame_size;
+  static const size_t kNumBlocks = 32;
+  static const size_t kBlockSize = kFrameSize / kNumBlocks;
+  static const uint32_t kAllBlocks = 0xffffffff;
+  // Resend everything every so often in case the display lost something
+  static const uint32_t kFullRefreshFrames = 256;
 
   FrameBuffer() { }
 
@@ -29,6 +39,8 @@ public:
     write_ptr_ = read_ptr_ = 0;
     capture_on_next_write = false;
     capture_is_valid = false;
+    for (auto &mask : dirty_masks_) mask = kAllBlocks;
+    frames_to_full_refresh_ = 0;
   }
 
   size_t writeable() const {
@@ -49,19 +61,50 @@ public:
     return frame_buffers_[write_ptr_ % frames];
   }
 
+  // @return the most recently written frame; it doesn't change until another
+  // frame has been written after it
+  const uint8_t *last_written_frame() const {
+    return frame_buffers_[(write_ptr_ + frames - 1) % frames];
+  }
+
+  // @return blocks of readable frame that need to be sent (assumes one exists)
+  uint32_t readable_dirty_mask() const {
+    return dirty_masks_[read_ptr_ % frames];
+  }
+
   void read() {
     ++read_ptr_;
   }
 
   void written() {
+    const uint8_t *frame = frame_buffers_[write_ptr_ % frames];
     if (capture_on_next_write) {
       capture_on_next_write = false;
-      memcpy(capture_memory_, frame_buffers_[write_ptr_ % frames], kFrameSize);
+      memcpy(capture_memory_, frame, kFrameSize);
       capture_is_valid = true;
     }
+
+    uint32_t dirty_mask = kAllBlocks;
+    if (frames > 1 && frames_to_full_refresh_) {
+      const uint8_t *prev = frame_buffers_[(write_ptr_ + frames - 1) % frames];
+      dirty_mask = 0;
+      for (size_t b = 0; b < kNumBlocks; ++b, frame += kBlockSize, prev += kBlockSize) {
+        if (memcmp(frame, prev, kBlockSize))
+          dirty_mask |= (1UL << b);
+      }
+      --frames_to_full_refresh_;
+    } else {
+      frames_to_full_refresh_ = kFullRefreshFrames - 1;
+    }
+    dirty_masks_[write_ptr_ % frames] = dirty_mask;
     ++write_ptr_;
   }
 
+  // Send all of the next written frame, e.g. after the display was reconfigured
+  void invalidate() {
+    frames_to_full_refresh_ = 0;
+  }
+
   void capture_request() {
     capture_on_next_write = true;
   }
@@ -77,6 +120,8 @@ private:
   uint8_t frame_memory_[kFrameSize * frames] __attribute__ ((aligned (4)));
   uint8_t capture_memory_[kFrameSize] __attribute__ ((aligned (4)));
   uint8_t *frame_buffers_[frames];
+  uint32_t dirty_masks_[frames];
+  uint32_t frames_to_full_refresh_;
 
   volatile size_t write_ptr_;
   volatile size_t read_ptr_;
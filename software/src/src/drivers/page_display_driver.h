@@ -7,9 +7,16 @@
 // In theory parts of the transfer may be done via DMA and the page memory
 // will have to be valid until that completes, so the ::Flush call is used
 // to determine if cleanup is necessary.
+//
+// Only the subpages set in the dirty mask passed to ::Begin are sent, one per
+// ::Update, so an unchanged frame costs no transfers at all. Bit n of the mask
+// is subpage n % display_driver::kNumSubpages of page n / kNumSubpages.
 template <typename display_driver>
 class PagedDisplayDriver {
 public:
+  static constexpr uint32_t kTotalSubpages = display_driver::kNumPages * display_driver::kNumSubpages;
+  static_assert(kTotalSubpages <= 32, "Subpages don't fit dirty mask");
+  static constexpr uint32_t kAllSubpages = 0xffffffffUL >> (32 - kTotalSubpages);
 
   PagedDisplayDriver() { }
 
@@ -21,52 +28,43 @@ public:
 
     display_driver::Init();
 
-    current_page_index_ = 0;
-    current_page_data_ = NULL;
-    current_subpage_index_ = 0;
+    current_frame_ = NULL;
+    pending_subpages_ = 0;
   }
 
-  void Begin(const uint8_t *frame) {
-    current_page_data_ = frame;
-    current_page_index_ = 0;
-    current_subpage_index_ = 0;
+  void Begin(const uint8_t *frame, uint32_t dirty_mask = kAllSubpages) {
+    current_frame_ = frame;
+    pending_subpages_ = dirty_mask & kAllSubpages;
   }
 
   void Update() {
-    uint_fast8_t page = current_page_index_;
-    uint_fast8_t subpage = current_subpage_index_;
-    if (page < display_driver::kNumPages) {
-      const uint8_t *data = current_page_data_;
-      display_driver::SendPage(page, subpage, data);
-      current_subpage_index_ = subpage + 1;
-      if (current_subpage_index_ >= display_driver::kNumSubpages) {
-        current_subpage_index_ = 0;
-        current_page_index_ += 1;
-        current_page_data_ = data + display_driver::kPageSize;
-      }
+    uint32_t pending = pending_subpages_;
+    if (pending) {
+      const uint_fast8_t index = __builtin_ctz(pending);
+      const uint_fast8_t page = index / display_driver::kNumSubpages;
+      const uint_fast8_t subpage = index % display_driver::kNumSubpages;
+      display_driver::SendPage(page, subpage, current_frame_ + page * display_driver::kPageSize);
+      pending_subpages_ = pending & (pending - 1);
     }
   }
 
   bool Flush() {
     display_driver::Flush();
-    if (current_page_index_ < display_driver::kNumPages) {
+    if (!current_frame_ || pending_subpages_) {
       return false;
     } else {
-      current_page_index_ = 0;
-      current_subpage_index_ = 0;
-      current_page_data_ = NULL;
+      current_frame_ = NULL;
       return true;
     }
   }
 
   bool frame_valid() const {
-    return NULL != current_page_data_;
+    return NULL != current_frame_;
   }
 
 private:
-  uint_fast8_t current_page_index_;
-  uint_fast8_t current_subpage_index_;
-  const uint8_t *current_page_data_;
+  const uint8_t *current_frame_;
+  uint32_t pending_subpages_;
 
   DISALLOW_COPY_AND_ASSIGN(PagedDisplayDriver);
 };
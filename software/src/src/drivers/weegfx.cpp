@@ -34,7 +34,6 @@ namespace weegfx {
 // - Bench templated draw_pixel_row (inlined versions) vs. function pointers
 // - Offer specialized functions w/o clipping or specific draw mode (e.g. text overwrite)
 // - Remainder masks as LUT or switch
-// - 32bit ops? Should be possible along x-axis (use SIMD instructions?) but not y (page stride)
 // - Clipping for x, y < 0
 // - Support 16 bit text characters?
 // - Kerning/BBX etc.
@@ -61,13 +60,23 @@ namespace weegfx {
   do {                                  \
   } while (0)
 
+// Along x the frame is contiguous bytes, so rows of a page can be handled
+// four columns at a time once the destination is word aligned.
+typedef uint32_t __attribute__((__may_alias__)) frame_word;
+static constexpr coord_t kMinWordRow = 8;
+
 // clang-format off
-template <PIXEL_OP op>
-inline uint8_t pixel_op_impl(uint8_t a, uint8_t n) __attribute__((always_inline));
-template <> inline uint8_t pixel_op_impl<PIXEL_OP_OR>(uint8_t a, uint8_t b) { return a | b; }
-template <> inline uint8_t pixel_op_impl<PIXEL_OP_XOR>(uint8_t a, uint8_t b) { return a ^ b; }
-template <> inline uint8_t pixel_op_impl<PIXEL_OP_SRC>(uint8_t, uint8_t b) { return b; }
-template <> inline uint8_t pixel_op_impl<PIXEL_OP_NAND>(uint8_t a, uint8_t b) { return a & ~b; }
+template <PIXEL_OP op, typename T>
+inline T pixel_op_impl(T a, T b) __attribute__((always_inline));
+template <PIXEL_OP op, typename T>
+inline T pixel_op_impl(T a, T b) {
+  switch (op) {
+    case PIXEL_OP_OR: return a | b;
+    case PIXEL_OP_XOR: return a ^ b;
+    case PIXEL_OP_NAND: return a & ~b;
+    default: return b;
+  }
+}
 
 template <PIXEL_OP pixel_op> inline void draw_pixel_row(uint8_t *dst, coord_t count, uint8_t mask) __attribute__((always_inline));
 template <PIXEL_OP pixel_op> inline void draw_pixel_row(uint8_t *dst, coord_t count, const uint8_t *src) __attribute__((always_inline));
@@ -80,8 +89,21 @@ template <PIXEL_OP pixel_op> inline void blit(uint8_t *dst, coord_t y, coord_t w
 template <PIXEL_OP pixel_op>
 inline void draw_pixel_row(uint8_t *dst, coord_t count, uint8_t mask)
 {
+  if (count >= kMinWordRow) {
+    while (reinterpret_cast<uintptr_t>(dst) & 3) {
+      *dst = pixel_op_impl<pixel_op, uint8_t>(*dst, mask);
+      ++dst;
+      --count;
+    }
+    const uint32_t mask32 = mask * 0x01010101U;
+    frame_word *dst32 = reinterpret_cast<frame_word *>(dst);
+    for (coord_t words = count >> 2; words; --words, ++dst32)
+      *dst32 = pixel_op_impl<pixel_op, uint32_t>(*dst32, mask32);
+    dst = reinterpret_cast<uint8_t *>(dst32);
+    count &= 3;
+  }
   while (count--) {
-    *dst = pixel_op_impl<pixel_op>(*dst, mask);
+    *dst = pixel_op_impl<pixel_op, uint8_t>(*dst, mask);
     ++dst;
   }
 }
@@ -90,7 +112,7 @@ template <PIXEL_OP pixel_op>
 inline void draw_pixel_row(uint8_t *dst, coord_t count, const uint8_t *src)
 {
   while (count--) {
-    *dst = pixel_op_impl<pixel_op>(*dst, *src);
+    *dst = pixel_op_impl<pixel_op, uint8_t>(*dst, *src);
     ++dst;
     ++src;
   }
@@ -100,7 +122,7 @@ template <PIXEL_OP pixel_op>
 inline void draw_pixel_row_lshift(uint8_t *dst, coord_t count, const uint8_t *src, int shift)
 {
   while (count--) {
-    *dst = pixel_op_impl<pixel_op>(*dst, *src << shift);
+    *dst = pixel_op_impl<pixel_op, uint8_t>(*dst, *src << shift);
     ++dst;
     ++src;
   }
@@ -110,7 +132,7 @@ template <PIXEL_OP pixel_op>
 inline void draw_pixel_row_rshift(uint8_t *dst, coord_t count, const uint8_t *src, int shift)
 {
   while (count--) {
-    *dst = pixel_op_impl<pixel_op>(*dst, *src >> shift);
+    *dst = pixel_op_impl<pixel_op, uint8_t>(*dst, *src >> shift);
     ++dst;
     ++src;
   }
@@ -326,6 +348,20 @@ void Graphics::writeBitmap8(coord_t x, coord_t y, coord_t w, const uint8_t *data
   blit<PIXEL_OP_SRC>(get_frame_ptr(x, y), y, w, h, data);
 }
 
+void Graphics::saveColumns(coord_t x, coord_t w, uint8_t *dst) const
+{
+  const uint8_t *src = frame_ + x;
+  for (coord_t page = 0; page < kHeight / 8; ++page, src += kWidth, dst += w)
+    memcpy(dst, src, w);
+}
+
+void Graphics::restoreColumns(coord_t x, coord_t w, const uint8_t *src)
+{
+  uint8_t *dst = frame_ + x;
+  for (coord_t page = 0; page < kHeight / 8; ++page, dst += kWidth, src += w)
+    memcpy(dst, src, w);
+}
+
 // p = period. Draw a dotted line with a pixel every p
 void Graphics::drawLine(coord_t x0, coord_t y0, coord_t x1, coord_t y1, const uint8_t p) {
   uint8_t c = 0;
@@ -421,9 +457,27 @@ static inline font_glyph get_char_glyph(char c)
 
 static char print_buf[128] = {0};
 
-// OPTIMIZE When printing strings, all chars will have the same y/remainder
-// This will probably only save a few cycles, if any. Also the clipping can
-// be made optional (template?)
+// Unclipped glyph at dst; at unaligned y each column is shifted once and
+// split across the two pages. A pre-shifted copy of the font would be 8K
+// for the seven offsets, to save a shift that's free on ARM.
+template <PIXEL_OP pixel_op>
+inline void blit_glyph(uint8_t *dst, coord_t shift, font_glyph glyph) __attribute__((always_inline));
+template <PIXEL_OP pixel_op>
+inline void blit_glyph(uint8_t *dst, coord_t shift, font_glyph glyph)
+{
+  if (!shift) {
+    for (coord_t i = 0; i < kFixedFontW; ++i)
+      dst[i] = pixel_op_impl<pixel_op, uint8_t>(dst[i], glyph[i]);
+  } else {
+    uint8_t *next_page = dst + Graphics::kWidth;
+    for (coord_t i = 0; i < kFixedFontW; ++i) {
+      const uint16_t column = glyph[i] << shift;
+      dst[i] = pixel_op_impl<pixel_op, uint8_t>(dst[i], column);
+      next_page[i] = pixel_op_impl<pixel_op, uint8_t>(next_page[i], column >> 8);
+    }
+  }
+}
+
 template <PIXEL_OP pixel_op>
 void Graphics::blit_char(char c, coord_t x, coord_t y)
 {
@@ -450,10 +504,24 @@ void Graphics::print_impl(const char *s)
   coord_t x = text_x_;
   coord_t y = text_y_;
 
-  // TODO Track position, only clip when necessary or early-out?
-  while (*s) {
-    blit_char<pixel_op>(*s++, x, y);
-    x += kFixedFontW;
+  if (y >= 0 && y <= kHeight - kFixedFontH) {
+    // All rows visible, so only chars hanging off the sides need clipping
+    uint8_t *row = get_frame_ptr(0, y);
+    const coord_t shift = y & 0x7;
+    while (*s) {
+      const char c = *s++;
+      if (x >= 0 && x <= kWidth - kFixedFontW) {
+        if (c > 32 && c <= 127) blit_glyph<pixel_op>(row + x, shift, get_char_glyph(c));
+      } else {
+        blit_char<pixel_op>(c, x, y);
+      }
+      x += kFixedFontW;
+    }
+  } else {
+    while (*s) {
+      blit_char<pixel_op>(*s++, x, y);
+      x += kFixedFontW;
+    }
   }
 
   text_x_ = x;
@@ -529,10 +597,10 @@ void Graphics::print(uint16_t value, unsigned width)
   print(str);
 }
 
-void Graphics::print(uint32_t value, size_t width)
+void Graphics::print(uint32_t value, unsigned width)
 {
   char *str = itos<uint32_t, false>(value, print_buf, sizeof(print_buf));
-  while (str > print_buf && (size_t)(str - print_buf) >= sizeof(print_buf) - width) *--str = ' ';
+  while (str > print_buf && (unsigned)(str - print_buf) >= sizeof(print_buf) - width) *--str = ' ';
   print(str);
 }
 
@@ -73,6 +73,10 @@ public:
   void drawBitmap8(coord_t x, coord_t y, coord_t w, const uint8_t *data);
   void writeBitmap8(coord_t x, coord_t y, coord_t w, const uint8_t *data);
 
+  // Full-height column blocks, kHeight / 8 pages of w bytes each; no clipping
+  void saveColumns(coord_t x, coord_t w, uint8_t *dst) const;
+  void restoreColumns(coord_t x, coord_t w, const uint8_t *src);
+
   // Beware: No clipping
   void drawCircle(coord_t center_x, coord_t center_y, coord_t r);
 
@@ -0,0 +1,336 @@
+#ifndef CHUNKSTORE_H_
+#define CHUNKSTORE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Incremental, journalled storage of app chunks in a file (LittleFS in
+ * program flash, SD, ...).
+ *
+ * Keeps a RAM image of every chunk, indexed by app id. ::Stage compares new
+ * contents against the image and only marks a chunk dirty if it changed;
+ * ::Poll then appends at most one record per call to the journal file, so it
+ * can be called from loop() without stalling anything for long. Nothing here
+ * is touched from an ISR.
+ *
+ * Journal records are { magic, id, length, checksum } followed by the chunk
+ * data. On ::Begin the journal is replayed in order, later records replacing
+ * earlier ones; replay stops at the first record that is truncated or fails
+ * the checksum, so a write interrupted by power loss only loses that record.
+ *
+ * When the journal grows past kJournalLimit, the current image is written
+ * record-by-record to a temporary file that then replaces the journal. If
+ * power fails before the rename the old journal is still complete; if it
+ * fails after the old journal was removed, ::Begin finishes the rename.
+ * Together with the filesystem's own wear-levelling this spreads writes
+ * over the whole partition instead of rewriting one page. A compaction that
+ * keeps failing is given up after kMaxCompactionAttempts, leaving the old
+ * journal as it was, and is tried again on the next ::Stage.
+ *
+ * FS/FILE_TYPE follow the Teensy FS/File interface (open/exists/remove/rename,
+ * read/write/size/close); FILE_READ and FILE_WRITE (append) must be defined.
+ */
+template <typename FS, typename FILE_TYPE, size_t CAPACITY, size_t MAX_CHUNKS>
+class ChunkStore {
+public:
+
+  static const size_t kJournalLimit = 4 * CAPACITY;
+  static const int kMaxCompactionAttempts = 3;
+
+  struct Stats {
+    uint32_t records_written;
+    uint32_t bytes_written;
+    uint32_t compactions;
+    uint32_t write_errors;
+    uint32_t bad_records; // dropped during replay
+    uint32_t compactions_abandoned;
+  };
+
+  /**
+   * Attach to filesystem and replay the journal into the image.
+   * @return true if any chunks were loaded
+   */
+  bool Begin(FS *fs, const char *path, const char *tmp_path) {
+    fs_ = fs;
+    path_ = path;
+    tmp_path_ = tmp_path;
+    num_entries_ = 0;
+    image_used_ = 0;
+    journal_size_ = 0;
+    compacting_ = false;
+    compact_failures_ = 0;
+    stalled_ = false;
+    memset(&stats_, 0, sizeof(stats_));
+
+    if (fs_->exists(tmp_path_)) {
+      if (fs_->exists(path_))
+        fs_->remove(tmp_path_); // unfinished compaction, journal still valid
+      else
+        fs_->rename(tmp_path_, path_); // compaction finished, rename didn't
+    }
+
+    Replay();
+    return num_entries_ > 0;
+  }
+
+  /**
+   * Drop all chunks and remove the files
+   */
+  void Clear() {
+    num_entries_ = 0;
+    image_used_ = 0;
+    journal_size_ = 0;
+    compacting_ = false;
+    compact_failures_ = 0;
+    stalled_ = false;
+    if (fs_) {
+      fs_->remove(tmp_path_);
+      fs_->remove(path_);
+    }
+  }
+
+  /**
+   * Update a chunk in the image.
+   * @return true if the contents changed and the chunk will be written
+   */
+  bool Stage(uint16_t id, const void *data, size_t length) {
+    // a save is a good time to retry an abandoned compaction
+    stalled_ = false;
+    compact_failures_ = 0;
+    if (!Put(id, data, length, true))
+      return false;
+    return entries_[Find(id)].dirty;
+  }
+
+  /**
+   * Write one pending record, or one step of a compaction.
+   * @return true if anything was written, or tried
+   */
+  bool Poll() {
+    if (!fs_ || stalled_) return false;
+
+    if (compacting_) {
+      if (compact_index_ < num_entries_) {
+        Entry &entry = entries_[compact_index_];
+        if (Append(tmp_path_, entry)) {
+          entry.dirty = false;
+          ++compact_index_;
+        } else {
+          StartCompaction();
+          if (++compact_failures_ >= kMaxCompactionAttempts) {
+            // park it rather than retry forever; the journal is still whole
+            stalled_ = true;
+            ++stats_.compactions_abandoned;
+          }
+        }
+        return true;
+      }
+      fs_->remove(path_);
+      fs_->rename(tmp_path_, path_);
+      journal_size_ = compact_size_;
+      compacting_ = false;
+      compact_failures_ = 0;
+      ++stats_.compactions;
+      return true;
+    }
+
+    for (size_t i = 0; i < num_entries_; ++i) {
+      Entry &entry = entries_[i];
+      if (!entry.dirty) continue;
+
+      if (journal_size_ + sizeof(RecordHeader) + entry.length > kJournalLimit) {
+        StartCompaction();
+      } else if (Append(path_, entry)) {
+        entry.dirty = false;
+      } else {
+        // anything after a torn record is unreachable on replay
+        StartCompaction();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool pending() const {
+    if (stalled_) return false;
+    if (compacting_) return true;
+    for (size_t i = 0; i < num_entries_; ++i)
+      if (entries_[i].dirty) return true;
+    return false;
+  }
+
+  size_t num_chunks() const { return num_entries_; }
+  uint16_t chunk_id(size_t index) const { return entries_[index].id; }
+  size_t chunk_length(size_t index) const { return entries_[index].length; }
+  const void *chunk_data(size_t index) const { return image_ + entries_[index].offset; }
+
+  size_t journal_size() const { return journal_size_; }
+  const Stats &stats() const { return stats_; }
+
+private:
+
+  static const uint16_t kMagic = 0x4a43; // 'CJ'
+
+  struct RecordHeader {
+    uint16_t magic;
+    uint16_t id;
+    uint16_t length;
+    uint16_t checksum;
+  } __attribute__((packed));
+
+  struct Entry {
+    uint16_t id;
+    uint16_t length;
+    uint16_t offset;
+    bool dirty;
+  };
+
+  FS *fs_ = nullptr;
+  const char *path_;
+  const char *tmp_path_;
+
+  Entry entries_[MAX_CHUNKS];
+  size_t num_entries_;
+  uint8_t image_[CAPACITY];
+  size_t image_used_;
+  uint8_t scratch_[CAPACITY];
+
+  size_t journal_size_;
+  bool compacting_;
+  size_t compact_index_;
+  size_t compact_size_;
+  int compact_failures_;
+  bool stalled_;
+
+  Stats stats_;
+
+  // Fletcher-16 over id, length and data
+  static uint16_t checksum(uint16_t id, uint16_t length, const uint8_t *data) {
+    uint16_t a = 0, b = 0;
+    const uint8_t header[4] = {
+      uint8_t(id), uint8_t(id >> 8), uint8_t(length), uint8_t(length >> 8)
+    };
+    for (uint8_t c : header) {
+      a = (a + c) % 255;
+      b = (b + a) % 255;
+    }
+    while (length--) {
+      a = (a + *data++) % 255;
+      b = (b + a) % 255;
+    }
+    return (b << 8) | a;
+  }
+
+  int Find(uint16_t id) const {
+    for (size_t i = 0; i < num_entries_; ++i)
+      if (entries_[i].id == id) return i;
+    return -1;
+  }
+
+  void Remove(size_t index) {
+    const Entry removed = entries_[index];
+    const size_t tail = removed.offset + removed.length;
+    memmove(image_ + removed.offset, image_ + tail, image_used_ - tail);
+    image_used_ -= removed.length;
+    for (size_t i = index; i + 1 < num_entries_; ++i)
+      entries_[i] = entries_[i + 1];
+    --num_entries_;
+    for (size_t i = 0; i < num_entries_; ++i)
+      if (entries_[i].offset > removed.offset) entries_[i].offset -= removed.length;
+  }
+
+  bool Put(uint16_t id, const void *data, size_t length, bool mark_dirty) {
+    int index = Find(id);
+    if (index >= 0 && entries_[index].length != length) {
+      Remove(index);
+      index = -1;
+      if (compacting_) StartCompaction(); // indices moved
+    }
+
+    if (index < 0) {
+      if (num_entries_ >= MAX_CHUNKS || image_used_ + length > CAPACITY)
+        return false;
+      Entry &entry = entries_[num_entries_++];
+      entry.id = id;
+      entry.length = length;
+      entry.offset = image_used_;
+      entry.dirty = mark_dirty;
+      memcpy(image_ + image_used_, data, length);
+      image_used_ += length;
+      return true;
+    }
+
+    Entry &entry = entries_[index];
+    if (memcmp(image_ + entry.offset, data, length)) {
+      memcpy(image_ + entry.offset, data, length);
+      entry.dirty = mark_dirty;
+    } else if (!mark_dirty) {
+      entry.dirty = false;
+    }
+    return true;
+  }
+
+  void Replay() {
+    FILE_TYPE file = fs_->open(path_, FILE_READ);
+    if (!file) return;
+
+    const size_t file_size = file.size();
+    size_t pos = 0;
+    RecordHeader header;
+    while (pos + sizeof(header) <= file_size) {
+      if (file.read(&header, sizeof(header)) != (int)sizeof(header)) break;
+      if (header.magic != kMagic || header.length > CAPACITY) break;
+      if (file.read(scratch_, header.length) != (int)header.length) break;
+      if (header.checksum != checksum(header.id, header.length, scratch_)) break;
+      if (!Put(header.id, scratch_, header.length, false)) break;
+      pos += sizeof(header) + header.length;
+    }
+    file.close();
+
+    journal_size_ = pos;
+    if (pos < file_size) {
+      ++stats_.bad_records;
+      StartCompaction();
+    }
+  }
+
+  bool Append(const char *path, const Entry &entry) {
+    FILE_TYPE file = fs_->open(path, FILE_WRITE);
+    if (!file) {
+      ++stats_.write_errors;
+      return false;
+    }
+
+    const uint8_t *data = image_ + entry.offset;
+    RecordHeader header = { kMagic, entry.id, entry.length, checksum(entry.id, entry.length, data) };
+    const size_t written = file.write(&header, sizeof(header)) + file.write(data, entry.length);
+    file.close();
+
+    const size_t length = sizeof(header) + entry.length;
+    if (written != length) {
+      ++stats_.write_errors;
+      return false;
+    }
+
+    if (compacting_) compact_size_ += length;
+    else journal_size_ += length;
+    ++stats_.records_written;
+    stats_.bytes_written += length;
+    return true;
+  }
+
+  void StartCompaction() {
+    fs_->remove(tmp_path_);
+    compacting_ = true;
+    compact_index_ = 0;
+    compact_size_ = 0;
+  }
+};
+
+template <typename FS, typename FILE_TYPE, size_t CAPACITY, size_t MAX_CHUNKS>
+const size_t ChunkStore<FS, FILE_TYPE, CAPACITY, MAX_CHUNKS>::kJournalLimit;
+template <typename FS, typename FILE_TYPE, size_t CAPACITY, size_t MAX_CHUNKS>
+const int ChunkStore<FS, FILE_TYPE, CAPACITY, MAX_CHUNKS>::kMaxCompactionAttempts;
+
+#endif // CHUNKSTORE_H_
@@ -0,0 +1,178 @@
+#ifndef UTIL_FRAMESTREAM_H_
+#define UTIL_FRAMESTREAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace util {
+
+/**
+ * Streams the display to a host (e.g. USB serial) from loop().
+ *
+ * Keeps a copy of what the host has been sent, and on ::Poll sends only the
+ * pages of the current frame that differ from it: the XOR of old and new,
+ * run-length encoded, so a blinking cursor costs a handful of bytes. The
+ * frame itself is read in place; nothing is copied when frames are written,
+ * and nothing here runs in the ISR.
+ *
+ * Packets are
+ *   0xA5 0x5A, page index (or kEndOfFrame), payload length (16 bit LE), payload
+ * Payload is a sequence of
+ *   0x00..0x7F: n + 1 literal bytes follow
+ *   0x80..0xFF: the next byte repeats (n & 0x7F) + 2 times
+ * which XORed into the host's copy of the page gives the new page. An
+ * end-of-frame packet (no payload) follows once all pages are sent, so the
+ * host knows when the picture is complete.
+ *
+ * Only one packet is in flight at a time, and it goes out in pieces of
+ * whatever the sink says it has room for: Teensy 3.x never reports more than
+ * what's left of the current 64-byte USB packet, less than a whole page. A
+ * slow link just delays pages instead of stalling loop(); the host copy is
+ * updated as a page is queued, and the bytes follow in order.
+ *
+ * SINK follows the Arduino Print interface: availableForWrite() and
+ * write(const uint8_t *, size_t).
+ */
+template <size_t frame_size, size_t page_size>
+class FrameStreamer {
+public:
+  static constexpr size_t kNumPages = frame_size / page_size;
+  static constexpr uint8_t kSync0 = 0xA5;
+  static constexpr uint8_t kSync1 = 0x5A;
+  static constexpr uint8_t kEndOfFrame = 0xFF;
+  static constexpr size_t kHeaderSize = 5;
+  // Runs are >= 3 bytes and a literal block is only cut short by a run, so
+  // the worst case is all literals
+  static constexpr size_t kMaxPayloadSize = page_size + (page_size + 127) / 128;
+  static constexpr size_t kMaxPacketSize = kHeaderSize + kMaxPayloadSize;
+
+  static_assert(kNumPages < kEndOfFrame, "too many pages");
+
+  FrameStreamer() : packet_length_(0), packet_sent_(0) { Stop(); }
+
+  // The host starts from a blank frame, so the first frame goes out in full
+  void Start() {
+    memset(remote_, 0, sizeof(remote_));
+    next_page_ = 0;
+    packet_length_ = packet_sent_ = 0;
+    end_of_frame_pending_ = true;
+    active_ = true;
+  }
+
+  void Stop() {
+    active_ = false;
+  }
+
+  bool active() const {
+    return active_;
+  }
+
+  // Send changed pages of frame, starting where the last call stopped
+  template <typename SINK>
+  void Poll(const uint8_t *frame, SINK &sink) {
+    if (!active_) return;
+    if (!Flush(sink)) return;
+
+    for (size_t i = 0; i < kNumPages; ++i) {
+      const size_t page = next_page_;
+      const uint8_t *src = frame + page * page_size;
+      uint8_t *remote = remote_ + page * page_size;
+      next_page_ = (page + 1) % kNumPages;
+      if (memcmp(src, remote, page_size)) {
+        const size_t length = EncodeDelta(src, remote, packet_ + kHeaderSize);
+        WriteHeader(packet_, page, length);
+        packet_length_ = kHeaderSize + length;
+        memcpy(remote, src, page_size);
+        end_of_frame_pending_ = true;
+        if (!Flush(sink)) return;
+      }
+    }
+
+    if (end_of_frame_pending_) {
+      WriteHeader(packet_, kEndOfFrame, 0);
+      packet_length_ = kHeaderSize;
+      end_of_frame_pending_ = false;
+      Flush(sink);
+    }
+  }
+
+  // RLE of (page ^ remote) into out, at most kMaxPayloadSize bytes
+  static size_t EncodeDelta(const uint8_t *page, const uint8_t *remote, uint8_t *out) {
+    size_t length = 0;
+    size_t i = 0;
+    while (i < page_size) {
+      const uint8_t delta = page[i] ^ remote[i];
+      size_t run = 1;
+      while (i + run < page_size && run < 129 && uint8_t(page[i + run] ^ remote[i + run]) == delta)
+        ++run;
+
+      // A run of two saves nothing, and breaking up literals for it costs a byte
+      if (run >= 3) {
+        out[length++] = 0x80 | (run - 2);
+        out[length++] = delta;
+        i += run;
+      } else {
+        // Literals up to the start of the next run
+        uint8_t *count = out + length++;
+        *count = 0xff;
+        do {
+          out[length++] = page[i] ^ remote[i];
+          ++i;
+          ++*count;
+        } while (i < page_size && *count < 127 && !RunAt(page, remote, i));
+      }
+    }
+    return length;
+  }
+
+private:
+  uint8_t remote_[frame_size];
+  uint8_t packet_[kMaxPacketSize];
+  size_t packet_length_;
+  size_t packet_sent_;
+  size_t next_page_;
+  bool end_of_frame_pending_;
+  bool active_;
+
+  // Write as much of the queued packet as the sink takes
+  // @return true once all of it is out
+  template <typename SINK>
+  bool Flush(SINK &sink) {
+    while (packet_sent_ < packet_length_) {
+      const int room = sink.availableForWrite();
+      if (room <= 0) return false;
+      const size_t n = packet_length_ - packet_sent_ < size_t(room) ? packet_length_ - packet_sent_ : size_t(room);
+      sink.write(packet_ + packet_sent_, n);
+      packet_sent_ += n;
+    }
+    packet_length_ = packet_sent_ = 0;
+    return true;
+  }
+
+  static bool RunAt(const uint8_t *page, const uint8_t *remote, size_t i) {
+    if (i + 2 >= page_size) return false;
+    const uint8_t delta = page[i] ^ remote[i];
+    return uint8_t(page[i + 1] ^ remote[i + 1]) == delta && uint8_t(page[i + 2] ^ remote[i + 2]) == delta;
+  }
+
+  static void WriteHeader(uint8_t *packet, uint8_t id, size_t length) {
+    packet[0] = kSync0;
+    packet[1] = kSync1;
+    packet[2] = id;
+    packet[3] = length & 0xff;
+    packet[4] = length >> 8;
+  }
+};
+
+template <size_t frame_size, size_t page_size> constexpr size_t FrameStreamer<frame_size, page_size>::kNumPages;
+template <size_t frame_size, size_t page_size> constexpr uint8_t FrameStreamer<frame_size, page_size>::kSync0;
+template <size_t frame_size, size_t page_size> constexpr uint8_t FrameStreamer<frame_size, page_size>::kSync1;
+template <size_t frame_size, size_t page_size> constexpr uint8_t FrameStreamer<frame_size, page_size>::kEndOfFrame;
+template <size_t frame_size, size_t page_size> constexpr size_t FrameStreamer<frame_size, page_size>::kHeaderSize;
+template <size_t frame_size, size_t page_size> constexpr size_t FrameStreamer<frame_size, page_size>::kMaxPayloadSize;
+template <size_t frame_size, size_t page_size> constexpr size_t FrameStreamer<frame_size, page_size>::kMaxPacketSize;
+
+} // namespace util
+
+#endif // UTIL_FRAMESTREAM_H_
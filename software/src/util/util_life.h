@@ -0,0 +1,116 @@
+#ifndef UTIL_LIFE_H_
+#define UTIL_LIFE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace util {
+
+/**
+ * Conway's Game of Life on a torus 64 cells wide, one uint64_t per row with
+ * column x in bit x.
+ *
+ * A generation is computed a whole row at a time: the eight neighbours of
+ * every cell are the rows above, at and below, rotated by one column each
+ * way, and they're summed bit-sliced with full adders, so each bit of the
+ * partial sums belongs to its own cell. Only whether the count is 2, 3 or
+ * something else matters, so the sum stops at the 4s bit.
+ */
+template <size_t rows>
+class LifeBoard {
+public:
+  static constexpr int kWidth = 64;
+  static constexpr int kHeight = rows;
+
+  void Clear() {
+    for (uint64_t &row : board_) row = 0;
+  }
+
+  void Set(int x, int y) {
+    board_[y] |= uint64_t(1) << x;
+  }
+
+  bool Get(int x, int y) const {
+    return (board_[y] >> x) & 1;
+  }
+
+  uint64_t row(int y) const {
+    return board_[y];
+  }
+
+  void Step() {
+    uint64_t above = board_[rows - 1];
+    uint64_t here = board_[0];
+    const uint64_t first = here;
+    for (size_t y = 0; y < rows; ++y) {
+      const uint64_t below = (y + 1 < rows) ? board_[y + 1] : first;
+      board_[y] = NextRow(above, here, below);
+      above = here;
+      here = below;
+    }
+  }
+
+  // Live cells
+  int Count() const {
+    int count = 0;
+    for (const uint64_t &row : board_) count += __builtin_popcountll(row);
+    return count;
+  }
+
+  // Live cells less than radius away from (x, y) in both directions, not
+  // wrapping around the edges
+  int CountNear(int x, int y, int radius) const {
+    const int x0 = x - radius + 1 < 0 ? 0 : x - radius + 1;
+    const int x1 = x + radius - 1 > kWidth - 1 ? kWidth - 1 : x + radius - 1;
+    const int y0 = y - radius + 1 < 0 ? 0 : y - radius + 1;
+    const int y1 = y + radius - 1 > kHeight - 1 ? kHeight - 1 : y + radius - 1;
+    if (x0 > x1) return 0;
+
+    const uint64_t mask = (~uint64_t(0) >> (kWidth - 1 - (x1 - x0))) << x0;
+    int count = 0;
+    for (int row = y0; row <= y1; ++row) count += __builtin_popcountll(board_[row] & mask);
+    return count;
+  }
+
+  static uint64_t NextRow(uint64_t above, uint64_t here, uint64_t below) {
+    // Neighbours to the left (x - 1) and right (x + 1) of each cell
+    const uint64_t al = RotateLeft(above), ar = RotateRight(above);
+    const uint64_t hl = RotateLeft(here), hr = RotateRight(here);
+    const uint64_t bl = RotateLeft(below), br = RotateRight(below);
+
+    // Column sums: two bits for the rows above and below, and the two
+    // neighbours in this row
+    const uint64_t a0 = al ^ above ^ ar, a1 = (al & above) | (ar & (al ^ above));
+    const uint64_t b0 = bl ^ below ^ br, b1 = (bl & below) | (br & (bl ^ below));
+    const uint64_t h0 = hl ^ hr, h1 = hl & hr;
+
+    // 1s and the carry into the 2s
+    const uint64_t s0 = a0 ^ b0 ^ h0;
+    const uint64_t c0 = (a0 & b0) | (h0 & (a0 ^ b0));
+
+    // 2s, and whether two or more of them make a 4
+    const uint64_t x = a1 ^ b1, z = h1 ^ c0;
+    const uint64_t s1 = x ^ z;
+    const uint64_t fours = (a1 & b1) | (h1 & c0) | (x & z);
+
+    // Exactly 3, or 2 and alive
+    return s1 & ~fours & (s0 | here);
+  }
+
+private:
+  uint64_t board_[rows];
+
+  static uint64_t RotateLeft(uint64_t row) {
+    return (row << 1) | (row >> 63);
+  }
+  static uint64_t RotateRight(uint64_t row) {
+    return (row >> 1) | (row << 63);
+  }
+};
+
+template <size_t rows> constexpr int LifeBoard<rows>::kWidth;
+template <size_t rows> constexpr int LifeBoard<rows>::kHeight;
+
+} // namespace util
+
+#endif // UTIL_LIFE_H_
@@ -41,14 +41,24 @@
 inline uint32_t USAT16(uint32_t value) __attribute__((always_inline));
 inline uint32_t USAT16(uint32_t value) {
   uint32_t result;
+#ifdef __arm__
   __asm("usat %0, %1, %2" : "=r" (result) : "I" (16), "r" (value));
+#else
+  // usat treats the register as signed
+  const int32_t v = static_cast<int32_t>(value);
+  result = v < 0 ? 0 : v > 65535 ? 65535 : v;
+#endif
   return result;
 }
 
 inline uint32_t USAT16(int32_t value) __attribute__((always_inline));
 inline uint32_t USAT16(int32_t value) {
   uint32_t result;
+#ifdef __arm__
   __asm("usat %0, %1, %2" : "=r" (result) : "I" (16), "r" (value));
+#else
+  result = value < 0 ? 0 : value > 65535 ? 65535 : value;
+#endif
   return result;
 }
 
@@ -56,7 +66,13 @@ static inline uint32_t multiply_u32xu32_rshift24(uint32_t a, uint32_t b) __attri
 static inline uint32_t multiply_u32xu32_rshift24(uint32_t a, uint32_t b)
 {
   uint32_t lo, hi;
+#ifdef __arm__
   asm volatile("umull %0, %1, %2, %3" : "=r" (lo), "=r" (hi) : "r" (a), "r" (b));
+#else
+  const uint64_t product = static_cast<uint64_t>(a) * b;
+  lo = static_cast<uint32_t>(product);
+  hi = static_cast<uint32_t>(product >> 32);
+#endif
   return (lo >> 24) | (hi << 8);
 }
 
@@ -64,7 +80,13 @@ static inline uint32_t multiply_u32xu32_rshift(uint32_t a, uint32_t b, uint32_t
 static inline uint32_t multiply_u32xu32_rshift(uint32_t a, uint32_t b, uint32_t shift)
 {
   uint32_t lo, hi;
+#ifdef __arm__
   asm volatile("umull %0, %1, %2, %3" : "=r" (lo), "=r" (hi) : "r" (a), "r" (b));
+#else
+  const uint64_t product = static_cast<uint64_t>(a) * b;
+  lo = static_cast<uint32_t>(product);
+  hi = static_cast<uint32_t>(product >> 32);
+#endif
   return (lo >> shift) | (hi << (32 - shift));
 }
 
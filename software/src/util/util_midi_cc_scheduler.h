@@ -0,0 +1,190 @@
+#ifndef UTIL_MIDI_CC_SCHEDULER_H_
+#define UTIL_MIDI_CC_SCHEDULER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace util {
+
+enum MIDIControlResolution : uint8_t {
+  MIDI_CC_7BIT,  // one CC
+  MIDI_CC_14BIT, // CC n (MSB) and n + 32 (LSB), for n < 32
+  MIDI_CC_NRPN,  // NRPN select (99/98) and data entry (6/38)
+  MIDI_CC_RESOLUTION_LAST
+};
+
+/**
+ * Turns continuously changing controller values into a bounded stream of CC
+ * messages.
+ *
+ * Set() only records the latest value; Process() runs once per tick and
+ * sends a slot's value when it differs from what went out last, at most once
+ * per interval per slot and one slot per tick, round robin. A value that
+ * keeps moving goes out at the interval rate and always ends on the latest
+ * value; a value that settles costs nothing.
+ *
+ * 14-bit values only send the MSB when it changed, and NRPN only reselects
+ * the parameter when another one was selected on that channel since.
+ */
+template <size_t num_slots>
+class MIDIControlScheduler {
+public:
+  MIDIControlScheduler() {
+    Init(0);
+  }
+
+  void Init(uint16_t interval_ticks) {
+    interval_ = interval_ticks;
+    next_ = 0;
+    messages_ = 0;
+    for (Slot &slot : slots_) {
+      slot.channel = 0;
+      slot.number = 0;
+      slot.resolution = MIDI_CC_7BIT;
+      slot.enabled = false;
+      slot.value = 0;
+      slot.countdown = 0;
+      slot.sent = kNothingSent;
+    }
+    for (uint16_t &nrpn : nrpn_) nrpn = kNothingSent;
+  }
+
+  // Minimum ticks between two updates of the same slot
+  void set_interval(uint16_t interval_ticks) {
+    interval_ = interval_ticks;
+  }
+
+  uint16_t interval() const {
+    return interval_;
+  }
+
+  // channel is 0-15. 14-bit needs a CC below 32, and falls back to 7-bit
+  // otherwise. Changing anything sends the value again.
+  void Configure(size_t index, uint8_t channel, uint8_t number, MIDIControlResolution resolution) {
+    Slot &slot = slots_[index];
+    if (resolution == MIDI_CC_14BIT && number >= 32) resolution = MIDI_CC_7BIT;
+    if (slot.enabled && slot.channel == channel && slot.number == number && slot.resolution == resolution)
+      return;
+    slot.channel = channel & 0x0f;
+    slot.number = number & 0x7f;
+    slot.resolution = resolution;
+    slot.enabled = true;
+    slot.sent = kNothingSent;
+  }
+
+  // Stop sending for slot; a later Configure() starts over
+  void Disable(size_t index) {
+    slots_[index].enabled = false;
+  }
+
+  // value is 14-bit; 7-bit CCs send the upper 7 bits
+  void Set(size_t index, uint16_t value) {
+    slots_[index].value = value & 0x3fff;
+  }
+
+  /**
+   * Once per tick. SEND is called as send(channel, cc, value) for each CC
+   * message. With hold set (e.g. a note went out this tick) nothing is sent,
+   * but the intervals keep counting.
+   */
+  template <typename SEND>
+  void Process(SEND &&send, bool hold = false) {
+    for (Slot &slot : slots_) {
+      if (slot.countdown) --slot.countdown;
+    }
+    if (hold) return;
+
+    for (size_t i = 0; i < num_slots; ++i) {
+      const size_t index = (next_ + i) % num_slots;
+      Slot &slot = slots_[index];
+      if (!slot.enabled || slot.countdown || !changed(slot)) continue;
+
+      SendSlot(slot, send);
+      slot.countdown = interval_;
+      next_ = (index + 1) % num_slots;
+      return;
+    }
+  }
+
+  // CC messages sent so far
+  uint32_t messages() const {
+    return messages_;
+  }
+
+private:
+  static constexpr uint16_t kNothingSent = 0xffff;
+
+  struct Slot {
+    uint8_t channel;
+    uint8_t number;
+    MIDIControlResolution resolution;
+    bool enabled;
+    uint16_t value;
+    uint16_t countdown;
+    uint16_t sent;
+  };
+
+  Slot slots_[num_slots];
+  uint16_t nrpn_[16]; // selected NRPN per channel
+  uint16_t interval_;
+  size_t next_;
+  uint32_t messages_;
+
+  static bool changed(const Slot &slot) {
+    if (slot.sent == kNothingSent) return true;
+    if (slot.resolution == MIDI_CC_7BIT) return (slot.value >> 7) != (slot.sent >> 7);
+    return slot.value != slot.sent;
+  }
+
+  template <typename SEND>
+  void SendSlot(Slot &slot, SEND &send) {
+    const uint8_t msb = slot.value >> 7;
+    const uint8_t lsb = slot.value & 0x7f;
+    const bool msb_changed = slot.sent == kNothingSent || msb != (slot.sent >> 7);
+
+    switch (slot.resolution) {
+      case MIDI_CC_7BIT:
+        send(slot.channel, slot.number, msb);
+        ++messages_;
+        break;
+
+      case MIDI_CC_14BIT:
+        // Receivers clear the LSB when the MSB arrives, so it always follows
+        if (msb_changed) {
+          send(slot.channel, slot.number, msb);
+          ++messages_;
+        }
+        send(slot.channel, uint8_t(slot.number + 32), lsb);
+        ++messages_;
+        break;
+
+      case MIDI_CC_NRPN: {
+        bool reselected = false;
+        if (nrpn_[slot.channel] != slot.number) {
+          send(slot.channel, uint8_t(99), uint8_t(0));
+          send(slot.channel, uint8_t(98), slot.number);
+          messages_ += 2;
+          nrpn_[slot.channel] = slot.number;
+          reselected = true;
+        }
+        if (msb_changed || reselected) {
+          send(slot.channel, uint8_t(6), msb);
+          ++messages_;
+        }
+        send(slot.channel, uint8_t(38), lsb);
+        ++messages_;
+        break;
+      }
+
+      default: break;
+    }
+    slot.sent = slot.value;
+  }
+};
+
+template <size_t num_slots>
+constexpr uint16_t MIDIControlScheduler<num_slots>::kNothingSent;
+
+} // namespace util
+
+#endif // UTIL_MIDI_CC_SCHEDULER_H_
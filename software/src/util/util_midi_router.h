@@ -0,0 +1,285 @@
+#ifndef UTIL_MIDI_ROUTER_H_
+#define UTIL_MIDI_ROUTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace util {
+
+// A channel or system message as it goes out on the wire; SysEx isn't routed
+struct MIDIMessage {
+  uint8_t status; // including the channel for channel messages
+  uint8_t data1;
+  uint8_t data2;
+
+  bool is_channel() const { return status < 0xf0; }
+  bool is_realtime() const { return status >= 0xf8; }
+  uint8_t channel() const { return status & 0x0f; } // 0-15
+
+  // Bytes on the wire, including the status byte
+  uint8_t length() const {
+    switch (status & 0xf0) {
+      case 0xc0: case 0xd0: return 2;
+      case 0xf0:
+        if (status == 0xf2) return 3;
+        if (status == 0xf1 || status == 0xf3) return 2;
+        return 1;
+      default: return 3;
+    }
+  }
+};
+
+// Message classes for MIDIRoute::types
+enum MIDIRouteTypes : uint8_t {
+  MIDI_ROUTE_NOTE       = 1 << 0, // note on/off, poly aftertouch
+  MIDI_ROUTE_CC         = 1 << 1,
+  MIDI_ROUTE_PROGRAM    = 1 << 2,
+  MIDI_ROUTE_AFTERTOUCH = 1 << 3, // channel pressure
+  MIDI_ROUTE_PITCHBEND  = 1 << 4,
+  MIDI_ROUTE_CLOCK      = 1 << 5,
+  MIDI_ROUTE_TRANSPORT  = 1 << 6, // start/continue/stop, song position/select
+  MIDI_ROUTE_SYSTEM     = 1 << 7, // MTC, tune request, active sensing, reset
+  MIDI_ROUTE_NONE       = 0,
+  MIDI_ROUTE_ALL        = 0xff,
+};
+
+inline uint8_t MIDIRouteType(uint8_t status) {
+  switch (status & 0xf0) {
+    case 0x80: case 0x90: case 0xa0: return MIDI_ROUTE_NOTE;
+    case 0xb0: return MIDI_ROUTE_CC;
+    case 0xc0: return MIDI_ROUTE_PROGRAM;
+    case 0xd0: return MIDI_ROUTE_AFTERTOUCH;
+    case 0xe0: return MIDI_ROUTE_PITCHBEND;
+    default: break;
+  }
+  switch (status) {
+    case 0xf8: return MIDI_ROUTE_CLOCK;
+    case 0xf2: case 0xf3: case 0xfa: case 0xfb: case 0xfc: return MIDI_ROUTE_TRANSPORT;
+    default: return MIDI_ROUTE_SYSTEM;
+  }
+}
+
+// Filter for one source -> destination connection
+struct MIDIRoute {
+  uint8_t types;     // MIDIRouteTypes
+  uint16_t channels; // bit n for channel n + 1; system messages ignore it
+
+  bool Passes(const MIDIMessage &message) const {
+    if (!(types & MIDIRouteType(message.status))) return false;
+    return !message.is_channel() || ((channels >> message.channel()) & 1);
+  }
+};
+
+struct MIDIPortStats {
+  uint32_t sent;
+  uint32_t filtered;         // blocked by the route
+  uint32_t dropped;          // queue full
+  uint32_t coalesced;        // replaced by a newer value before going out
+  uint32_t running_status;   // status bytes saved on byte streams
+};
+
+/**
+ * Routes MIDI between ports through a matrix of per-connection filters, with
+ * a transmit queue per output port.
+ *
+ * Everything here runs in loop(): Route() queues a message for each output
+ * whose route from the source lets it through (never back to the source),
+ * and the Drain functions hand queued messages to the devices only as fast
+ * as they take them, so a slow DIN port delays its own messages instead of
+ * stalling loop() or the other ports. Sends from the ISR need to be handed
+ * to loop() first, e.g. through an SPSCQueue.
+ *
+ * Ports [0, num_outputs) have a transmit queue; ports above that can be
+ * sources, or destinations the caller checks itself with Passes().
+ *
+ * Realtime messages (clock, transport) have their own small queue and jump
+ * ahead of everything else, so dense traffic doesn't skew the clock. Pitch
+ * bend and channel pressure are continuous, so a newer value replaces one
+ * still queued, as long as nothing else on that channel is queued after it.
+ *
+ * DrainBytes() writes raw bytes with running status: the status byte is
+ * left out when it's the same as the last one, but only while messages go
+ * out back to back; once the queue runs dry the next message sends its
+ * status again, so a receiver that missed it (e.g. plugged in late) resyncs.
+ */
+template <int num_ports, int num_outputs, size_t queue_size>
+class MIDIRouter {
+public:
+  static constexpr size_t kRealtimeQueueSize = 8;
+
+  void Init() {
+    for (int src = 0; src < num_ports; ++src) {
+      for (int dst = 0; dst < num_ports; ++dst) {
+        routes_[src][dst].types = src == dst ? MIDI_ROUTE_NONE : MIDI_ROUTE_ALL;
+        routes_[src][dst].channels = 0xffff;
+      }
+    }
+    for (int port = 0; port < num_outputs; ++port) {
+      ClearQueue(port);
+      stats_[port] = MIDIPortStats();
+    }
+  }
+
+  MIDIRoute &route(int src, int dst) {
+    return routes_[src][dst];
+  }
+
+  bool Passes(int src, int dst, const MIDIMessage &message) const {
+    return routes_[src][dst].Passes(message);
+  }
+
+  // Queue message for every output its route from src lets through
+  void Route(int src, const MIDIMessage &message) {
+    for (int dst = 0; dst < num_outputs; ++dst) {
+      if (dst == src) continue;
+      if (routes_[src][dst].Passes(message))
+        Queue(dst, message);
+      else
+        ++stats_[dst].filtered;
+    }
+  }
+
+  // Queue message for one output, bypassing the routes
+  void Queue(int port, const MIDIMessage &message) {
+    Port &p = ports_[port];
+    MIDIPortStats &stats = stats_[port];
+
+    if (message.is_realtime()) {
+      if (p.realtime_write - p.realtime_read >= kRealtimeQueueSize)
+        ++stats.dropped;
+      else
+        p.realtime[p.realtime_write++ % kRealtimeQueueSize] = message;
+      return;
+    }
+
+    const uint8_t type = message.status & 0xf0;
+    if (type == 0xe0 || type == 0xd0) {
+      // The newest queued message on the same channel, if it's the same kind
+      for (size_t i = p.write; i != p.read; --i) {
+        MIDIMessage &queued = p.queue[(i - 1) % queue_size];
+        if (!queued.is_channel() || queued.channel() != message.channel()) continue;
+        if (queued.status == message.status) {
+          queued = message;
+          ++stats.coalesced;
+          return;
+        }
+        break;
+      }
+    }
+
+    if (p.write - p.read >= queue_size) {
+      ++stats.dropped;
+      return;
+    }
+    p.queue[p.write++ % queue_size] = message;
+  }
+
+  // Messages waiting for port
+  size_t pending(int port) const {
+    const Port &p = ports_[port];
+    return (p.write - p.read) + (p.realtime_write - p.realtime_read);
+  }
+
+  // Drop everything queued for port, e.g. if the device went away
+  void ClearQueue(int port) {
+    Port &p = ports_[port];
+    p.read = p.write = 0;
+    p.realtime_read = p.realtime_write = 0;
+    p.running_status = 0;
+  }
+
+  /**
+   * Hand up to max_messages queued messages to a message-based device (USB).
+   * SEND is called as bool send(const MIDIMessage &) and returns false if the
+   * device can't take it right now; it's tried again next time.
+   */
+  template <typename SEND>
+  void Drain(int port, SEND &&send, size_t max_messages) {
+    Port &p = ports_[port];
+    MIDIMessage message;
+    while (max_messages-- && Peek(p, message)) {
+      if (!send(message)) break;
+      Pop(p);
+      ++stats_[port].sent;
+    }
+  }
+
+  /**
+   * Write queued messages to a byte stream (DIN serial) with running status,
+   * only as long as SERIAL has room for the whole message.
+   * SERIAL follows the Arduino Print interface: availableForWrite() and
+   * write(const uint8_t *, size_t).
+   */
+  template <typename SERIAL>
+  void DrainBytes(int port, SERIAL &serial) {
+    Port &p = ports_[port];
+    MIDIMessage message;
+    while (Peek(p, message)) {
+      uint8_t bytes[3] = { message.status, message.data1, message.data2 };
+      const uint8_t *start = bytes;
+      size_t length = message.length();
+
+      if (message.is_channel() && message.status == p.running_status) {
+        ++start;
+        --length;
+      }
+      if (size_t(serial.availableForWrite()) < length) return;
+      serial.write(start, length);
+      Pop(p);
+
+      if (start != bytes)
+        ++stats_[port].running_status;
+      // Realtime messages can go between the others; system common ends
+      // the running status
+      if (!message.is_realtime())
+        p.running_status = message.is_channel() ? message.status : 0;
+      ++stats_[port].sent;
+    }
+    p.running_status = 0;
+  }
+
+  const MIDIPortStats &stats(int port) const {
+    return stats_[port];
+  }
+
+private:
+  static_assert(queue_size && !(queue_size & (queue_size - 1)), "queue_size must be pow2");
+
+  struct Port {
+    MIDIMessage queue[queue_size];
+    MIDIMessage realtime[kRealtimeQueueSize];
+    size_t read, write;
+    size_t realtime_read, realtime_write;
+    uint8_t running_status;
+  };
+
+  MIDIRoute routes_[num_ports][num_ports];
+  Port ports_[num_outputs];
+  MIDIPortStats stats_[num_outputs];
+
+  static bool Peek(const Port &p, MIDIMessage &message) {
+    if (p.realtime_read != p.realtime_write) {
+      message = p.realtime[p.realtime_read % kRealtimeQueueSize];
+      return true;
+    }
+    if (p.read != p.write) {
+      message = p.queue[p.read % queue_size];
+      return true;
+    }
+    return false;
+  }
+
+  static void Pop(Port &p) {
+    if (p.realtime_read != p.realtime_write)
+      ++p.realtime_read;
+    else
+      ++p.read;
+  }
+};
+
+template <int num_ports, int num_outputs, size_t queue_size>
+constexpr size_t MIDIRouter<num_ports, num_outputs, queue_size>::kRealtimeQueueSize;
+
+} // namespace util
+
+#endif // UTIL_MIDI_ROUTER_H_
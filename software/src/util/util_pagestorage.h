@@ -58,6 +58,12 @@ enum EStorageMode {
  * The optional FASTSCAN parameter to can be used for force a scan of all pages
  * during ::load. If it is true, the scan stops at the first non-good page,
  * which is faster but might miss pages if a write is corrupted.
+ *
+ * ::Save writes the page in one go, which on EEPROM takes long enough to be
+ * noticeable. Alternatively ::BeginSave only copies the data into the page
+ * buffer, and ::Poll writes it out a few bytes at a time, e.g. from loop().
+ * Data goes first and the header last, so an interrupted write leaves a page
+ * that fails the checks and the previous generation is loaded instead.
  */
 template <typename STORAGE, size_t BASE_ADDR, size_t END_ADDR, typename DATA_TYPE, EStorageMode MODE = STORAGE_UPDATE, bool FASTSCAN=true>
 class PageStorage {
@@ -102,6 +108,9 @@ public:
    */
   void Init() {
     page_index_ = -1;
+    write_pos_ = PAGESIZE;
+    memset(&page_, 0, sizeof(page_));
+    page_.header.generation = -1; // same as after an unsuccessful ::Load
     page_.header.fourcc = DATA_TYPE::FOURCC;
     page_.header.size = sizeof(DATA_TYPE);
   }
@@ -115,6 +124,7 @@ public:
   bool Load(DATA_TYPE &data) {
 
     page_index_ = -1;
+    write_pos_ = PAGESIZE;
     memset(&page_, 0, sizeof(page_));
     page_.header.generation = -1;
     page_data next_page;
@@ -159,6 +169,19 @@ public:
    * @return true if data was written to storage
    */
   bool Save(const DATA_TYPE &data) {
+    const bool dirty = BeginSave(data);
+    Poll(PAGESIZE);
+    return dirty;
+  }
+
+  /**
+   * Copy data to the page buffer to be written by ::Poll; the caller's copy
+   * is free to change again as soon as this returns. Saving again before the
+   * write is done restarts it, in the same page.
+   * @param data data to be stored
+   * @return true if data differs from the last saved
+   */
+  bool BeginSave(const DATA_TYPE &data) {
 
     bool dirty = false;
     const uint8_t *src = (const uint8_t*)&data;
@@ -176,20 +199,58 @@ public:
     if (dirty) {
       ++page_.header.generation;
       page_.header.checksum = checksum(page_);
-      page_index_ = (page_index_ + 1) % PAGES;
+      if (!busy())
+        page_index_ = (page_index_ + 1) % PAGES;
+      write_pos_ = 0;
+    }
+
+    return dirty;
+  }
 
+  /**
+   * Write up to max_bytes of a save started with ::BeginSave
+   * @return true if there's more to write
+   */
+  bool Poll(size_t max_bytes) {
+    static const size_t DATA_LENGTH = PAGESIZE - sizeof(page_header);
+
+    while (max_bytes && busy()) {
+      // Data first, then the header
+      size_t offset, length;
+      if (write_pos_ < DATA_LENGTH) {
+        offset = sizeof(page_header) + write_pos_;
+        length = DATA_LENGTH - write_pos_;
+      } else {
+        offset = write_pos_ - DATA_LENGTH;
+        length = sizeof(page_header) - offset;
+      }
+      if (length > max_bytes)
+        length = max_bytes;
+
+      const uint8_t *src = (const uint8_t *)&page_ + offset;
       if (STORAGE_UPDATE == MODE)
-        STORAGE::update(BASE_ADDR + page_index_ * PAGESIZE, &page_, sizeof(page_));
+        STORAGE::update(BASE_ADDR + page_index_ * PAGESIZE + offset, src, length);
       else
-        STORAGE::write(BASE_ADDR + page_index_ * PAGESIZE, &page_, sizeof(page_));
+        STORAGE::write(BASE_ADDR + page_index_ * PAGESIZE + offset, src, length);
+
+      write_pos_ += length;
+      max_bytes -= length;
     }
 
-    return dirty;
+    return busy();
+  }
+
+  /**
+   * @return true while a save is being written
+   */
+  bool busy() const {
+    return write_pos_ < PAGESIZE;
   }
 
 protected:
 
   int page_index_;
+  size_t write_pos_; // bytes of page_ written, PAGESIZE if done
   page_data page_;
 
   static uint16_t checksum(const page_data &page) {
@@ -73,11 +73,18 @@ struct AveragedCycles {
     return max_;
   }
 
+  // Restart min/max; the average carries on
   void Reset() {
     min_ = 0xffffffff;
     max_ = 0;
   }
 
+  // Forget everything, e.g. when something else is being measured
+  void Clear() {
+    value_ = 0;
+    Reset();
+  }
+
   void push(uint32_t value) {
     if (value < min_) min_ = value;
     if (value > max_) max_ = value;
@@ -0,0 +1,73 @@
+#ifndef UTIL_SPSC_QUEUE_H_
+#define UTIL_SPSC_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "util_macros.h"
+
+namespace util {
+
+// Lock-free single-producer/single-consumer queue, e.g. loop() -> ISR.
+//
+// Unlike RingBuffer, the indices are published with release/acquire
+// ordering, so the consumer never sees an index before the item it covers,
+// whatever the compiler (or a host CPU in the tests) reorders. On Cortex-M
+// these are plain loads and stores plus a barrier; nothing ever blocks or
+// disables interrupts.
+// - Push() only from the producer, Pop()/Flush() only from the consumer
+// - size must be pow2
+//
+template <typename T, size_t size>
+class SPSCQueue {
+public:
+  SPSCQueue() { Init(); }
+
+  void Init() {
+    write_ptr_ = read_ptr_ = 0;
+  }
+
+  inline size_t readable() const {
+    return __atomic_load_n(&write_ptr_, __ATOMIC_ACQUIRE) - __atomic_load_n(&read_ptr_, __ATOMIC_ACQUIRE);
+  }
+
+  inline size_t writable() const {
+    return size - readable();
+  }
+
+  // @return false if the queue is full; the item is dropped
+  inline bool Push(const T &value) {
+    const size_t write_ptr = __atomic_load_n(&write_ptr_, __ATOMIC_RELAXED);
+    if (write_ptr - __atomic_load_n(&read_ptr_, __ATOMIC_ACQUIRE) >= size)
+      return false;
+    buffer_[write_ptr & (size - 1)] = value;
+    __atomic_store_n(&write_ptr_, write_ptr + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  inline bool Pop(T &value) {
+    const size_t read_ptr = __atomic_load_n(&read_ptr_, __ATOMIC_RELAXED);
+    if (read_ptr == __atomic_load_n(&write_ptr_, __ATOMIC_ACQUIRE))
+      return false;
+    value = buffer_[read_ptr & (size - 1)];
+    __atomic_store_n(&read_ptr_, read_ptr + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Drop everything that's been pushed so far
+  inline void Flush() {
+    __atomic_store_n(&read_ptr_, __atomic_load_n(&write_ptr_, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+  }
+
+private:
+  static_assert(size && !(size & (size - 1)), "size must be pow2");
+
+  T buffer_[size];
+  size_t write_ptr_;
+  size_t read_ptr_;
+
+  DISALLOW_COPY_AND_ASSIGN(SPSCQueue);
+};
+
+};
+
+#endif // UTIL_SPSC_QUEUE_H_
@@ -52,6 +52,12 @@ DMAMEM VOSegment user_waveforms[VO_SEGMENT_COUNT];
 
 }; // namespace HS
 
+// Compiled phase tables (see VectorOscillator::Compile) cost about 150 bytes per oscillator,
+// which the T3.2's applet pool can't spare; there the segments are always walked
+#if defined(__IMXRT1062__) && !defined(VECTOR_OSC_COMPILED)
+#define VECTOR_OSC_COMPILED
+#endif
+
 #define int2signal(x) (x << 10)
 #define signal2int(x) (x >> 10)
 typedef int32_t vosignal_t;
@@ -73,6 +79,18 @@ public:
     /* Oscillator defaults to non-sustaining. Turing on for EGs, etc. */
     void Sustain(bool sustain_ = 1) {sustain = sustain_;}
 
+    /* Render the segments into a phase table, so that Next() and Phase() just advance a phase
+     * accumulator and interpolate, instead of walking the segments: constant cost per tick, and
+     * no divisions outside of SetSegment() and SetScale(), which keep the table up to date.
+     * Sustaining oscillators (EGs) still walk the segments, since release starts from wherever
+     * the signal is. Does nothing without VECTOR_OSC_COMPILED. */
+    void Compile(bool compiled_ = 1) {
+#ifdef VECTOR_OSC_COMPILED
+        compiled = compiled_;
+        Render();
+#endif
+    }
+
     /* Move to the release stage after sustain */
     void Release() {
         sustained = 0;
@@ -90,6 +108,7 @@ public:
             memcpy(&segments[segment_count], &segment, sizeof(segments[segment_count]));
             total_time += segments[segment_count].time;
             segment_count++;
+            Render();
         }
     }
 
@@ -100,6 +119,7 @@ public:
         memcpy(&segments[ix], &segment, sizeof(segments[ix]));
         total_time += segments[ix].time;
         if (ix == segment_count) segment_count++;
+        Render();
     }
 
     HS::VOSegment GetSegment(byte ix) {
@@ -107,12 +127,20 @@ public:
         return segments[ix];
     }
 
-    void SetScale(uint16_t scale_) {scale = scale_;}
+    void SetScale(uint16_t scale_) {
+        scale = scale_;
+        Render();
+    }
 
     /* frequency is centihertz (e.g., 440 Hz is 44000) */
     void SetFrequency(uint32_t frequency_) {
         if (frequency_ != frequency) {
             frequency = frequency_;
+#ifdef VECTOR_OSC_COMPILED
+            // 2^32 / 1666667, the phase per tick for 1 centihertz, in Q16
+            phase_increment = (static_cast<uint64_t>(frequency) * 168884983) >> 16;
+            if (use_table()) return;
+#endif
             rise = calculate_rise(segment_index);
         }
     }
@@ -130,10 +158,17 @@ public:
 
     void Reset() {
         segment_index = 0;
-        signal = scale_level(segments[segment_count - 1].level);
-        rise = calculate_rise(segment_index);
         sustained = 0;
         eoc = !cycle;
+#ifdef VECTOR_OSC_COMPILED
+        phase = 0;
+        if (use_table()) {
+            signal = table_level[0];
+            return;
+        }
+#endif
+        signal = scale_level(segments[segment_count - 1].level);
+        rise = calculate_rise(segment_index);
     }
 
     int32_t Next() {
@@ -142,6 +177,9 @@ public:
     			vosignal_t nr_signal = scale_level(segments[segment_count - 1].level);
     			return signal2int(nr_signal) + offset;
     		}
+#ifdef VECTOR_OSC_COMPILED
+        if (use_table()) return NextFromTable();
+#endif
         if (!sustained) { // Observe sustain state
 			eoc = 0;
 			if (validate()) {
@@ -164,6 +202,14 @@ public:
     int32_t Phase(int degrees) {
     		degrees = degrees % 3600;
     		degrees = abs(degrees);
+#ifdef VECTOR_OSC_COMPILED
+    		if (use_table()) {
+    			const uint32_t p = static_cast<uint32_t>(degrees) * 1193046; // 2^32 / 3600
+    			byte ix = 0;
+    			while (ix + 1 < table_count && p >= table_start[ix + 1]) ix++;
+    			return signal2int(table_value(ix, p)) + offset;
+    		}
+#endif
 
     		// I need to find out which segment the specified phase occurs in
     		byte time_index = Proportion(degrees, 3600, total_time);
@@ -200,15 +246,86 @@ private:
     vosignal_t target = 0; // Target scaled signal. When the target is reached, the Oscillator moves to the next segment.
     bool eoc = 1; // The most recent tick's next() read was the end of a cycle
     byte segment_index = 0; // Which segment the Oscillator is currently traversing
-    vosignal_t rise; // The amount (per tick) the signal must rise to reach the target
-    uint32_t frequency; // In centihertz
+    vosignal_t rise = 0; // The amount (per tick) the signal must rise to reach the target
+    uint32_t frequency = 0; // In centihertz
     uint16_t scale; // The maximum (and minimum negative) output for this Oscillator
-    uint32_t countdown; // Ticks left for a segment with a rise of 0
+    uint32_t countdown = 0; // Ticks left for a segment with a rise of 0
     bool cycle = 1; // Waveform will cycle
     int32_t offset = 0; // Amount added to each voltage output (e.g., to make it unipolar)
     bool sustain = 0; // Waveform stops when it reaches the end of the penultimate stage
     bool sustained = 0; // Current state of sustain. Only active when sustain = 1
 
+#ifdef VECTOR_OSC_COMPILED
+    // Compiled mode, see Compile()
+    static constexpr int TABLE_SHIFT = 22; // Within one output unit over a whole cycle
+    bool compiled = 0;
+    uint32_t phase = 0; // Position in the cycle, 2^32 is one cycle
+    uint32_t phase_increment = 0; // Per tick, from the frequency
+    byte table_count = 0; // Segments in the table; 0 if not compiled or it can't be
+    uint32_t table_start[12]; // Phase at which each segment starts
+    vosignal_t table_level[12]; // Signal at the start of each segment
+    int32_t table_slope[12]; // Signal change per phase, << TABLE_SHIFT
+
+    bool use_table() {return table_count && !sustain;}
+
+    vosignal_t table_value(byte ix, uint32_t p) {
+        return table_level[ix] + static_cast<vosignal_t>((static_cast<int64_t>(p - table_start[ix]) * table_slope[ix]) >> TABLE_SHIFT);
+    }
+
+    int32_t NextFromTable() {
+        eoc = 0;
+        if (validate()) {
+            const uint32_t previous = phase;
+            phase += phase_increment;
+            if (phase < previous) { // Past the end of the last segment
+                eoc = 1;
+                segment_index = 0;
+                if (!cycle) {
+                    signal = scale_level(segments[segment_count - 1].level);
+                    return signal2int(signal) + offset;
+                }
+            }
+            while (segment_index + 1 < table_count && phase >= table_start[segment_index + 1]) segment_index++;
+            signal = table_value(segment_index, phase);
+        }
+        return signal2int(signal) + offset;
+    }
+
+    /* Segment ix goes from the level of the one before it to its own level over time / total_time
+     * of the cycle; this is calculate_rise() with the segment's ticks as a span of phase instead.
+     * Zero-time segments have an empty span and get stepped over. Slopes that don't fit (scales far
+     * beyond the outputs' range) leave the oscillator walking the segments. */
+    void Render() {
+        table_count = 0;
+        if (!compiled || segment_count < 2 || total_time == 0) return;
+
+        // Zero-time segments at the end would start at 2^32
+        byte count = segment_count;
+        while (segments[count - 1].time == 0) count--;
+
+        uint32_t time = 0;
+        for (byte ix = 0; ix < count; ix++)
+        {
+            table_start[ix] = (static_cast<uint64_t>(time) << 32) / total_time;
+            time += segments[ix].time;
+        }
+        for (byte ix = 0; ix < count; ix++)
+        {
+            const vosignal_t start = scale_level(segments[ix == 0 ? segment_count - 1 : ix - 1].level);
+            const vosignal_t end = scale_level(segments[ix].level);
+            const int64_t span = (ix + 1 < count ? static_cast<int64_t>(table_start[ix + 1]) : (1LL << 32)) - table_start[ix];
+            const int64_t slope = span ? (static_cast<int64_t>(end - start) << TABLE_SHIFT) / span : 0;
+            if (slope > INT32_MAX || slope < INT32_MIN) return;
+            table_level[ix] = start;
+            table_slope[ix] = slope;
+        }
+        table_count = count;
+        if (segment_index >= table_count) segment_index = 0;
+    }
+#else
+    void Render() { }
+#endif
+
     /*
      * The Oscillator can only oscillate if the following conditions are true:
      *     (1) The frequency must be greater than 0
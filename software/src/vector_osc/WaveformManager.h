@@ -82,6 +82,7 @@ public:
         return (64 - segment_count);
     }
 
+    /* Oscillators come compiled; see VectorOscillator::Compile() */
     VectorOscillator static VectorOscillatorFromWaveform(byte waveform_number) {
         VectorOscillator osc;
         if (waveform_number >= 32) { // Library waveforms start at 32
@@ -102,6 +103,7 @@ public:
                 }
             }
         }
+        osc.Compile();
         return osc;
     }
 
@@ -123,6 +125,7 @@ public:
                 count++;
             }
         }
+        osc.Compile();
         return osc;
     }
 
@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+#include "HSAppletScheduler.h"
+
+// Quadrants on T4.1: 4 trigger inputs, 8 CV inputs, 8 outputs
+static const int kTrigOut = 4 + 8;
+static const int kCVOut = 8;
+typedef HS::AppletScheduler<4, kTrigOut, kCVOut> Scheduler;
+
+// mapping values for output channel n (0-based)
+static int trig_from(int output) { return kTrigOut + 1 + output; }
+static int cv_from(int output) { return kCVOut + 1 + output; }
+
+static void ExpectOrder(const uint8_t *order, std::initializer_list<int> expected) {
+  int i = 0;
+  for (int slot : expected) {
+    EXPECT_EQ(slot, order[i]) << "position " << i;
+    ++i;
+  }
+}
+
+TEST(AppletSchedulerTest, DefaultMappingKeepsSlotOrder) {
+  Scheduler scheduler;
+  const int trigmap[8] = { 1, 2, 3, 4, 1, 2, 3, 4 };
+  const int cvmap[8] = { 5, 6, 7, 8, 5, 6, 7, 8 };
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 0, 1, 2, 3 });
+  EXPECT_EQ(0, scheduler.cycle_mask());
+}
+
+TEST(AppletSchedulerTest, ReversedChain) {
+  // 3 -> 2 -> 1 -> 0, through a mix of trigger and CV mappings
+  Scheduler scheduler;
+  int trigmap[8] = { 1, 2, 3, 4, 1, 2, 3, 4 };
+  int cvmap[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  trigmap[0] = trig_from(2); // slot 0 clocked by output C (slot 1)
+  cvmap[3] = cv_from(5); // slot 1 reads output F (slot 2)
+  cvmap[4] = cv_from(6); // slot 2 reads output G (slot 3)
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 3, 2, 1, 0 });
+  EXPECT_EQ(0, scheduler.cycle_mask());
+  EXPECT_EQ(1 << 1, scheduler.depends_on(0));
+  EXPECT_EQ(0, scheduler.depends_on(3));
+}
+
+TEST(AppletSchedulerTest, SelfFeedbackIgnored) {
+  Scheduler scheduler;
+  const int trigmap[8] = { trig_from(1), 0, 0, 0, 0, 0, 0, 0 };
+  const int cvmap[8] = { cv_from(0), 0, 0, 0, 0, 0, 0, 0 };
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 0, 1, 2, 3 });
+  EXPECT_EQ(0, scheduler.depends_on(0));
+  EXPECT_EQ(0, scheduler.cycle_mask());
+}
+
+TEST(AppletSchedulerTest, CycleBrokenAtLowestSlot) {
+  // 1 -> 2 -> 3 -> 1, and 0 fed by 3
+  Scheduler scheduler;
+  int trigmap[8] = { 0 };
+  int cvmap[8] = { 0 };
+  cvmap[2] = cv_from(6); // slot 1 <- slot 3
+  cvmap[4] = cv_from(2); // slot 2 <- slot 1
+  trigmap[7] = trig_from(5); // slot 3 <- slot 2
+  cvmap[1] = cv_from(7); // slot 0 <- slot 3
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 1, 2, 3, 0 });
+  EXPECT_EQ(1 << 1, scheduler.cycle_mask());
+
+  // same graph, same answer
+  scheduler.Invalidate();
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 1, 2, 3, 0 });
+}
+
+TEST(AppletSchedulerTest, RebuildsOnMappingChange) {
+  Scheduler scheduler;
+  int trigmap[8] = { 0 };
+  int cvmap[8] = { 0 };
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 0, 1, 2, 3 });
+  cvmap[0] = cv_from(7); // slot 0 <- slot 3
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 1, 2, 3, 0 });
+  cvmap[0] = 0;
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 0, 1, 2, 3 });
+}
+
+TEST(AppletSchedulerTest, UnownedOutputsIgnored) {
+  // Hemisphere on T4.1 has two slots; outputs E-H aren't driven by applets
+  HS::AppletScheduler<2, kTrigOut, kCVOut> scheduler;
+  const int trigmap[4] = { trig_from(4), 0, 0, 0 };
+  const int cvmap[4] = { cv_from(7), 0, 0, 0 };
+  ExpectOrder(scheduler.Update(trigmap, cvmap), { 0, 1 });
+  EXPECT_EQ(0, scheduler.depends_on(0));
+}
+
+typedef HS::ControlRateScheduler<4, 16> RateScheduler;
+
+TEST(ControlRateSchedulerTest, FullRateSlotsAlwaysDue) {
+  RateScheduler scheduler;
+  for (int t = 0; t < 40; ++t) EXPECT_EQ(0xf, scheduler.Update(0));
+}
+
+TEST(ControlRateSchedulerTest, SlowSlotsStaggered) {
+  // slots 1 and 3 slow: each due once per interval, half an interval apart
+  RateScheduler scheduler;
+  int runs[4] = { 0 };
+  int last[4] = { -1, -1, -1, -1 };
+  for (int t = 0; t < 16 * 10; ++t) {
+    const uint8_t due = scheduler.Update(0xa);
+    EXPECT_EQ(0x5, due & 0x5);
+    EXPECT_NE(0xa, due & 0xa) << t;
+    for (int slot = 1; slot < 4; slot += 2) {
+      if (!(due & (1 << slot))) continue;
+      if (last[slot] >= 0) {
+        EXPECT_EQ(16, t - last[slot]);
+      }
+      last[slot] = t;
+      ++runs[slot];
+    }
+  }
+  EXPECT_EQ(10, runs[1]);
+  EXPECT_EQ(10, runs[3]);
+  EXPECT_EQ(8, (last[3] - last[1] + 16) % 16);
+}
+
+TEST(ControlRateSchedulerTest, EvenSpreadOfAllSlots) {
+  RateScheduler scheduler;
+  int per_tick[16] = { 0 };
+  for (int t = 0; t < 16; ++t) {
+    const uint8_t due = scheduler.Update(0xf);
+    per_tick[t] = __builtin_popcount(due);
+  }
+  int busy = 0;
+  for (int n : per_tick) {
+    EXPECT_LE(n, 1);
+    busy += n;
+  }
+  EXPECT_EQ(4, busy);
+  EXPECT_EQ(0, scheduler.phase(0));
+  EXPECT_EQ(4, scheduler.phase(1));
+  EXPECT_EQ(8, scheduler.phase(2));
+  EXPECT_EQ(12, scheduler.phase(3));
+}
+
+TEST(ControlRateSchedulerTest, RespreadsOnChange) {
+  RateScheduler scheduler;
+  scheduler.Update(0x3);
+  EXPECT_EQ(0, scheduler.phase(0));
+  EXPECT_EQ(8, scheduler.phase(1));
+
+  // slot 0 back to full rate: slot 1 keeps running once per interval
+  int runs = 0;
+  for (int t = 0; t < 32; ++t) {
+    const uint8_t due = scheduler.Update(0x2);
+    EXPECT_TRUE(due & 1);
+    runs += (due >> 1) & 1;
+  }
+  EXPECT_EQ(2, runs);
+  EXPECT_EQ(0, scheduler.phase(1));
+}
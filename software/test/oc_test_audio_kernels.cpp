@@ -0,0 +1,188 @@
+#include <chrono>
+#include <stdio.h>
+#include "gtest/gtest.h"
+#include "AudioKernels.h"
+
+using namespace OC::AudioDSP;
+
+static const int kBlocks = 256;
+static const int kSamples = kBlocks * KERNEL_BLOCK_SIZE;
+
+static uint32_t test_random(uint32_t &state) {
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+// Full-scale noise with the occasional run at the rails
+static void test_signal(int16_t *left, int16_t *right, uint32_t seed) {
+  uint32_t state = seed;
+  for (int i = 0; i < kSamples; ++i) {
+    const uint32_t r = test_random(state);
+    left[i] = (r & 0x10000) ? 32767 : (int16_t)r;
+    right[i] = (r & 0x20000) ? -32768 : (int16_t)(r >> 4);
+  }
+}
+
+class AudioKernelsTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    test_signal(left_, right_, 1);
+    Interleave(left_, right_, frames_, kSamples);
+  }
+
+  void ExpectMatches() {
+    for (int i = 0; i < kSamples; ++i) {
+      ASSERT_EQ(left_[i], q15::lo(frames_[i])) << "left, sample " << i;
+      ASSERT_EQ(right_[i], q15::hi(frames_[i])) << "right, sample " << i;
+    }
+  }
+
+  int16_t left_[kSamples];
+  int16_t right_[kSamples];
+  uint32_t frames_[kSamples];
+};
+
+TEST(AudioKernelsPrimitivesTest, Saturation) {
+  const uint32_t a = q15::pack(32000, -32000);
+  const uint32_t b = q15::pack(1000, 1000);
+  EXPECT_EQ(32767, q15::hi(q15::add(a, b)));
+  EXPECT_EQ(-31000, q15::lo(q15::add(a, b)));
+  EXPECT_EQ(31000, q15::hi(q15::sub(a, b)));
+  EXPECT_EQ(-32768, q15::lo(q15::sub(a, q15::pack(0, 1000))));
+  EXPECT_EQ(32767, q15::hi(q15::mul<14>(q15::pack(32767, 0), q15::pack(32767, 0))));
+  EXPECT_EQ(3 * 5 + 7 * 11, q15::dot(q15::pack(3, 7), q15::pack(5, 11)));
+}
+
+TEST(AudioKernelsPrimitivesTest, Fold) {
+  for (int32_t x = -32768; x <= 32767; ++x)
+    ASSERT_EQ(x, Fold(x));
+  // reflects about the half-step beyond full scale
+  EXPECT_EQ(32767 - 99, Fold(32767 + 100));
+  EXPECT_EQ(-32768 + 99, Fold(-32768 - 100));
+  EXPECT_EQ(-32768 + 5, Fold(3 * 32768 + 5));
+}
+
+TEST_F(AudioKernelsTest, VCA) {
+  uint32_t state = 2;
+  VCAState vca = { q15::pack(32767, 0) };
+  int16_t gain[2] = { 0, 32767 };
+  for (int b = 0; b < kBlocks; ++b) {
+    // signed, so inverting gains and swings through zero are covered
+    const int16_t target[2] = { (int16_t)test_random(state), (int16_t)test_random(state) };
+    const int offset = b * KERNEL_BLOCK_SIZE;
+    VCABlock(frames_ + offset, KERNEL_BLOCK_SIZE, vca, q15::pack(target[1], target[0]));
+    VCABlock_Ref(left_ + offset, KERNEL_BLOCK_SIZE, gain[0], target[0]);
+    VCABlock_Ref(right_ + offset, KERNEL_BLOCK_SIZE, gain[1], target[1]);
+  }
+  ExpectMatches();
+}
+
+TEST_F(AudioKernelsTest, VCARampEndsOnTarget) {
+  // 1000 / 32 truncates to 31, which would leave the ramp 8 short; the last
+  // step takes up the remainder instead
+  for (int i = 0; i < KERNEL_BLOCK_SIZE; ++i)
+    frames_[i] = q15::pack(-32768, 32767);
+  VCAState vca = { 0 };
+  VCABlock(frames_, KERNEL_BLOCK_SIZE, vca, q15::pack(-1000, 1000));
+  for (int i = 1; i < KERNEL_BLOCK_SIZE; ++i) {
+    ASSERT_GE(q15::lo(frames_[i]), q15::lo(frames_[i - 1])) << "sample " << i;
+    ASSERT_LE(q15::lo(frames_[i]) - q15::lo(frames_[i - 1]), 31 + 8) << "sample " << i;
+  }
+  EXPECT_EQ((32767 * 1000) >> 15, q15::lo(frames_[KERNEL_BLOCK_SIZE - 1]));
+  EXPECT_EQ(1000, q15::hi(frames_[KERNEL_BLOCK_SIZE - 1]));
+  EXPECT_EQ(q15::pack(-1000, 1000), vca.gain);
+}
+
+TEST_F(AudioKernelsTest, SVF) {
+  for (int output = SVF_LOWPASS; output <= SVF_HIGHPASS; ++output) {
+    SetUp();
+    uint32_t state = 3;
+    SVFState svf = { 0, 0 };
+    int16_t lp[2] = { 0, 0 }, bp[2] = { 0, 0 };
+    for (int b = 0; b < kBlocks; ++b) {
+      // the full coefficient range, including unstable settings
+      const int16_t f[2] = { (int16_t)(test_random(state) & 0x7fff),
+                             (int16_t)(test_random(state) & 0x7fff) };
+      const int16_t q[2] = { (int16_t)(test_random(state) & 0x7fff),
+                             (int16_t)(test_random(state) & 0x7fff) };
+      const int offset = b * KERNEL_BLOCK_SIZE;
+      SVFBlock(frames_ + offset, KERNEL_BLOCK_SIZE, svf,
+               q15::pack(f[1], f[0]), q15::pack(q[1], q[0]), SVFOutput(output));
+      SVFBlock_Ref(left_ + offset, KERNEL_BLOCK_SIZE, lp[0], bp[0], f[0], q[0], SVFOutput(output));
+      SVFBlock_Ref(right_ + offset, KERNEL_BLOCK_SIZE, lp[1], bp[1], f[1], q[1], SVFOutput(output));
+    }
+    ExpectMatches();
+  }
+}
+
+TEST_F(AudioKernelsTest, SVFLowpass) {
+  // DC through a lowpass settles at the input level, less the truncation
+  // error of the 16-bit state
+  SVFState svf = { 0, 0 };
+  const int16_t f = 2000, q = 16384 / 1.05;
+  for (int i = 0; i < kSamples; ++i)
+    frames_[i] = q15::pack(-10000, 10000);
+  for (int b = 0; b < kBlocks; ++b)
+    SVFBlock(frames_ + b * KERNEL_BLOCK_SIZE, KERNEL_BLOCK_SIZE, svf,
+             q15::pack(f, f), q15::pack(q, q), SVF_LOWPASS);
+  EXPECT_NEAR(10000, q15::lo(frames_[kSamples - 1]), 64);
+  EXPECT_NEAR(-10000, q15::hi(frames_[kSamples - 1]), 64);
+}
+
+TEST_F(AudioKernelsTest, Wavefold) {
+  uint32_t state = 4;
+  for (int b = 0; b < kBlocks; ++b) {
+    const int16_t drive[2] = { (int16_t)(test_random(state) & 0x7fff),
+                               (int16_t)(test_random(state) & 0x7fff) };
+    const int16_t amount[2] = { (int16_t)(test_random(state) & 0x7fff),
+                                (int16_t)(test_random(state) & 0x7fff) };
+    const WavefoldParams params = {
+      q15::pack(drive[1], drive[0]), WavefoldMix(amount[0]), WavefoldMix(amount[1])
+    };
+    const int offset = b * KERNEL_BLOCK_SIZE;
+    WavefoldBlock(frames_ + offset, KERNEL_BLOCK_SIZE, params);
+    WavefoldBlock_Ref(left_ + offset, KERNEL_BLOCK_SIZE, drive[0], amount[0]);
+    WavefoldBlock_Ref(right_ + offset, KERNEL_BLOCK_SIZE, drive[1], amount[1]);
+  }
+  ExpectMatches();
+}
+
+TEST_F(AudioKernelsTest, Benchmark) {
+  static const int kIterations = 64;
+  const uint32_t f = q15::pack(8000, 6000), q = q15::pack(15604, 15604);
+  const WavefoldParams fold = { q15::pack(4 << 12, 4 << 12), WavefoldMix(16000), WavefoldMix(8000) };
+
+  VCAState vca = { 0 };
+  SVFState svf = { 0, 0 };
+  auto start = std::chrono::steady_clock::now();
+  for (int n = 0; n < kIterations; ++n) {
+    for (int i = 0; i < kSamples; i += KERNEL_BLOCK_SIZE) {
+      VCABlock(frames_ + i, KERNEL_BLOCK_SIZE, vca, q15::pack(30000 - n, 20000 + n));
+      SVFBlock(frames_ + i, KERNEL_BLOCK_SIZE, svf, f, q, SVF_LOWPASS);
+      WavefoldBlock(frames_ + i, KERNEL_BLOCK_SIZE, fold);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  const double packed = std::chrono::duration<double, std::nano>(end - start).count();
+
+  int16_t gain[2] = { 0, 0 }, lp[2] = { 0, 0 }, bp[2] = { 0, 0 };
+  start = std::chrono::steady_clock::now();
+  for (int n = 0; n < kIterations; ++n) {
+    for (int i = 0; i < kSamples; i += KERNEL_BLOCK_SIZE) {
+      VCABlock_Ref(left_ + i, KERNEL_BLOCK_SIZE, gain[0], 20000 + n);
+      VCABlock_Ref(right_ + i, KERNEL_BLOCK_SIZE, gain[1], 30000 - n);
+      SVFBlock_Ref(left_ + i, KERNEL_BLOCK_SIZE, lp[0], bp[0], 6000, 15604, SVF_LOWPASS);
+      SVFBlock_Ref(right_ + i, KERNEL_BLOCK_SIZE, lp[1], bp[1], 8000, 15604, SVF_LOWPASS);
+      WavefoldBlock_Ref(left_ + i, KERNEL_BLOCK_SIZE, 4 << 12, 16000);
+      WavefoldBlock_Ref(right_ + i, KERNEL_BLOCK_SIZE, 4 << 12, 8000);
+    }
+  }
+  end = std::chrono::steady_clock::now();
+  const double reference = std::chrono::duration<double, std::nano>(end - start).count();
+
+  ExpectMatches();
+  // On the host the packed path emulates the DSP instructions, so only the
+  // target numbers mean anything in absolute terms
+  printf("VCA+SVF+fold, 2 channels: packed %.2fns/frame, reference %.2fns/frame\n",
+         packed / (kIterations * kSamples), reference / (kIterations * kSamples));
+}
@@ -0,0 +1,328 @@
+#include <chrono>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "gtest/gtest.h"
+#include "peaks_bytebeat.h"
+
+using namespace peaks;
+
+// ByteBeat as it was, dispatching on the equation for every sample. Several
+// equations divide by zero for some t_ and parameters, which traps on the
+// host (the Cortex-M divide returns 0); the test skips those samples.
+struct ReferenceByteBeat {
+  uint16_t equation_;
+  uint16_t speed_;
+  uint16_t pitch_;
+  uint8_t p0_;
+  uint8_t p1_;
+  uint8_t p2_;
+  uint16_t last_sample_;
+  uint32_t t_;
+  uint32_t phase_;
+  uint32_t loop_start_;
+  uint32_t loop_end_;
+  bool stepmode_;
+  bool loopmode_;
+  uint16_t equation_index_;
+  uint16_t bytepitch_;
+
+  void Init() {
+    equation_ = 0;
+    speed_ = 32678;
+    pitch_ = 1;
+    loopmode_ = false;
+    loop_start_ = 0;
+    loop_end_ = 255 << 24;
+    phase_ = 0;
+    t_ = 0;
+    p0_ = 127;
+    p1_ = 127;
+    p2_ = 127;
+    stepmode_ = false;
+    last_sample_ = 13;
+    equation_index_ = 0;
+  }
+
+  void Configure(int32_t *parameter, bool stepmode, bool loopmode) {
+    equation_ = parameter[0];
+    equation_index_ = equation_ >> 12;
+    speed_ = parameter[1];
+    p0_ = parameter[2] >> 8;
+    p1_ = parameter[3] >> 8;
+    p2_ = parameter[4] >> 8;
+    loop_start_ = static_cast<uint32_t>((parameter[5] << 16) + (parameter[6] << 8) + parameter[7]);
+    loop_end_ = static_cast<uint32_t>((parameter[8] << 16) + (parameter[9] << 8) + parameter[10]);
+    pitch_ = parameter[11] >> 8;
+    stepmode_ = stepmode;
+    loopmode_ = loopmode;
+    uint8_t speed_rshift = (speed_ >> 13) + 1;
+    if (speed_rshift < 2) speed_rshift = 2;
+    bytepitch_ = (65535 - speed_) >> speed_rshift;
+    if (bytepitch_ < 1) {
+      bytepitch_ = 1;
+    }
+  }
+
+  // Out of line, like the original in peaks_bytebeat.cpp, so the benchmark
+  // doesn't inline it into its loop
+  __attribute__((noinline)) uint16_t ProcessSingleSample(uint8_t control) {
+
+    uint16_t sample = 0;
+   
+    if (control & CONTROL_GATE_RISING) {
+      if (stepmode_) {
+        ++t_ ;
+      } else {
+        phase_ = 0;
+        if (loopmode_) {
+          t_ = loop_start_ ;
+        } else {
+          t_ = 0 ;
+        }
+      }
+    }
+
+    if (!stepmode_) {
+      ++phase_ ; 
+    }    
+  
+    if (loopmode_ && (t_ < loop_start_ || t_ > loop_end_)) {
+       t_ = loop_start_ ;
+       phase_ = 0 ;
+    }
+
+    if (!stepmode_ && (phase_ % bytepitch_ == 0)) ++t_; 
+  // These equations push the boundaries of precedence comprehension.
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wparentheses"
+    uint8_t pitch = pitch_ ;
+    uint8_t p0 = p0_ ;
+    uint8_t p1 = p1_ ;
+    uint8_t p2 = p2_ ;
+      switch (equation_index_) {
+          case 0: // hope - pitch OK
+            // from http://royal-paw.com/2012/01/bytebeats-in-c-and-python-generative-symphonies-from-extremely-small-programs/
+            // (atmospheric, hopeful)
+            // sample = ( ( ((t_*3) & ((t_*pitch)>>10)) | ((t_*p0) & ((t_*pitch)>>10)) | ((t_*10) & (((t_*pitch)>>8)*p1) & p2) ) & 0xFF);
+            // sample = ( ( ((t_*3) & ((t_*pitch)>>10)) | ((t_*p0) & ((t_*pitch)>>10)) | ((t_*10) & ((t_>>8)*p1) & p2) ) & 0xFF);
+            sample = ( ( (((t_*pitch)*3) & (t_>>10)) | (((t_*pitch)*p0) & (t_>>10)) | ((t_*10) & ((t_>>8)*p1) & p2) ) & 0xFF);
+            break;
+          case 1: // love - pitch OK
+            // equation by stephth via https://www.youtube.com/watch?v=tCRPUv8V22o at 3:38
+            sample = (((((t_*pitch)*p0) & (t_>>4)) | ((t_*p2) & (t_>>7)) | ((t_*p1) & (t_>>10))) & 0xFF);
+            break;
+          case 2: // life - pitch OK
+            // This one is the second one listed at from http://xifeng.weebly.com/bytebeats.html
+            sample = ((( ((((((t_*pitch) >> p0) | (t_*pitch)) | ((t_*pitch) >> p0)) * p2) & ((5 * (t_*pitch)) | ((t_*pitch) >> p2)) ) | ((t_*pitch) ^ (t_ % p1)) ) & 0xFF));
+            break;
+         case 3:// age - pitch disabled
+            // Arp rotator (equation 9 from Equation Composer Ptah bank)
+            sample = (((t_)>>(p2>>4))&((t_)<<3)/((t_)*p1*((t_)>>11)%(3+(((t_)>>(16-(p0>>4)))%22))));
+            break ;
+          case 4: // clysm - pitch almost no effect
+            //  BitWiz Transplant via Equation Composer Ptah bank 
+            sample = ((t_*pitch)-(((t_*pitch)&p0)*p1-1668899)*(((t_*pitch)>>15)%15*(t_*pitch)))>>(((t_*pitch)>>12)%16)>>(p2%15);
+            break ;
+          case 5: // monk - pitch OK
+            // Vocaliser from Equation Composer Khepri bank         
+            sample = (((t_*pitch)%p0>>2)&p1)*(t_>>(p2>>5));
+            break;
+          case 6: // NERV - horrible!
+            // Chewie from Equation Composer Khepri bank         
+            sample = (p0-(((p2+1)/(t_*pitch))^p0|(t_*pitch)^922+p0))*(p2+1)/p0*(((t_*pitch)+p1)>>p1%19);
+            break;
+          case 7: // Trurl - pitch OK
+            // Tinbot from Equation Composer Sobek bank   
+            sample = ((t_*pitch)/(40+p0)*((t_*pitch)+(t_*pitch)|4-(p1+20)))+((t_*pitch)*(p2>>5));
+            break;
+          case 8: // Pirx  - pitch OK
+            // My Loud Friend from Equation Composer Ptah bank   
+            sample = ((((t_*pitch)>>((p0>>12)%12))%(t_>>((p1%12)+1))-(t_>>((t_>>(p2%10))%12)))/((t_>>((p0>>2)%15))%15))<<4;
+            break;
+          case 9: //Snaut
+            // GGT2 from Equation Composer Ptah bank
+            // sample = ((p0|(t_>>(t_>>13)%14))*((t_>>(p0%12))-p1&249))>>((t_>>13)%6)>>((p2>>4)%12);
+            // "A bit high-frequency, but keeper anyhow" from Equation Composer Khepri bank.
+            sample = ((t_*pitch)+last_sample_+p1/p0)%(p0|(t_*pitch)+p2);
+             break;
+          case 10: // Hari
+            // The Signs, from Equation Composer Ptah bank
+            sample = ((0&(251&((t_*pitch)/(100+p0))))|((last_sample_/(t_*pitch)|((t_*pitch)/(100*(p1+1))))*((t_*pitch)|p2)));
+            break;
+          case 11: // Kris - pitch OK
+           // Light Reactor from Equation Composer Ptah bank
+            sample = (((t_*pitch)>>3)*(p0-643|(325%t_|p1)&t_)-((t_>>6)*35/p2%t_))>>6;
+            break;
+          case 12: // Tichy
+            sample = (t_*pitch_)>>7 & t_>>7 | t_>>8;
+            // Alpha from Equation Composer Khepri bank
+            // sample = ((((t_*pitch)^(p0>>3)-456)*(p1+1))/((((t_*pitch)>>(p2>>3))%14)+1))+((t_*pitch)*((182>>((t_*pitch)>>15)%16))&1) ;
+            break;
+          case 13: // Bregg - pitch OK
+            // Hooks, from Equation Composer Khepri bank.
+            sample = ((t_*pitch)&(p0+2))-(t_/p1)/last_sample_/p2;
+            break;            
+          case 14: // Avon - pitch OK
+            // Widerange from Equation Composer Khepri bank
+            sample = (((p0^((t_*pitch)>>(p1>>3)))-(t_>>(p2>>2))-t_%(t_&p1)));
+            break;        
+          case 15: // Orac
+            // Abducted, from Equation Composer Ptah bank
+            sample = (p0+(t_*pitch)>>p1%12)|((last_sample_%(p0+(t_*pitch)>>p0%4))+11+p2^t_)>>(p2>>12);
+            break;
+          default:
+            sample = 0 ;
+            break;          
+    }
+  #pragma GCC diagnostic pop
+    last_sample_ = sample ;
+    return sample << 8 ;
+  }
+};
+
+static sigjmp_buf fpe_jump;
+
+static void OnFPE(int) {
+  siglongjmp(fpe_jump, 1);
+}
+
+// Returns false if the reference trapped. Its t_ and phase_ have moved on
+// by then, but not last_sample_, so that's taken from the engine.
+static bool ReferenceSample(ReferenceByteBeat &reference, uint8_t control, uint16_t &sample) {
+  if (sigsetjmp(fpe_jump, 1)) return false;
+  sample = reference.ProcessSingleSample(control);
+  return true;
+}
+
+static uint32_t test_random(uint32_t &state) {
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+// Parameters as APP_BYTEBEATGEN passes them, 16 bits each
+static void RandomParameters(int32_t *s, int equation, uint32_t &state) {
+  s[0] = equation << 12;
+  for (int i = 1; i < 12; ++i) s[i] = test_random(state) & 0xffff;
+  s[1] |= (s[1] & 1) ? 0xfe00 : 0xc000; // fast enough to move t_ along
+  s[5] = s[6] = s[7] = 0; // loops from the start...
+  s[8] = 0xff; // ...to somewhere far enough
+}
+
+class ByteBeatTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    struct sigaction action = {};
+    action.sa_handler = OnFPE;
+    sigaction(SIGFPE, &action, &old_action_);
+  }
+  virtual void TearDown() {
+    sigaction(SIGFPE, &old_action_, nullptr);
+  }
+
+  struct sigaction old_action_;
+};
+
+TEST_F(ByteBeatTest, MatchesReference) {
+  uint32_t state = 1;
+  for (int equation = 0; equation < 16; ++equation) {
+    ByteBeat bytebeat;
+    ReferenceByteBeat reference;
+    bytebeat.Init();
+    reference.Init();
+
+    int compared = 0, trapped = 0;
+    for (int run = 0; run < 16; ++run) {
+      int32_t s[12];
+      RandomParameters(s, equation, state);
+      const bool stepmode = run % 4 == 3;
+      const bool loopmode = run % 4 == 2;
+      bytebeat.Configure(s, stepmode, loopmode);
+      reference.Configure(s, stepmode, loopmode);
+
+      for (int i = 0; i < 4000; ++i) {
+        uint8_t control = 0;
+        if ((test_random(state) & 0x1fff) == 0) control |= CONTROL_GATE_RISING;
+
+        const uint16_t sample = bytebeat.ProcessSingleSample(control);
+        uint16_t expected;
+        if (ReferenceSample(reference, control, expected)) {
+          ASSERT_EQ(expected, sample) << "equation " << equation << ", run " << run << ", sample " << i;
+          ++compared;
+        } else {
+          reference.last_sample_ = bytebeat.get_last_sample();
+          ++trapped;
+        }
+        ASSERT_EQ(reference.t_, bytebeat.get_t());
+        ASSERT_EQ(reference.phase_, bytebeat.get_phase());
+      }
+    }
+    EXPECT_GT(compared, 10000) << "equation " << equation << ": " << trapped << " trapped";
+  }
+}
+
+// Rendering a block is the same as a sample at a time without gates, also
+// after the equation changes
+TEST_F(ByteBeatTest, Render) {
+  uint32_t state = 2;
+  ByteBeat single, block;
+  single.Init();
+  block.Init();
+  for (int equation = 15; equation >= 0; --equation) {
+    int32_t s[12];
+    RandomParameters(s, equation, state);
+    single.Configure(s, false, false);
+    block.Configure(s, false, false);
+
+    uint16_t samples[64];
+    for (int n = 0; n < 100; ++n) {
+      block.Render(samples, 64);
+      for (int i = 0; i < 64; ++i) ASSERT_EQ(single.ProcessSingleSample(0), samples[i]) << equation;
+    }
+    EXPECT_EQ(single.get_t(), block.get_t());
+  }
+}
+
+// Not a pass/fail test: per sample, the old code vs. one sample at a time
+// and blocks of 32 with the equation picked once
+TEST_F(ByteBeatTest, Benchmark) {
+  static const int kSamples = 1 << 16;
+  // Equations that don't divide by zero, so the reference doesn't trap
+  static const int kEquations[] = { 0, 1, 4, 7, 12 };
+  double reference_ns = 0, single_ns = 0, block_ns = 0;
+  uint32_t sum = 0;
+  uint32_t state = 3;
+  for (int equation : kEquations) {
+    int32_t s[12];
+    RandomParameters(s, equation, state);
+    ReferenceByteBeat reference;
+    ByteBeat bytebeat;
+    reference.Init();
+    bytebeat.Init();
+    reference.Configure(s, false, false);
+    bytebeat.Configure(s, false, false);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSamples; ++i) sum += reference.ProcessSingleSample(0);
+    auto end = std::chrono::steady_clock::now();
+    reference_ns += std::chrono::duration<double, std::nano>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSamples; ++i) sum += bytebeat.ProcessSingleSample(0);
+    end = std::chrono::steady_clock::now();
+    single_ns += std::chrono::duration<double, std::nano>(end - start).count();
+
+    uint16_t block[32];
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSamples; i += 32) {
+      bytebeat.Render(block, 32);
+      sum += block[31];
+    }
+    end = std::chrono::steady_clock::now();
+    block_ns += std::chrono::duration<double, std::nano>(end - start).count();
+  }
+  const double samples = kSamples * (sizeof(kEquations) / sizeof(kEquations[0]));
+  printf("ByteBeat per sample: old %.1fns, single %.1fns, blocks of 32 %.1fns (%u)\n",
+         reference_ns / samples, single_ns / samples, block_ns / samples, sum & 1);
+}
@@ -0,0 +1,283 @@
+#include <map>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+// Minimal RAM-backed stand-in for the Teensy FS/File classes
+#define FILE_READ 0
+#define FILE_WRITE 1
+
+struct RamFS;
+
+struct RamFile {
+  RamFS *fs = nullptr;
+  std::vector<uint8_t> *data = nullptr;
+  size_t pos = 0;
+
+  explicit operator bool() const { return data != nullptr; }
+  size_t size() const { return data->size(); }
+  int read(void *buf, size_t n) {
+    n = std::min(n, data->size() - pos);
+    memcpy(buf, data->data() + pos, n);
+    pos += n;
+    return n;
+  }
+  size_t write(const void *buf, size_t n);
+  void close() { data = nullptr; }
+};
+
+struct RamFS {
+  std::map<std::string, std::vector<uint8_t>> files;
+  // Simulated power loss: writes stop after this many more bytes
+  size_t write_budget = SIZE_MAX;
+
+  RamFile open(const char *path, int mode) {
+    RamFile file;
+    auto it = files.find(path);
+    if (mode == FILE_READ && it == files.end()) return file;
+    file.fs = this;
+    file.data = &files[path];
+    file.pos = (mode == FILE_WRITE) ? file.data->size() : 0;
+    return file;
+  }
+  bool exists(const char *path) const { return files.count(path) > 0; }
+  bool remove(const char *path) { return files.erase(path) > 0; }
+  bool rename(const char *from, const char *to) {
+    auto it = files.find(from);
+    if (it == files.end()) return false;
+    files[to] = it->second;
+    files.erase(from);
+    return true;
+  }
+};
+
+size_t RamFile::write(const void *buf, size_t n) {
+  n = std::min(n, fs->write_budget);
+  fs->write_budget -= n;
+  const uint8_t *src = static_cast<const uint8_t *>(buf);
+  data->insert(data->end(), src, src + n);
+  pos += n;
+  return n;
+}
+
+#include "util/util_chunkstore.h"
+
+static const size_t kCapacity = 256;
+typedef ChunkStore<RamFS, RamFile, kCapacity, 8> Store;
+
+static const char *kPath = "/apps.dat";
+static const char *kTmpPath = "/apps.tmp";
+
+static void Drain(Store &store) {
+  int polls = 0;
+  while (store.Poll()) ASSERT_LT(++polls, 100);
+}
+
+static std::vector<uint8_t> Chunk(uint8_t fill, size_t length) {
+  return std::vector<uint8_t>(length, fill);
+}
+
+static void ExpectChunk(const Store &store, uint16_t id, const std::vector<uint8_t> &expected) {
+  for (size_t i = 0; i < store.num_chunks(); ++i) {
+    if (store.chunk_id(i) != id) continue;
+    ASSERT_EQ(expected.size(), store.chunk_length(i));
+    EXPECT_EQ(0, memcmp(expected.data(), store.chunk_data(i), expected.size())) << "chunk " << id;
+    return;
+  }
+  ADD_FAILURE() << "chunk " << id << " not found";
+}
+
+class ChunkStoreTest : public ::testing::Test {
+protected:
+  RamFS fs_;
+  Store store_;
+};
+
+TEST_F(ChunkStoreTest, EmptyFilesystem) {
+  EXPECT_FALSE(store_.Begin(&fs_, kPath, kTmpPath));
+  EXPECT_EQ(0u, store_.num_chunks());
+  EXPECT_FALSE(store_.Poll());
+  EXPECT_FALSE(fs_.exists(kPath));
+}
+
+TEST_F(ChunkStoreTest, OnlyChangedChunksAreWritten) {
+  store_.Begin(&fs_, kPath, kTmpPath);
+  EXPECT_TRUE(store_.Stage(1, Chunk(0x11, 20).data(), 20));
+  EXPECT_TRUE(store_.Stage(2, Chunk(0x22, 30).data(), 30));
+  Drain(store_);
+  EXPECT_EQ(2u, store_.stats().records_written);
+
+  // unchanged: nothing to do
+  EXPECT_FALSE(store_.Stage(1, Chunk(0x11, 20).data(), 20));
+  EXPECT_FALSE(store_.Stage(2, Chunk(0x22, 30).data(), 30));
+  EXPECT_FALSE(store_.pending());
+  EXPECT_FALSE(store_.Poll());
+
+  // one changed chunk, one record
+  EXPECT_TRUE(store_.Stage(2, Chunk(0x23, 30).data(), 30));
+  EXPECT_TRUE(store_.Poll());
+  EXPECT_FALSE(store_.Poll());
+  EXPECT_EQ(3u, store_.stats().records_written);
+
+  Store reloaded;
+  EXPECT_TRUE(reloaded.Begin(&fs_, kPath, kTmpPath));
+  EXPECT_EQ(2u, reloaded.num_chunks());
+  ExpectChunk(reloaded, 1, Chunk(0x11, 20));
+  ExpectChunk(reloaded, 2, Chunk(0x23, 30));
+  EXPECT_FALSE(reloaded.pending());
+}
+
+TEST_F(ChunkStoreTest, LengthChange) {
+  store_.Begin(&fs_, kPath, kTmpPath);
+  store_.Stage(1, Chunk(0x11, 20).data(), 20);
+  store_.Stage(2, Chunk(0x22, 30).data(), 30);
+  store_.Stage(3, Chunk(0x33, 10).data(), 10);
+  Drain(store_);
+  store_.Stage(2, Chunk(0x44, 40).data(), 40);
+  Drain(store_);
+
+  Store reloaded;
+  reloaded.Begin(&fs_, kPath, kTmpPath);
+  EXPECT_EQ(3u, reloaded.num_chunks());
+  ExpectChunk(reloaded, 1, Chunk(0x11, 20));
+  ExpectChunk(reloaded, 2, Chunk(0x44, 40));
+  ExpectChunk(reloaded, 3, Chunk(0x33, 10));
+}
+
+TEST_F(ChunkStoreTest, Compaction) {
+  store_.Begin(&fs_, kPath, kTmpPath);
+  store_.Stage(1, Chunk(0x11, 50).data(), 50);
+  store_.Stage(2, Chunk(0x22, 50).data(), 50);
+  Drain(store_);
+
+  for (int i = 0; i < 100; ++i) {
+    store_.Stage(2, Chunk(i, 50).data(), 50);
+    Drain(store_);
+    EXPECT_LE(store_.journal_size(), Store::kJournalLimit);
+    EXPECT_LE(fs_.files[kPath].size(), Store::kJournalLimit);
+  }
+  EXPECT_GT(store_.stats().compactions, 0u);
+  EXPECT_FALSE(fs_.exists(kTmpPath));
+
+  Store reloaded;
+  reloaded.Begin(&fs_, kPath, kTmpPath);
+  ExpectChunk(reloaded, 1, Chunk(0x11, 50));
+  ExpectChunk(reloaded, 2, Chunk(99, 50));
+}
+
+TEST_F(ChunkStoreTest, FailingCompactionIsAbandoned) {
+  store_.Begin(&fs_, kPath, kTmpPath);
+  store_.Stage(1, Chunk(0x11, 20).data(), 20);
+  Drain(store_);
+
+  // every write fails: the journal append, then each compaction attempt
+  fs_.write_budget = 0;
+  store_.Stage(1, Chunk(0x22, 20).data(), 20);
+  Drain(store_);
+  EXPECT_FALSE(store_.pending());
+  EXPECT_EQ(1u, store_.stats().compactions_abandoned);
+  EXPECT_EQ(1u + Store::kMaxCompactionAttempts, store_.stats().write_errors);
+
+  Store reloaded;
+  reloaded.Begin(&fs_, kPath, kTmpPath);
+  ExpectChunk(reloaded, 1, Chunk(0x11, 20));
+
+  // the next save tries again
+  fs_.write_budget = SIZE_MAX;
+  store_.Stage(1, Chunk(0x22, 20).data(), 20);
+  EXPECT_TRUE(store_.pending());
+  Drain(store_);
+  EXPECT_EQ(1u, store_.stats().compactions);
+
+  Store again;
+  again.Begin(&fs_, kPath, kTmpPath);
+  ExpectChunk(again, 1, Chunk(0x22, 20));
+}
+
+TEST_F(ChunkStoreTest, TornRecordIsDropped) {
+  store_.Begin(&fs_, kPath, kTmpPath);
+  store_.Stage(1, Chunk(0x11, 20).data(), 20);
+  Drain(store_);
+
+  // power fails halfway through the next record
+  store_.Stage(1, Chunk(0x12, 20).data(), 20);
+  fs_.write_budget = 13;
+  store_.Poll();
+  fs_.write_budget = SIZE_MAX;
+
+  Store reloaded;
+  reloaded.Begin(&fs_, kPath, kTmpPath);
+  EXPECT_EQ(1u, reloaded.stats().bad_records);
+  ExpectChunk(reloaded, 1, Chunk(0x11, 20));
+
+  // the torn tail is compacted away before anything else is appended
+  EXPECT_TRUE(reloaded.pending());
+  reloaded.Stage(2, Chunk(0x22, 20).data(), 20);
+  Drain(reloaded);
+  Store again;
+  again.Begin(&fs_, kPath, kTmpPath);
+  EXPECT_EQ(0u, again.stats().bad_records);
+  ExpectChunk(again, 1, Chunk(0x11, 20));
+  ExpectChunk(again, 2, Chunk(0x22, 20));
+}
+
+TEST_F(ChunkStoreTest, CorruptedRecord) {
+  store_.Begin(&fs_, kPath, kTmpPath);
+  store_.Stage(1, Chunk(0x11, 20).data(), 20);
+  store_.Stage(2, Chunk(0x22, 20).data(), 20);
+  Drain(store_);
+  fs_.files[kPath][8 + 20 + 8 + 5] ^= 0x40; // payload of the second record
+
+  Store reloaded;
+  reloaded.Begin(&fs_, kPath, kTmpPath);
+  EXPECT_EQ(1u, reloaded.num_chunks());
+  ExpectChunk(reloaded, 1, Chunk(0x11, 20));
+}
+
+TEST_F(ChunkStoreTest, PowerLossDuringCompaction) {
+  // at every point of a compaction, a reload sees the latest data
+  for (size_t budget = 0; budget < 400; budget += 7) {
+    RamFS fs;
+    Store store;
+    store.Begin(&fs, kPath, kTmpPath);
+    store.Stage(1, Chunk(0x11, 60).data(), 60);
+    store.Stage(2, Chunk(0x22, 60).data(), 60);
+    Drain(store);
+    while (store.journal_size() + 68 <= Store::kJournalLimit) {
+      store.Stage(2, Chunk(store.journal_size() & 0xff, 60).data(), 60);
+      Drain(store);
+    }
+    ASSERT_EQ(2, store.chunk_id(1));
+    const uint8_t *chunk2 = static_cast<const uint8_t *>(store.chunk_data(1));
+    const std::vector<uint8_t> latest(chunk2, chunk2 + 60);
+
+    // next write triggers the compaction
+    store.Stage(1, Chunk(0x33, 60).data(), 60);
+    fs.write_budget = budget;
+    int polls = 0;
+    while (store.Poll() && ++polls < 20) { }
+    fs.write_budget = SIZE_MAX;
+
+    Store reloaded;
+    reloaded.Begin(&fs, kPath, kTmpPath);
+    Drain(reloaded);
+    ASSERT_EQ(2u, reloaded.num_chunks()) << "budget " << budget;
+    // chunk 1 is either the old or new value, never garbage
+    ASSERT_EQ(1, reloaded.chunk_id(0));
+    bool old_value = !memcmp(reloaded.chunk_data(0), Chunk(0x11, 60).data(), 60);
+    bool new_value = !memcmp(reloaded.chunk_data(0), Chunk(0x33, 60).data(), 60);
+    EXPECT_TRUE(old_value || new_value) << "budget " << budget;
+    ExpectChunk(reloaded, 2, latest);
+    EXPECT_FALSE(fs.exists(kTmpPath));
+  }
+}
+
+TEST_F(ChunkStoreTest, Capacity) {
+  store_.Begin(&fs_, kPath, kTmpPath);
+  EXPECT_TRUE(store_.Stage(1, Chunk(0x11, 200).data(), 200));
+  EXPECT_FALSE(store_.Stage(2, Chunk(0x22, 100).data(), 100));
+  EXPECT_EQ(1u, store_.num_chunks());
+  for (uint16_t id = 3; id < 10; ++id)
+    store_.Stage(id, Chunk(id, 1).data(), 1);
+  EXPECT_EQ(8u, store_.num_chunks());
+}
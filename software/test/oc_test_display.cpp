@@ -0,0 +1,126 @@
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "src/drivers/framebuffer.h"
+#include "src/drivers/page_display_driver.h"
+
+// Stand-in for SH1106_128x64_Driver that keeps a copy of the display RAM
+struct TestDisplayDriver {
+  static constexpr size_t kFrameSize = 128 * 64 / 8;
+  static constexpr size_t kNumPages = 8;
+  static constexpr size_t kNumSubpages = 4;
+  static constexpr size_t kPageSize = kFrameSize / kNumPages;
+  static constexpr size_t kSubpageSize = kPageSize / 4;
+
+  static void Init() {
+    memset(screen, 0, sizeof(screen));
+    subpages_sent = 0;
+  }
+  static void Flush() { }
+  static void SendPage(uint_fast8_t index, uint_fast8_t subpage, const uint8_t *data) {
+    memcpy(screen + index * kPageSize + subpage * kSubpageSize, data + subpage * kSubpageSize, kSubpageSize);
+    ++subpages_sent;
+  }
+
+  static uint8_t screen[kFrameSize];
+  static size_t subpages_sent;
+};
+
+uint8_t TestDisplayDriver::screen[TestDisplayDriver::kFrameSize];
+size_t TestDisplayDriver::subpages_sent;
+
+class DisplayTransferTest : public ::testing::Test {
+public:
+  virtual void SetUp() {
+    frame_buffer_.Init();
+    driver_.Init();
+    memset(frame_, 0, sizeof(frame_));
+  }
+
+  // Same sequence as display::Flush/display::Update in the core ISR
+  void Tick() {
+    if (driver_.Flush())
+      frame_buffer_.read();
+    if (driver_.frame_valid()) {
+      driver_.Update();
+    } else {
+      if (frame_buffer_.readable())
+        driver_.Begin(frame_buffer_.readable_frame(), frame_buffer_.readable_dirty_mask());
+    }
+  }
+
+  // Write frame_ and run the ISR until it's on the display
+  size_t Send() {
+    EXPECT_TRUE(frame_buffer_.writeable());
+    memcpy(frame_buffer_.writeable_frame(), frame_, sizeof(frame_));
+    frame_buffer_.written();
+
+    const size_t sent = TestDisplayDriver::subpages_sent;
+    for (int i = 0; i < 64; ++i) Tick();
+    EXPECT_EQ(0, memcmp(frame_, TestDisplayDriver::screen, sizeof(frame_)));
+    return TestDisplayDriver::subpages_sent - sent;
+  }
+
+protected:
+  FrameBuffer<TestDisplayDriver::kFrameSize, 2> frame_buffer_;
+  PagedDisplayDriver<TestDisplayDriver> driver_;
+  uint8_t frame_[TestDisplayDriver::kFrameSize];
+};
+
+TEST_F(DisplayTransferTest, FirstFrameIsComplete) {
+  frame_[0] = 0xff;
+  EXPECT_EQ(32U, Send());
+}
+
+TEST_F(DisplayTransferTest, StaticScreen) {
+  frame_[100] = 0x55;
+  Send();
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(0U, Send());
+}
+
+TEST_F(DisplayTransferTest, CursorBlink) {
+  Send();
+  for (int i = 0; i < 10; ++i) {
+    frame_[3 * 128 + 40] ^= 0x80;
+    EXPECT_EQ(1U, Send());
+  }
+  // Straddles a subpage boundary
+  frame_[31] = frame_[32] = 0xff;
+  EXPECT_EQ(2U, Send());
+}
+
+TEST_F(DisplayTransferTest, Invalidate) {
+  Send();
+  frame_buffer_.invalidate();
+  EXPECT_EQ(32U, Send());
+  EXPECT_EQ(0U, Send());
+}
+
+TEST_F(DisplayTransferTest, PeriodicFullRefresh) {
+  size_t total = Send();
+  for (uint32_t i = 0; i < decltype(frame_buffer_)::kFullRefreshFrames; ++i)
+    total += Send();
+  EXPECT_EQ(64U, total);
+}
+
+// Frames written while the previous one is still being transferred, as the
+// main loop does, must still leave the display showing the latest frame.
+TEST_F(DisplayTransferTest, Pipelined) {
+  uint32_t state = 1;
+  size_t frames = 0;
+  for (int tick = 0; tick < 20000; ++tick) {
+    if (frame_buffer_.writeable() && !(tick % 7)) {
+      state = state * 1664525 + 1013904223;
+      frame_[(state >> 8) % sizeof(frame_)] ^= (state >> 24) | 1;
+      memcpy(frame_buffer_.writeable_frame(), frame_, sizeof(frame_));
+      frame_buffer_.written();
+      ++frames;
+    }
+    Tick();
+  }
+  for (int i = 0; i < 128; ++i) Tick();
+  EXPECT_EQ(0, memcmp(frame_, TestDisplayDriver::screen, sizeof(frame_)));
+  // Far fewer than 32 subpages per frame
+  EXPECT_LT(TestDisplayDriver::subpages_sent, frames * 4);
+}
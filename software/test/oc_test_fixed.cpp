@@ -0,0 +1,121 @@
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include "gtest/gtest.h"
+#include "HSFixed.h"
+
+using namespace HS;
+
+TEST(FixedTest, Conversions) {
+  EXPECT_EQ(3 << 16, int2q16(3));
+  EXPECT_EQ(-3, q162int(int2q16(-3)));
+  EXPECT_EQ(-1, q162int(-1)); // towards -inf
+  EXPECT_EQ(Q16_ONE / 2, float2q16(0.5f));
+  EXPECT_EQ(-Q16_ONE / 4, float2q16(-0.25f));
+  EXPECT_EQ(int2q16(6), Q16Mul(int2q16(2), int2q16(3)));
+  EXPECT_EQ(-int2q16(3), Q16Mul(int2q16(-6), Q16_ONE / 2));
+}
+
+TEST(FixedTest, Exp2) {
+  EXPECT_EQ(Q16_ONE, Q16Exp2(0));
+  EXPECT_EQ(int2q16(2), Q16Exp2(Q16_ONE));
+  EXPECT_EQ(Q16_ONE / 2, Q16Exp2(-Q16_ONE));
+  EXPECT_EQ(int2q16(1024), Q16Exp2(int2q16(10)));
+  EXPECT_EQ(INT32_MAX, Q16Exp2(int2q16(15)));
+  EXPECT_EQ(0, Q16Exp2(int2q16(-20)));
+
+  double max_error = 0;
+  for (q16_t x = int2q16(-16); x < int2q16(14); x += 97) {
+    const double expected = exp2(q162float(x)) * Q16_ONE;
+    const double error = fabs(Q16Exp2(x) - expected);
+    // half an LSB for rounding, otherwise relative
+    ASSERT_LE(error, 0.5 + expected * 1e-6) << "x=" << q162float(x);
+    if (expected >= Q16_ONE)
+      max_error = std::max(max_error, error / expected);
+  }
+  printf("Q16Exp2: max relative error %.2e for results >= 1\n", max_error);
+}
+
+TEST(FixedTest, Log2) {
+  EXPECT_EQ(0, Q16Log2(Q16_ONE));
+  EXPECT_EQ(int2q16(3), Q16Log2(int2q16(8)));
+  EXPECT_EQ(-int2q16(16), Q16Log2(1));
+  EXPECT_EQ(int2q16(15), Q16Log2(0x80000000u));
+  EXPECT_EQ(INT32_MIN, Q16Log2(0));
+
+  int max_error = 0;
+  for (uint64_t x = 1; x <= UINT32_MAX; x += 1 + x / 512) {
+    const double expected = log2(double(x) / Q16_ONE) * Q16_ONE;
+    const int error = abs(Q16Log2(uint32_t(x)) - int(floor(expected)));
+    ASSERT_LE(error, 2) << "x=" << x;
+    max_error = std::max(max_error, error);
+  }
+  printf("Q16Log2: max error %d LSB\n", max_error);
+}
+
+TEST(FixedTest, Reciprocal) {
+  EXPECT_EQ(uint32_t(Q16_ONE), Q16Reciprocal(Q16_ONE));
+  EXPECT_EQ(uint32_t(Q16_ONE / 2), Q16Reciprocal(int2q16(2)));
+  EXPECT_EQ(uint32_t(int2q16(4)), Q16Reciprocal(Q16_ONE / 4));
+  EXPECT_EQ(UINT32_MAX, Q16Reciprocal(1));
+  EXPECT_EQ(UINT32_MAX, Q16Reciprocal(0));
+
+  for (uint64_t x = 2; x <= UINT32_MAX; x += 1 + x / 1024) {
+    const double expected = double(1ULL << 32) / x;
+    ASSERT_LE(fabs(Q16Reciprocal(uint32_t(x)) - expected), 1.0) << "x=" << x;
+  }
+}
+
+TEST(FixedTest, OnePoleMatchesFloat) {
+  // RndWalk-style smoothing of a random walk, against the float version
+  for (q16_t alpha : { 0, Q16_ONE / 2, float2q16(0.9f), float2q16(0.999f) }) {
+    const double falpha = q162float(alpha);
+    double reference = 0;
+    q16_t state = 0;
+    uint32_t random = 1;
+    int target = 0;
+    for (int i = 0; i < 100000; ++i) {
+      if (!(i % 500)) {
+        random = random * 1664525 + 1013904223;
+        target = int(random >> 18) - 8192;
+      }
+      reference = falpha * reference + (1 - falpha) * target;
+      state = Q16OnePole(state, target, alpha);
+      // truncation bias is at most 1/65536 / (1 - alpha); CV units are 1/128 semitone
+      ASSERT_NEAR(reference, q162float(state), 0.05) << "alpha=" << falpha << ", step " << i;
+    }
+    // no dead band; settles on the target
+    for (int i = 0; i < 20000; ++i)
+      state = Q16OnePole(state, target, alpha);
+    EXPECT_EQ(target, q162int(state + Q16_ONE / 2));
+  }
+}
+
+TEST(FixedTest, Benchmark) {
+  static const int kIterations = 1000000;
+
+  volatile q16_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  q16_t state = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    state = Q16OnePole(state, i & 0x1fff, float2q16(0.99f));
+    sink = Q16Exp2(i & 0x7ffff) + Q16Log2(i + 1) + Q16Reciprocal(i + 1);
+  }
+  auto end = std::chrono::steady_clock::now();
+  const double fixed = std::chrono::duration<double, std::nano>(end - start).count();
+
+  volatile float fsink = 0;
+  start = std::chrono::steady_clock::now();
+  float fstate = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    fstate = 0.99f * fstate + 0.01f * (i & 0x1fff);
+    fsink = exp2f((i & 0x7ffff) / 65536.0f) + log2f((i + 1) / 65536.0f) + 65536.0f / (i + 1);
+  }
+  end = std::chrono::steady_clock::now();
+  const double reference = std::chrono::duration<double, std::nano>(end - start).count();
+
+  (void)sink;
+  (void)fsink;
+  printf("one-pole+exp2+log2+recip: Q16 %.2fns, float %.2fns (host FPU; T3.2 has none)\n",
+         fixed / kIterations, reference / kIterations);
+}
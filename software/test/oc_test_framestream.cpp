@@ -0,0 +1,197 @@
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/util_framestream.h"
+
+typedef util::FrameStreamer<1024, 128> Streamer;
+
+// Sink with a fixed amount of room per Poll, like a USB serial TX buffer
+struct TestSink {
+  std::vector<uint8_t> data;
+  size_t room = 1 << 20;
+
+  int availableForWrite() const { return room; }
+  size_t write(const uint8_t *buf, size_t n) {
+    EXPECT_LE(n, room);
+    data.insert(data.end(), buf, buf + n);
+    room -= n;
+    return n;
+  }
+};
+
+// Teensy 3.x USB serial: only what's left of the current 64-byte packet is
+// reported, and only a few packets can be queued per poll
+struct USBPacketSink : TestSink {
+  size_t packets = 0;
+
+  int availableForWrite() const {
+    if (!packets) return 0;
+    return 64 - data.size() % 64;
+  }
+  size_t write(const uint8_t *buf, size_t n) {
+    EXPECT_LE(n, size_t(availableForWrite()));
+    data.insert(data.end(), buf, buf + n);
+    if (!(data.size() % 64)) --packets;
+    return n;
+  }
+};
+
+// Host side, as in res/oc_screen.py
+struct TestDecoder {
+  uint8_t frame[1024] = {};
+  size_t frames = 0;
+  size_t pos = 0;
+
+  void Decode(const std::vector<uint8_t> &data) {
+    while (pos + Streamer::kHeaderSize <= data.size()) {
+      ASSERT_EQ(Streamer::kSync0, data[pos]);
+      ASSERT_EQ(Streamer::kSync1, data[pos + 1]);
+      const uint8_t id = data[pos + 2];
+      const size_t length = data[pos + 3] | (data[pos + 4] << 8);
+      // packets may arrive in pieces; wait for the rest
+      if (pos + Streamer::kHeaderSize + length > data.size())
+        return;
+      pos += Streamer::kHeaderSize;
+      if (id == Streamer::kEndOfFrame) {
+        ASSERT_EQ(0U, length);
+        ++frames;
+        continue;
+      }
+      ASSERT_LT(id, Streamer::kNumPages);
+      uint8_t *page = frame + id * 128;
+      const size_t end = pos + length;
+      size_t i = 0;
+      while (pos < end) {
+        const uint8_t c = data[pos++];
+        if (c & 0x80) {
+          for (int n = (c & 0x7f) + 2; n; --n) page[i++] ^= data[pos];
+          ++pos;
+        } else {
+          for (int n = c + 1; n; --n) page[i++] ^= data[pos++];
+        }
+      }
+      ASSERT_EQ(128U, i);
+    }
+  }
+};
+
+static void RandomFrame(uint8_t *frame, uint32_t &seed) {
+  for (size_t i = 0; i < 1024; ++i) {
+    seed = seed * 1664525 + 1013904223;
+    frame[i] = seed >> 24;
+  }
+}
+
+TEST(FrameStreamTest, EncodeDelta) {
+  uint8_t page[128], remote[128], out[Streamer::kMaxPayloadSize];
+
+  memset(page, 0, sizeof(page));
+  memset(remote, 0, sizeof(remote));
+  // No change: a single run of 128 zeros
+  EXPECT_EQ(2U, Streamer::EncodeDelta(page, remote, out));
+  EXPECT_EQ(0x80 | 126, out[0]);
+  EXPECT_EQ(0, out[1]);
+
+  // A glyph's worth of change in the middle
+  for (int i = 60; i < 66; ++i) page[i] = 0x11 * (i - 59);
+  const size_t length = Streamer::EncodeDelta(page, remote, out);
+  EXPECT_EQ(2U + 7U + 2U, length);
+
+  // Worst case stays within bounds
+  uint32_t seed = 1;
+  uint8_t frame[1024];
+  RandomFrame(frame, seed);
+  for (size_t i = 0; i < 128; ++i) page[i] = i & 1 ? 0xaa : 0x55;
+  EXPECT_EQ(Streamer::kMaxPayloadSize, Streamer::EncodeDelta(page, remote, out));
+  EXPECT_LE(Streamer::EncodeDelta(frame, remote, out), Streamer::kMaxPayloadSize);
+}
+
+TEST(FrameStreamTest, RoundTrip) {
+  Streamer streamer;
+  TestSink sink;
+  TestDecoder decoder;
+  uint8_t frame[1024] = {};
+  uint32_t seed = 1;
+
+  streamer.Poll(frame, sink);
+  EXPECT_TRUE(sink.data.empty()); // not started
+
+  streamer.Start();
+  streamer.Poll(frame, sink);
+  decoder.Decode(sink.data);
+  EXPECT_EQ(1U, decoder.frames);
+  EXPECT_EQ(Streamer::kHeaderSize, sink.data.size()); // blank frame, nothing to send
+
+  RandomFrame(frame, seed);
+  streamer.Poll(frame, sink);
+  decoder.Decode(sink.data);
+  EXPECT_EQ(2U, decoder.frames);
+  EXPECT_EQ(0, memcmp(frame, decoder.frame, sizeof(frame)));
+
+  // Small edits are cheap
+  for (int f = 0; f < 100; ++f) {
+    const size_t before = sink.data.size();
+    seed = seed * 1664525 + 1013904223;
+    const size_t x = seed % 1018;
+    for (size_t i = x; i < x + 6; ++i) frame[i] ^= seed >> 8;
+    streamer.Poll(frame, sink);
+    decoder.Decode(sink.data);
+    ASSERT_EQ(0, memcmp(frame, decoder.frame, sizeof(frame))) << "frame " << f;
+    EXPECT_LT(sink.data.size() - before, 2 * (Streamer::kHeaderSize + 2 + 7 + 2) + Streamer::kHeaderSize);
+  }
+  EXPECT_EQ(102U, decoder.frames);
+
+  // Unchanged frames send nothing
+  const size_t before = sink.data.size();
+  streamer.Poll(frame, sink);
+  EXPECT_EQ(before, sink.data.size());
+
+  // Restarting resends everything
+  streamer.Start();
+  TestDecoder fresh;
+  sink.data.clear();
+  streamer.Poll(frame, sink);
+  fresh.Decode(sink.data);
+  EXPECT_EQ(0, memcmp(frame, fresh.frame, sizeof(frame)));
+}
+
+TEST(FrameStreamTest, SlowLink) {
+  Streamer streamer;
+  TestSink sink;
+  TestDecoder decoder;
+  uint8_t frame[1024];
+  uint32_t seed = 7;
+
+  streamer.Start();
+  // Room for about two pages per poll, so a frame takes four polls to go out
+  for (int poll = 0; poll < 200; ++poll) {
+    if (poll < 100 && !(poll % 5))
+      RandomFrame(frame, seed);
+    sink.room = 2 * Streamer::kMaxPacketSize + 10;
+    streamer.Poll(frame, sink);
+    decoder.Decode(sink.data);
+  }
+  EXPECT_EQ(0, memcmp(frame, decoder.frame, sizeof(frame)));
+  EXPECT_GT(decoder.frames, 10U);
+}
+
+TEST(FrameStreamTest, USBPacketRoom) {
+  Streamer streamer;
+  USBPacketSink sink;
+  TestDecoder decoder;
+  uint8_t frame[1024];
+  uint32_t seed = 11;
+
+  // Whole pages never fit in the reported room
+  ASSERT_GT(Streamer::kMaxPacketSize, 64U);
+  streamer.Start();
+  for (int poll = 0; poll < 400; ++poll) {
+    if (poll < 200 && !(poll % 20))
+      RandomFrame(frame, seed);
+    sink.packets = 3;
+    streamer.Poll(frame, sink);
+    decoder.Decode(sink.data);
+  }
+  EXPECT_EQ(0, memcmp(frame, decoder.frame, sizeof(frame)));
+  EXPECT_GT(decoder.frames, 5U);
+}
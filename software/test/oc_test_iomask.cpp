@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "HSIOMask.h"
+
+using namespace HS;
+
+static const int kChannels = 8;
+static const int kGateThreshold = 15 << 7;
+static const int kChangeThreshold = 32;
+
+static uint32_t test_random(uint32_t &state) {
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+// Per-channel version of IOFrame::Load, as it was with bool arrays
+struct ReferenceFrame {
+  int last_cv[kChannels] = { 0 };
+  int clock_countdown[kChannels] = { 0 };
+  bool gate_high[kChannels];
+  bool clocked[kChannels];
+  bool changed_cv[kChannels];
+  bool expired[kChannels];
+
+  void Load(const int *inputs) {
+    for (int i = 0; i < kChannels; ++i) {
+      gate_high[i] = inputs[i] > kGateThreshold;
+      clocked[i] = (gate_high[i] && last_cv[i] < kGateThreshold);
+      if (abs(inputs[i] - last_cv[i]) > kChangeThreshold) {
+        changed_cv[i] = 1;
+        last_cv[i] = inputs[i];
+      } else changed_cv[i] = 0;
+      expired[i] = false;
+      if (clock_countdown[i] > 0) {
+        if (--clock_countdown[i] == 0) expired[i] = true;
+      }
+    }
+  }
+};
+
+TEST(IOMaskTest, MatchesPerChannelLoad) {
+  ReferenceFrame reference;
+  int last_cv[kChannels] = { 0 };
+  int clock_countdown[kChannels] = { 0 };
+  uint32_t state = 1;
+
+  for (int tick = 0; tick < 100000; ++tick) {
+    int inputs[kChannels];
+    for (int i = 0; i < kChannels; ++i) {
+      // slow ramps around the gate threshold plus jumps and noise
+      const uint32_t r = test_random(state);
+      inputs[i] = (r & 0x100) ? int(r % 7680) - 3840 : kGateThreshold + int(r % 65) - 32;
+      if (!(r & 0x3f000) && !clock_countdown[i]) {
+        clock_countdown[i] = reference.clock_countdown[i] = 1 + (r & 0x1f);
+      }
+    }
+
+    const uint16_t gates = IOMask::Above<kChannels>(inputs, kGateThreshold);
+    const uint16_t was_high = IOMask::Above<kChannels>(last_cv, kGateThreshold - 1);
+    const uint16_t changed = IOMask::Changed<kChannels>(inputs, last_cv, kChangeThreshold);
+    const uint16_t expired = IOMask::Countdown<kChannels>(clock_countdown);
+    reference.Load(inputs);
+
+    for (int i = 0; i < kChannels; ++i) {
+      ASSERT_EQ(reference.gate_high[i], IOMask::Test(gates, i)) << "tick " << tick << " ch " << i;
+      ASSERT_EQ(reference.clocked[i], IOMask::Test(gates & ~was_high, i)) << "tick " << tick << " ch " << i;
+      ASSERT_EQ(reference.changed_cv[i], IOMask::Test(changed, i)) << "tick " << tick << " ch " << i;
+      ASSERT_EQ(reference.expired[i], IOMask::Test(expired, i)) << "tick " << tick << " ch " << i;
+      ASSERT_EQ(reference.last_cv[i], last_cv[i]);
+      ASSERT_EQ(reference.clock_countdown[i], clock_countdown[i]);
+    }
+  }
+}
+
+TEST(IOMaskTest, Test) {
+  EXPECT_TRUE(IOMask::Test(0x8001, 0));
+  EXPECT_TRUE(IOMask::Test(0x8001, 15));
+  EXPECT_FALSE(IOMask::Test(0x8001, 1));
+}
@@ -0,0 +1,161 @@
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gtest/gtest.h"
+#include "util/util_life.h"
+
+typedef util::LifeBoard<40> TestBoard;
+
+// The cell-by-cell step GameOfLife used before, on its 64x40 board of two
+// 32-bit halves per row
+struct ReferenceBoard {
+  uint64_t board[80];
+  int global_density;
+  int local_density;
+
+  bool ValueAtCell(int x, int y) const {
+    if (x > 63) x -= 64;
+    if (x < 0) x += 64;
+    if (y > 39) y -= 40;
+    if (y < 0) y += 40;
+
+    int i = y * 2;
+    if (x > 31) {
+      i += 1;
+      x -= 32;
+    }
+    return ((board[i] >> x) & 0x01);
+  }
+
+  int CountLiveNeighborsAt(int x, int y) const {
+    int count = 0;
+    for (int nx = -1; nx < 2; nx++) {
+      for (int ny = -1; ny < 2; ny++) {
+        if (!(nx == 0 && ny == 0)) count += ValueAtCell(x + nx, y + ny);
+      }
+    }
+    return count;
+  }
+
+  void AddToBoard(int x, int y) {
+    int i = y * 2;
+    int xb = x;
+    if (x > 31) {
+      i += 1;
+      xb -= 32;
+    }
+    board[i] = board[i] | (0x01 << xb);
+  }
+
+  void ProcessGameBoard(int tx, int ty) {
+    uint64_t next_gen[80];
+    global_density = 0;
+    local_density = 0;
+    for (int y = 0; y < 40; y++) {
+      next_gen[y * 2] = 0;
+      next_gen[y * 2 + 1] = 0;
+      for (int x = 0; x < 64; x++) {
+        bool live = ValueAtCell(x, y);
+        int ln = CountLiveNeighborsAt(x, y);
+        if (((ln == 2 || ln == 3) && live) || (ln == 3 && !live)) {
+          int i = y * 2;
+          int xb = x;
+          if (x > 31) {
+            i += 1;
+            xb -= 32;
+          }
+          next_gen[i] = next_gen[i] | (0x01 << xb);
+          global_density++;
+
+          if (abs(tx - x) < 8 && abs(ty - y) < 8) local_density++;
+        }
+      }
+    }
+    memcpy(&board, &next_gen, sizeof(next_gen));
+  }
+};
+
+static void RandomBoards(ReferenceBoard &reference, TestBoard &board, unsigned seed, int density) {
+  srand(seed);
+  memset(&reference, 0, sizeof(reference));
+  board.Clear();
+  for (int y = 0; y < 40; ++y) {
+    for (int x = 0; x < 64; ++x) {
+      if (rand() % 100 < density) {
+        reference.AddToBoard(x, y);
+        board.Set(x, y);
+      }
+    }
+  }
+}
+
+static void ExpectSameBoard(const ReferenceBoard &reference, const TestBoard &board) {
+  for (int y = 0; y < 40; ++y) {
+    for (int x = 0; x < 64; ++x) {
+      ASSERT_EQ(reference.ValueAtCell(x, y), board.Get(x, y)) << x << "," << y;
+    }
+  }
+}
+
+TEST(LifeBoardTest, MatchesReference) {
+  ReferenceBoard reference;
+  TestBoard board;
+  for (unsigned seed = 1; seed <= 8; ++seed) {
+    RandomBoards(reference, board, seed, 10 + 5 * seed);
+    for (int gen = 0; gen < 100; ++gen) {
+      // The traveler goes everywhere, including past the edges
+      const int tx = (gen * 7 + seed) % 64;
+      const int ty = (gen * 3 + seed) % 40;
+      reference.ProcessGameBoard(tx, ty);
+      board.Step();
+      ExpectSameBoard(reference, board);
+      ASSERT_EQ(reference.global_density, board.Count()) << seed << "/" << gen;
+      ASSERT_EQ(reference.local_density, board.CountNear(tx, ty, 8)) << seed << "/" << gen;
+    }
+  }
+}
+
+// A glider crossing every edge comes back where it started
+TEST(LifeBoardTest, Torus) {
+  TestBoard board;
+  board.Clear();
+  const int glider[5][2] = { { 1, 0 }, { 2, 1 }, { 0, 2 }, { 1, 2 }, { 2, 2 } };
+  for (auto &cell : glider) board.Set(62 + cell[0], 38 + cell[1] - 2);
+
+  uint64_t start[40];
+  for (int y = 0; y < 40; ++y) start[y] = board.row(y);
+
+  // Moves one cell diagonally every 4 generations: 64 x 40 needs lcm(64, 40)
+  for (int gen = 0; gen < 4 * 320; ++gen) {
+    board.Step();
+    ASSERT_EQ(5, board.Count()) << gen;
+  }
+  for (int y = 0; y < 40; ++y) EXPECT_EQ(start[y], board.row(y)) << y;
+}
+
+// Not a pass/fail test: time per generation, cell by cell vs. a row at a time
+TEST(LifeBoardTest, Benchmark) {
+  static const int kGenerations = 1000;
+  ReferenceBoard reference;
+  TestBoard board;
+  RandomBoards(reference, board, 42, 30);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int gen = 0; gen < kGenerations; ++gen) reference.ProcessGameBoard(32, 20);
+  auto end = std::chrono::steady_clock::now();
+  const double reference_ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+  int sum = 0;
+  start = std::chrono::steady_clock::now();
+  for (int gen = 0; gen < kGenerations; ++gen) {
+    board.Step();
+    sum += board.Count() + board.CountNear(32, 20, 8);
+  }
+  end = std::chrono::steady_clock::now();
+  const double board_ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+  printf("64x40 generation: cell by cell %.0fns, bit-sliced %.0fns (%d)\n",
+         reference_ns / kGenerations, board_ns / kGenerations, sum & 1);
+}
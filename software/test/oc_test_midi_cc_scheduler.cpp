@@ -0,0 +1,166 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/util_midi_cc_scheduler.h"
+
+typedef util::MIDIControlScheduler<4> TestScheduler;
+
+struct CC {
+  uint8_t channel, number, value;
+  bool operator==(const CC &other) const {
+    return channel == other.channel && number == other.number && value == other.value;
+  }
+};
+
+static std::ostream &operator<<(std::ostream &os, const CC &cc) {
+  return os << "{" << int(cc.channel) << ", " << int(cc.number) << ", " << int(cc.value) << "}";
+}
+
+class MIDIControlSchedulerTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    scheduler_.Init(10);
+  }
+
+  void Tick(bool hold = false) {
+    scheduler_.Process([this](uint8_t channel, uint8_t number, uint8_t value) {
+      sent_.push_back({ channel, number, value });
+    }, hold);
+  }
+
+  TestScheduler scheduler_;
+  std::vector<CC> sent_;
+};
+
+TEST_F(MIDIControlSchedulerTest, RateLimit) {
+  scheduler_.Configure(0, 2, 1, util::MIDI_CC_7BIT);
+  scheduler_.Set(0, 5 << 7);
+  Tick();
+  ASSERT_EQ(1U, sent_.size());
+  EXPECT_EQ((CC{ 2, 1, 5 }), sent_[0]);
+
+  // Changes within the interval wait, and only the latest goes out
+  for (int t = 1; t < 10; ++t) {
+    scheduler_.Set(0, (5 + t) << 7);
+    Tick();
+  }
+  EXPECT_EQ(1U, sent_.size());
+  Tick();
+  ASSERT_EQ(2U, sent_.size());
+  EXPECT_EQ((CC{ 2, 1, 14 }), sent_[1]);
+
+  // Nothing when the value doesn't change, or only below 7 bits
+  scheduler_.Set(0, (14 << 7) | 0x7f);
+  for (int t = 0; t < 100; ++t) Tick();
+  EXPECT_EQ(2U, sent_.size());
+  EXPECT_EQ(2U, scheduler_.messages());
+}
+
+TEST_F(MIDIControlSchedulerTest, OneSlotPerTick) {
+  for (int i = 0; i < 4; ++i) {
+    scheduler_.Configure(i, i, 10 + i, util::MIDI_CC_7BIT);
+    scheduler_.Set(i, 100 << 7);
+  }
+  for (int t = 0; t < 4; ++t) {
+    Tick();
+    ASSERT_EQ(size_t(t + 1), sent_.size());
+    EXPECT_EQ(10 + t, sent_[t].number);
+  }
+
+  // A busy slot doesn't starve the others
+  for (int t = 0; t < 200; ++t) {
+    scheduler_.Set(0, (t % 100) << 7);
+    if (t == 50) scheduler_.Set(3, 1 << 7);
+    Tick();
+  }
+  int slot3 = 0;
+  for (const CC &cc : sent_) slot3 += cc.number == 13;
+  EXPECT_EQ(2, slot3);
+}
+
+TEST_F(MIDIControlSchedulerTest, Hold) {
+  scheduler_.Configure(0, 0, 1, util::MIDI_CC_7BIT);
+  scheduler_.Set(0, 64 << 7);
+  for (int t = 0; t < 20; ++t) Tick(true);
+  EXPECT_TRUE(sent_.empty());
+  Tick();
+  EXPECT_EQ(1U, sent_.size());
+}
+
+TEST_F(MIDIControlSchedulerTest, FourteenBit) {
+  scheduler_.Configure(0, 0, 1, util::MIDI_CC_14BIT);
+  scheduler_.Set(0, (3 << 7) | 9);
+  Tick();
+  std::vector<CC> expected = { { 0, 1, 3 }, { 0, 33, 9 } };
+  EXPECT_EQ(expected, sent_);
+
+  // Only the LSB changed
+  sent_.clear();
+  scheduler_.Set(0, (3 << 7) | 10);
+  for (int t = 0; t < 10; ++t) Tick();
+  expected = { { 0, 33, 10 } };
+  EXPECT_EQ(expected, sent_);
+
+  // No LSB controller above 31
+  sent_.clear();
+  scheduler_.Configure(0, 0, 74, util::MIDI_CC_14BIT);
+  for (int t = 0; t < 10; ++t) Tick();
+  expected = { { 0, 74, 3 } };
+  EXPECT_EQ(expected, sent_);
+}
+
+TEST_F(MIDIControlSchedulerTest, NRPN) {
+  scheduler_.Configure(0, 1, 20, util::MIDI_CC_NRPN);
+  scheduler_.Set(0, (1 << 7) | 2);
+  Tick();
+  std::vector<CC> expected = { { 1, 99, 0 }, { 1, 98, 20 }, { 1, 6, 1 }, { 1, 38, 2 } };
+  EXPECT_EQ(expected, sent_);
+
+  // Same parameter: no reselect, no MSB
+  sent_.clear();
+  scheduler_.Set(0, (1 << 7) | 3);
+  for (int t = 0; t < 10; ++t) Tick();
+  expected = { { 1, 38, 3 } };
+  EXPECT_EQ(expected, sent_);
+
+  // Another parameter on the channel: select, and the whole value
+  sent_.clear();
+  scheduler_.Configure(1, 1, 21, util::MIDI_CC_NRPN);
+  scheduler_.Set(1, 5);
+  Tick();
+  expected = { { 1, 99, 0 }, { 1, 98, 21 }, { 1, 6, 0 }, { 1, 38, 5 } };
+  EXPECT_EQ(expected, sent_);
+}
+
+// Not a pass/fail test: messages for a slow LFO over a second, sent on
+// every 7-bit change as before vs. through the scheduler at 100Hz
+TEST_F(MIDIControlSchedulerTest, Bandwidth) {
+  static const int kTicks = 16667;
+  for (util::MIDIControlResolution resolution : { util::MIDI_CC_7BIT, util::MIDI_CC_14BIT, util::MIDI_CC_NRPN }) {
+    scheduler_.Init(170);
+    scheduler_.Configure(0, 0, 1, resolution);
+    int every_change = 0, last = -1;
+    uint16_t value = 0;
+    for (int t = 0; t < kTicks; ++t) {
+      value = uint16_t(8191.5 + 8191.5 * sin(2 * M_PI * 2 * t / kTicks)); // 2Hz
+      if ((value >> 7) != last) {
+        ++every_change;
+        last = value >> 7;
+      }
+      scheduler_.Set(0, value);
+      Tick();
+    }
+    for (int t = 0; t < 170; ++t) Tick();
+
+    // Ends on the latest value
+    const CC &cc = sent_.back();
+    EXPECT_EQ(resolution == util::MIDI_CC_7BIT ? value >> 7 : value & 0x7f, cc.value);
+    EXPECT_LE(scheduler_.messages(), 4U * (kTicks / 170 + 2));
+    printf("2Hz LFO, %s: %d messages on every change, %u scheduled at 100Hz\n",
+           resolution == util::MIDI_CC_7BIT ? "7-bit" : resolution == util::MIDI_CC_14BIT ? "14-bit" : "NRPN",
+           every_change, (unsigned)scheduler_.messages());
+    sent_.clear();
+  }
+}
@@ -0,0 +1,181 @@
+#include <stdint.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/util_midi_router.h"
+
+enum { USB, HOST, DIN, INTERNAL, PORTS, OUTPUTS = INTERNAL };
+typedef util::MIDIRouter<PORTS, OUTPUTS, 8> TestRouter;
+
+static util::MIDIMessage NoteOn(int channel, int note) { return { uint8_t(0x90 | channel), uint8_t(note), 100 }; }
+static util::MIDIMessage PitchBend(int channel, int value) { return { uint8_t(0xe0 | channel), uint8_t(value & 0x7f), uint8_t(value >> 7) }; }
+static const util::MIDIMessage kClock = { 0xf8, 0, 0 };
+
+// Serial port stand-in with a limited transmit buffer
+struct FakeSerial {
+  std::vector<uint8_t> bytes;
+  int room = 1000;
+
+  int availableForWrite() const { return room; }
+  size_t write(const uint8_t *data, size_t length) {
+    bytes.insert(bytes.end(), data, data + length);
+    room -= length;
+    return length;
+  }
+};
+
+static std::vector<util::MIDIMessage> DrainAll(TestRouter &router, int port) {
+  std::vector<util::MIDIMessage> sent;
+  router.Drain(port, [&sent](const util::MIDIMessage &message) {
+    sent.push_back(message);
+    return true;
+  }, 100);
+  return sent;
+}
+
+class MIDIRouterTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    router_.Init();
+  }
+
+  TestRouter router_;
+};
+
+TEST_F(MIDIRouterTest, Filters) {
+  // Open by default, but never back to the source
+  router_.Route(USB, NoteOn(0, 60));
+  EXPECT_EQ(0U, router_.pending(USB));
+  EXPECT_EQ(1U, router_.pending(HOST));
+  EXPECT_EQ(1U, router_.pending(DIN));
+  EXPECT_TRUE(router_.Passes(USB, INTERNAL, NoteOn(0, 60)));
+  EXPECT_FALSE(router_.Passes(INTERNAL, INTERNAL, NoteOn(0, 60)));
+
+  // Types and channels per connection; system messages ignore channels
+  router_.route(USB, HOST).types = util::MIDI_ROUTE_ALL & ~util::MIDI_ROUTE_NOTE;
+  router_.route(USB, DIN).channels = 1 << 1;
+  router_.Route(USB, NoteOn(0, 61));
+  router_.Route(USB, NoteOn(1, 62));
+  router_.Route(USB, kClock);
+  EXPECT_EQ(2U, router_.pending(HOST)); // first note, clock
+  EXPECT_EQ(3U, router_.pending(DIN)); // first note, channel 2 note, clock
+  EXPECT_EQ(2U, router_.stats(HOST).filtered);
+  EXPECT_EQ(1U, router_.stats(DIN).filtered);
+
+  const auto din = DrainAll(router_, DIN);
+  ASSERT_EQ(3U, din.size());
+  EXPECT_EQ(0xf8, din[0].status); // realtime first
+  EXPECT_EQ(60, din[1].data1);
+  EXPECT_EQ(62, din[2].data1);
+  EXPECT_EQ(3U, router_.stats(DIN).sent);
+  EXPECT_EQ(0U, router_.pending(DIN));
+}
+
+TEST_F(MIDIRouterTest, RealtimeFirst) {
+  for (int i = 0; i < 5; ++i) router_.Queue(USB, NoteOn(0, 60 + i));
+  router_.Queue(USB, kClock);
+  router_.Queue(USB, { 0xfa, 0, 0 });
+
+  const auto sent = DrainAll(router_, USB);
+  ASSERT_EQ(7U, sent.size());
+  EXPECT_EQ(0xf8, sent[0].status);
+  EXPECT_EQ(0xfa, sent[1].status);
+  for (int i = 0; i < 5; ++i) EXPECT_EQ(60 + i, sent[2 + i].data1);
+}
+
+TEST_F(MIDIRouterTest, CoalescePitchBend) {
+  router_.Queue(USB, PitchBend(0, 100));
+  router_.Queue(USB, PitchBend(1, 200));
+  router_.Queue(USB, PitchBend(0, 300)); // replaces 100; channel 1 in between is fine
+  router_.Queue(USB, PitchBend(1, 400));
+  EXPECT_EQ(2U, router_.pending(USB));
+  EXPECT_EQ(2U, router_.stats(USB).coalesced);
+
+  // Something else on the channel in between keeps the order
+  router_.Queue(USB, NoteOn(0, 60));
+  router_.Queue(USB, PitchBend(0, 500));
+  EXPECT_EQ(4U, router_.pending(USB));
+
+  const auto sent = DrainAll(router_, USB);
+  ASSERT_EQ(4U, sent.size());
+  EXPECT_EQ(PitchBend(0, 300).data1, sent[0].data1);
+  EXPECT_EQ(PitchBend(0, 300).data2, sent[0].data2);
+  EXPECT_EQ(PitchBend(1, 400).data1, sent[1].data1);
+  EXPECT_EQ(0x90, sent[2].status);
+  EXPECT_EQ(PitchBend(0, 500).data1, sent[3].data1);
+
+  // Nothing coalesces with what has already gone out
+  router_.Queue(USB, PitchBend(0, 600));
+  EXPECT_EQ(1U, router_.pending(USB));
+}
+
+TEST_F(MIDIRouterTest, Drops) {
+  for (int i = 0; i < 10; ++i) router_.Queue(DIN, NoteOn(0, i));
+  for (int i = 0; i < 10; ++i) router_.Queue(DIN, kClock);
+  EXPECT_EQ(8U + TestRouter::kRealtimeQueueSize, router_.pending(DIN));
+  EXPECT_EQ(2U + 10 - TestRouter::kRealtimeQueueSize, router_.stats(DIN).dropped);
+
+  // A device that won't take anything keeps the queue
+  router_.Drain(DIN, [](const util::MIDIMessage &) { return false; }, 100);
+  EXPECT_EQ(8U + TestRouter::kRealtimeQueueSize, router_.pending(DIN));
+
+  router_.ClearQueue(DIN);
+  EXPECT_EQ(0U, router_.pending(DIN));
+}
+
+TEST_F(MIDIRouterTest, RunningStatus) {
+  FakeSerial serial;
+  router_.Queue(DIN, NoteOn(0, 60));
+  router_.Queue(DIN, NoteOn(0, 61));
+  router_.Queue(DIN, kClock); // goes first, doesn't matter
+  router_.Queue(DIN, NoteOn(0, 62));
+  router_.Queue(DIN, { 0xf2, 1, 2 }); // song position ends running status
+  router_.Queue(DIN, NoteOn(0, 63));
+  router_.Queue(DIN, { 0xc0, 5, 0 });
+  router_.DrainBytes(DIN, serial);
+
+  const std::vector<uint8_t> expected = {
+    0xf8, 0x90, 60, 100, 61, 100, 62, 100, 0xf2, 1, 2, 0x90, 63, 100, 0xc0, 5
+  };
+  EXPECT_EQ(expected, serial.bytes);
+  EXPECT_EQ(2U, router_.stats(DIN).running_status);
+  EXPECT_EQ(7U, router_.stats(DIN).sent);
+
+  // The queue ran dry, so the status goes out again
+  serial.bytes.clear();
+  router_.Queue(DIN, { 0xc0, 6, 0 });
+  router_.DrainBytes(DIN, serial);
+  EXPECT_EQ(std::vector<uint8_t>({ 0xc0, 6 }), serial.bytes);
+
+  // Realtime between messages keeps it
+  serial.bytes.clear();
+  router_.Queue(DIN, NoteOn(0, 64));
+  router_.Queue(DIN, NoteOn(0, 65));
+  serial.room = 3;
+  router_.DrainBytes(DIN, serial);
+  router_.Queue(DIN, kClock);
+  serial.room = 100;
+  router_.DrainBytes(DIN, serial);
+  EXPECT_EQ(std::vector<uint8_t>({ 0x90, 64, 100, 0xf8, 65, 100 }), serial.bytes);
+}
+
+// Only whole messages go out, and what doesn't fit waits for the next poll
+TEST_F(MIDIRouterTest, SerialRoom) {
+  FakeSerial serial;
+  for (int i = 0; i < 4; ++i) router_.Queue(DIN, NoteOn(0, 60 + i));
+
+  serial.room = 5; // the first message and one with running status
+  router_.DrainBytes(DIN, serial);
+  EXPECT_EQ(std::vector<uint8_t>({ 0x90, 60, 100, 61, 100 }), serial.bytes);
+  EXPECT_EQ(2U, router_.pending(DIN));
+
+  serial.room = 1;
+  router_.DrainBytes(DIN, serial);
+  EXPECT_EQ(5U, serial.bytes.size());
+
+  // Still back to back, so the status isn't repeated
+  serial.bytes.clear();
+  serial.room = 100;
+  router_.DrainBytes(DIN, serial);
+  EXPECT_EQ(std::vector<uint8_t>({ 62, 100, 63, 100 }), serial.bytes);
+  EXPECT_EQ(0U, router_.pending(DIN));
+}
@@ -0,0 +1,212 @@
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "gtest/gtest.h"
+#include "util/util_pagestorage.h"
+
+// EEPROM stand-in that counts the bytes actually changed, and complains
+// about any write while a snapshot is being taken
+struct FakeEEPROM {
+  static const size_t LENGTH = 4096;
+  static uint8_t cells[LENGTH];
+  static size_t bytes_written;
+  static size_t write_calls;
+  static size_t write_budget; // simulated power loss
+  static bool in_snapshot;
+
+  static void Reset() {
+    memset(cells, 0xff, sizeof(cells));
+    bytes_written = write_calls = 0;
+    write_budget = SIZE_MAX;
+    in_snapshot = false;
+  }
+
+  static void update(size_t addr, const void *data, size_t length) {
+    EXPECT_FALSE(in_snapshot);
+    EXPECT_LE(addr + length, LENGTH);
+    ++write_calls;
+    const uint8_t *src = (const uint8_t *)data;
+    for (size_t i = 0; i < length && write_budget; ++i) {
+      if (cells[addr + i] != src[i]) {
+        cells[addr + i] = src[i];
+        ++bytes_written;
+        --write_budget;
+      }
+    }
+  }
+
+  static void write(size_t addr, const void *data, size_t length) {
+    update(addr, data, length);
+  }
+
+  static void read(size_t addr, void *data, size_t length) {
+    memcpy(data, cells + addr, length);
+  }
+};
+
+const size_t FakeEEPROM::LENGTH;
+uint8_t FakeEEPROM::cells[FakeEEPROM::LENGTH];
+size_t FakeEEPROM::bytes_written;
+size_t FakeEEPROM::write_calls;
+size_t FakeEEPROM::write_budget;
+bool FakeEEPROM::in_snapshot;
+
+struct TestData {
+  static constexpr uint32_t FOURCC = FOURCC<'T','S','T',1>::value;
+  uint8_t bytes[500];
+};
+
+typedef PageStorage<FakeEEPROM, 64, 64 + 4 * 520, TestData> TestStorage;
+
+class PageStorageTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    FakeEEPROM::Reset();
+    storage_.Init();
+    memset(&data_, 0, sizeof(data_));
+  }
+
+  // Stand-in for save_app_data(): fill in the data and snapshot it
+  bool Snapshot(uint8_t fill) {
+    FakeEEPROM::in_snapshot = true;
+    memset(data_.bytes, fill, sizeof(data_.bytes));
+    const bool changed = storage_.BeginSave(data_);
+    FakeEEPROM::in_snapshot = false;
+    return changed;
+  }
+
+  int PollToEnd(size_t max_bytes) {
+    int polls = 0;
+    while (storage_.Poll(max_bytes)) ++polls;
+    return polls + 1;
+  }
+
+  TestStorage storage_;
+  TestData data_;
+};
+
+TEST_F(PageStorageTest, BackgroundSave) {
+  EXPECT_EQ(4U, size_t(TestStorage::PAGES));
+
+  EXPECT_TRUE(Snapshot(0x11));
+  EXPECT_TRUE(storage_.busy());
+  EXPECT_EQ(0U, FakeEEPROM::write_calls);
+
+  // The caller's copy can change right away
+  memset(data_.bytes, 0x22, sizeof(data_.bytes));
+
+  const int polls = PollToEnd(16);
+  EXPECT_FALSE(storage_.busy());
+  EXPECT_EQ(int((TestStorage::PAGESIZE + 15) / 16), polls);
+
+  TestStorage loader;
+  TestData loaded;
+  ASSERT_TRUE(loader.Load(loaded));
+  EXPECT_EQ(0, loader.page_index());
+  for (uint8_t b : loaded.bytes) ASSERT_EQ(0x11, b);
+
+  // Unchanged data writes nothing
+  const size_t written = FakeEEPROM::bytes_written;
+  EXPECT_FALSE(Snapshot(0x11));
+  EXPECT_FALSE(storage_.busy());
+  EXPECT_FALSE(storage_.Poll(16));
+  EXPECT_EQ(written, FakeEEPROM::bytes_written);
+}
+
+// Each poll only writes what it's given, so a slow EEPROM write can't hold up loop()
+TEST_F(PageStorageTest, BoundedPolls) {
+  Snapshot(0x5a);
+  size_t total = 0;
+  while (storage_.busy()) {
+    const size_t before = FakeEEPROM::bytes_written;
+    storage_.Poll(8);
+    EXPECT_LE(FakeEEPROM::bytes_written - before, 8U);
+    total += FakeEEPROM::bytes_written - before;
+  }
+  EXPECT_EQ(FakeEEPROM::bytes_written, total);
+  EXPECT_GE(total, sizeof(TestData));
+}
+
+TEST_F(PageStorageTest, SaveDuringWrite) {
+  Snapshot(0x01);
+  PollToEnd(64);
+  Snapshot(0x02);
+  storage_.Poll(100);
+  EXPECT_TRUE(storage_.busy());
+
+  // Restarts in the same page with the newest data
+  EXPECT_TRUE(Snapshot(0x03));
+  PollToEnd(64);
+
+  TestStorage loader;
+  TestData loaded;
+  ASSERT_TRUE(loader.Load(loaded));
+  EXPECT_EQ(1, loader.page_index());
+  for (uint8_t b : loaded.bytes) ASSERT_EQ(0x03, b);
+}
+
+TEST_F(PageStorageTest, PowerLoss) {
+  Snapshot(0x01);
+  PollToEnd(64);
+
+  // Cut the write short anywhere, including in the header: the old page
+  // must still load
+  for (size_t budget = 1; budget < TestStorage::PAGESIZE; budget += 37) {
+    Snapshot(0x02);
+    FakeEEPROM::write_budget = budget;
+    PollToEnd(16);
+    FakeEEPROM::write_budget = SIZE_MAX;
+
+    TestStorage loader;
+    TestData loaded;
+    ASSERT_TRUE(loader.Load(loaded)) << budget;
+    EXPECT_EQ(0, loader.page_index()) << budget;
+    for (uint8_t b : loaded.bytes) ASSERT_EQ(0x01, b) << budget;
+
+    // Back to where it was for the next try
+    storage_.Load(data_);
+    memset(FakeEEPROM::cells + 64 + TestStorage::PAGESIZE, 0xff, TestStorage::PAGESIZE);
+  }
+}
+
+TEST_F(PageStorageTest, SaveMatchesBackground) {
+  TestStorage other;
+  other.Init();
+  Snapshot(0x33);
+  PollToEnd(7);
+  uint8_t background[FakeEEPROM::LENGTH];
+  memcpy(background, FakeEEPROM::cells, sizeof(background));
+
+  FakeEEPROM::Reset();
+  memset(data_.bytes, 0x33, sizeof(data_.bytes));
+  EXPECT_TRUE(other.Save(data_));
+  EXPECT_FALSE(other.busy());
+  EXPECT_EQ(0, memcmp(background, FakeEEPROM::cells, sizeof(background)));
+}
+
+// Not a pass/fail test: how long the snapshot (the part that holds off the
+// ISR) takes compared to a blocking save. The fake EEPROM writes at RAM
+// speed, so the bytes a blocking save writes are the better measure there.
+TEST_F(PageStorageTest, Benchmark) {
+  static const int kIterations = 1 << 14;
+  double snapshot_ns = 0, save_ns = 0;
+  size_t save_bytes = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    Snapshot(i);
+    auto end = std::chrono::steady_clock::now();
+    snapshot_ns += std::chrono::duration<double, std::nano>(end - start).count();
+    PollToEnd(16);
+
+    memset(data_.bytes, i + 1, sizeof(data_.bytes));
+    const size_t before = FakeEEPROM::bytes_written;
+    start = std::chrono::steady_clock::now();
+    storage_.Save(data_);
+    end = std::chrono::steady_clock::now();
+    save_bytes += FakeEEPROM::bytes_written - before;
+    save_ns += std::chrono::duration<double, std::nano>(end - start).count();
+  }
+  printf("%u byte page: snapshot %.1fns (no writes), blocking save %.1fns (%u bytes written)\n",
+         (unsigned)TestStorage::PAGESIZE, snapshot_ns / kIterations, save_ns / kIterations,
+         (unsigned)(save_bytes / kIterations));
+}
@@ -1,3 +1,6 @@
+#include <chrono>
+#include <stdio.h>
+#include <functional>
 #include "gtest/gtest.h"
 #include "braids_quantizer.h"
 #include "braids_quantizer_scales.h"
@@ -39,3 +42,256 @@ TEST_F(QuantizerTest, SingleNote) {
   EXPECT_EQ(0, quantizer_.Process(-128));
   EXPECT_EQ(0, quantizer_.Process(-kOctave/2));
 }
+
+static const int kNumBraidsScales = sizeof(braids::scales) / sizeof(braids::scales[0]);
+
+static uint32_t test_random(uint32_t &state) {
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+static uint16_t test_mask(uint32_t &state, const braids::Scale &scale) {
+  uint16_t mask;
+  do {
+    mask = test_random(state);
+  } while (!(mask & ~(0xffff << scale.num_notes)));
+  return mask;
+}
+
+// Every requantize through the table must match the search, including the
+// hysteresis state that decides when the next requantize happens.
+TEST(QuantizerLookupTableTest, MatchesSearch) {
+  braids::Quantizer search, lookup;
+  braids::QuantizerLookupTable table;
+  uint32_t state = 0x5eed;
+  int valid_tables = 0, num_configs = 0;
+
+  search.Init();
+  lookup.Init();
+  lookup.EnableLookupTable(&table);
+
+  for (int s = 1; s < kNumBraidsScales; ++s) {
+    const braids::Scale &scale = braids::scales[s];
+    for (int m = 0; m < 8; ++m) {
+      const uint16_t mask = m ? test_mask(state, scale) : 0xffff;
+      search.Configure(scale, mask);
+      lookup.Configure(scale, mask);
+      ++num_configs;
+      if (table.valid()) ++valid_tables;
+
+      // Every pitch over a few octaves, always requantizing
+      for (int32_t pitch = -3 * scale.span; pitch <= 4 * scale.span; ++pitch) {
+        search.Requantize();
+        lookup.Requantize();
+        ASSERT_EQ(search.Process(pitch), lookup.Process(pitch))
+          << "scale " << s << " mask " << mask << " pitch " << pitch;
+        ASSERT_EQ(search.GetLatestNoteNumber(), lookup.GetLatestNoteNumber());
+      }
+
+      // Random walk with jumps, root and transpose
+      int32_t pitch = 0;
+      for (int i = 0; i < 5000; ++i) {
+        const uint32_t r = test_random(state);
+        if (!(r & 0xff))
+          pitch = (int32_t)(r % (16 * kOctave)) - 6 * kOctave;
+        else
+          pitch += (int32_t)(r % 65) - 32;
+        const int32_t root = ((r >> 8) % 12) << 7;
+        const int32_t transpose = (int32_t)((r >> 12) % 7) - 3;
+        ASSERT_EQ(search.Process(pitch, root, transpose), lookup.Process(pitch, root, transpose))
+          << "scale " << s << " mask " << mask << " pitch " << pitch;
+        ASSERT_EQ(search.GetLatestNoteNumber(), lookup.GetLatestNoteNumber());
+      }
+    }
+  }
+
+  // Make sure the table path is what was actually tested
+  EXPECT_GT(valid_tables * 10, num_configs * 9) << valid_tables << "/" << num_configs;
+}
+
+TEST(QuantizerLookupTableTest, Semitones) {
+  braids::Quantizer quantizer;
+  braids::QuantizerLookupTable table;
+  quantizer.Init();
+  quantizer.EnableLookupTable(&table);
+  quantizer.Configure(braids::scales[1], 0xffff);
+  EXPECT_TRUE(table.valid());
+
+  quantizer.EnableLookupTable(nullptr);
+  quantizer.Configure(braids::scales[2], 0xffff);
+  EXPECT_TRUE(table.valid()); // untouched once detached
+}
+
+// Not a pass/fail test: compares requantize cost with and without the table.
+TEST(QuantizerLookupTableTest, Benchmark) {
+  static const int kIterations = 1 << 20;
+  braids::Quantizer quantizer;
+  braids::QuantizerLookupTable table;
+  quantizer.Init();
+
+  for (int s : { 1, 2, kNumBraidsScales - 1 }) {
+    const braids::Scale &scale = braids::scales[s];
+    double ns[2];
+    for (int use_table = 0; use_table < 2; ++use_table) {
+      quantizer.EnableLookupTable(use_table ? &table : nullptr);
+      quantizer.Configure(scale, 0xffff);
+
+      uint32_t state = 1;
+      int32_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kIterations; ++i) {
+        quantizer.Requantize();
+        sum += quantizer.Process((int32_t)(test_random(state) % (8 * kOctave)) - 4 * kOctave);
+      }
+      auto end = std::chrono::steady_clock::now();
+      ns[use_table] = std::chrono::duration<double, std::nano>(end - start).count() / kIterations;
+      EXPECT_NE(0, sum);
+    }
+    printf("scale %3d (%2u notes): search %.1fns, table %.1fns%s\n",
+           s, (unsigned)scale.num_notes, ns[0], ns[1], table.valid() ? "" : " (no table)");
+  }
+}
+
+TEST(QuantizerBankTest, SharesTables) {
+  braids::Quantizer quantizers[8];
+  braids::QuantizerBank<8, 4> bank(quantizers);
+  for (auto &q : quantizers) q.Init();
+
+  for (int ch = 0; ch < 8; ++ch)
+    bank.Configure(ch, braids::scales[1]);
+  // Tables only come with Poll()
+  EXPECT_EQ(0, bank.tables_in_use());
+  EXPECT_EQ(-1, bank.table_index(0));
+  bank.Poll();
+  EXPECT_EQ(1, bank.tables_in_use());
+  for (int ch = 0; ch < 8; ++ch)
+    EXPECT_EQ(0, bank.table_index(ch));
+
+  // Moving one channel away takes a new table, moving it back frees it
+  bank.Configure(3, braids::scales[2]);
+  bank.Poll();
+  EXPECT_EQ(2, bank.tables_in_use());
+  EXPECT_EQ(0, bank.table_index(0));
+  EXPECT_EQ(1, bank.table_index(3));
+  bank.Configure(3, braids::scales[1]);
+  bank.Poll();
+  EXPECT_EQ(1, bank.tables_in_use());
+  EXPECT_EQ(0, bank.table_index(3));
+
+  // The last user of a table reuses it
+  bank.Configure(3, braids::scales[2], 0x0f);
+  bank.Poll();
+  EXPECT_EQ(1, bank.table_index(3));
+  bank.Configure(3, braids::scales[3]);
+  bank.Poll();
+  EXPECT_EQ(1, bank.table_index(3));
+
+  // Same scale, different mask is a different configuration
+  bank.Configure(4, braids::scales[1], 0x0fff);
+  bank.Poll();
+  EXPECT_EQ(0, bank.table_index(4)); // all 12 notes, same as 0xffff
+  bank.Configure(4, braids::scales[1], 0x0555);
+  bank.Poll();
+  EXPECT_EQ(3, bank.tables_in_use());
+
+  // Out of tables: falls back to searching
+  bank.Configure(5, braids::scales[4]);
+  bank.Configure(6, braids::scales[5]);
+  bank.Poll();
+  EXPECT_EQ(4, bank.tables_in_use());
+  EXPECT_EQ(-1, bank.table_index(6));
+
+  // Configuring a quantizer directly detaches it
+  quantizers[0].Configure(braids::scales[6]);
+  EXPECT_EQ(-1, bank.table_index(0));
+  EXPECT_EQ(0, bank.table_index(1));
+}
+
+// Stands in for the ISR: runs a callback when the lock is taken for the nth time
+struct HookLock {
+  static int countdown;
+  static std::function<void()> hook;
+  HookLock() {
+    if (countdown > 0 && !--countdown) hook();
+  }
+};
+int HookLock::countdown = 0;
+std::function<void()> HookLock::hook;
+
+TEST(QuantizerBankTest, ReconfiguredDuringBuild) {
+  braids::Quantizer quantizers[2];
+  braids::QuantizerBank<2, 2, HookLock> bank(quantizers);
+  for (auto &q : quantizers) q.Init();
+
+  bank.Configure(0, braids::scales[1]);
+  // Poll() takes the lock to read the pending channels, to compare, and to
+  // attach the table it built; the ISR changes the scale just before that
+  HookLock::hook = [&] { bank.Configure(0, braids::scales[2]); };
+  HookLock::countdown = 3;
+  bank.Poll();
+  EXPECT_EQ(0, HookLock::countdown);
+  EXPECT_EQ(-1, bank.table_index(0));
+
+  // Still pending, with the new scale
+  bank.Poll();
+  ASSERT_EQ(0, bank.table_index(0));
+  braids::Quantizer reference;
+  reference.Init();
+  reference.Configure(braids::scales[2]);
+  for (int32_t pitch = -2 * kOctave; pitch < 2 * kOctave; pitch += 7) {
+    quantizers[0].Requantize();
+    reference.Requantize();
+    ASSERT_EQ(reference.Process(pitch), quantizers[0].Process(pitch)) << pitch;
+  }
+}
+
+// Whatever the sharing, every channel must behave like its own quantizer
+TEST(QuantizerBankTest, MatchesSearch) {
+  static const int kChannels = 8;
+  braids::Quantizer quantizers[kChannels], reference[kChannels];
+  braids::QuantizerBank<kChannels, 3> bank(quantizers);
+  uint32_t state = 0xba4c;
+
+  for (int ch = 0; ch < kChannels; ++ch) {
+    quantizers[ch].Init();
+    reference[ch].Init();
+    bank.Configure(ch, braids::scales[1]);
+    reference[ch].Configure(braids::scales[1]);
+  }
+
+  int32_t pitch[kChannels], root[kChannels], transpose[kChannels], out[kChannels];
+  for (int i = 0; i < 200000; ++i) {
+    const uint32_t r = test_random(state);
+    if (!(r % 500)) {
+      // a few scales, so channels often share
+      const int ch = (r >> 9) % kChannels;
+      const braids::Scale &scale = braids::scales[1 + (r >> 12) % 4];
+      const uint16_t mask = (r >> 14) & 1 ? 0xffff : test_mask(state, scale);
+      bank.Configure(ch, scale, mask);
+      reference[ch].Configure(scale, mask);
+      reference[ch].Requantize();
+    }
+    // Tables arrive a while after configuring, and don't change results
+    if (!(r % 300)) bank.Poll();
+
+    const uint32_t channels = test_random(state) & 0xff;
+    for (int ch = 0; ch < kChannels; ++ch) {
+      const uint32_t c = test_random(state);
+      pitch[ch] = (int32_t)(c % (10 * kOctave)) - 4 * kOctave;
+      root[ch] = ((c >> 16) % 12) << 7;
+      transpose[ch] = (int32_t)((c >> 20) % 5) - 2;
+      out[ch] = -1;
+    }
+    bank.Process(channels, pitch, root, transpose, out);
+    for (int ch = 0; ch < kChannels; ++ch) {
+      if (channels & (1u << ch)) {
+        ASSERT_EQ(reference[ch].Process(pitch[ch], root[ch], transpose[ch]), out[ch])
+          << "step " << i << " channel " << ch;
+        ASSERT_EQ(reference[ch].GetLatestNoteNumber(), quantizers[ch].GetLatestNoteNumber());
+      } else {
+        ASSERT_EQ(-1, out[ch]);
+      }
+    }
+  }
+  EXPECT_LE(bank.tables_in_use(), 3);
+}
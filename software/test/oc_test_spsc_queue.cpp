@@ -0,0 +1,93 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/util_spsc_queue.h"
+
+// Same shape as HS::MIDIEvent
+struct TestEvent {
+  uint8_t message;
+  uint8_t channel;
+  uint8_t data1;
+  uint8_t data2;
+};
+
+static TestEvent MakeEvent(uint32_t n) {
+  return { uint8_t(0x80 | ((n >> 21) & 0x7f)), uint8_t(n >> 14), uint8_t((n >> 7) & 0x7f), uint8_t(n & 0x7f) };
+}
+
+static uint32_t EventNumber(const TestEvent &event) {
+  return (uint32_t(event.message & 0x7f) << 21) | (uint32_t(event.channel) << 14) | (event.data1 << 7) | event.data2;
+}
+
+TEST(SPSCQueueTest, FillAndDrain) {
+  util::SPSCQueue<TestEvent, 16> queue;
+  TestEvent event;
+  EXPECT_FALSE(queue.Pop(event));
+  EXPECT_EQ(16u, queue.writable());
+
+  for (uint32_t n = 0; n < 16; ++n)
+    EXPECT_TRUE(queue.Push(MakeEvent(n)));
+  EXPECT_FALSE(queue.Push(MakeEvent(16)));
+  EXPECT_EQ(16u, queue.readable());
+
+  for (uint32_t n = 0; n < 16; ++n) {
+    ASSERT_TRUE(queue.Pop(event));
+    EXPECT_EQ(n, EventNumber(event));
+  }
+  EXPECT_FALSE(queue.Pop(event));
+}
+
+TEST(SPSCQueueTest, Flush) {
+  util::SPSCQueue<TestEvent, 8> queue;
+  for (uint32_t n = 0; n < 5; ++n)
+    queue.Push(MakeEvent(n));
+  queue.Flush();
+  EXPECT_EQ(0u, queue.readable());
+  TestEvent event;
+  EXPECT_FALSE(queue.Pop(event));
+  queue.Push(MakeEvent(42));
+  ASSERT_TRUE(queue.Pop(event));
+  EXPECT_EQ(42u, EventNumber(event));
+}
+
+// loop() pushing bursts while the ISR pops a bounded number per tick: every
+// event either arrives in order or is counted as dropped, never corrupted
+TEST(SPSCQueueTest, Stress) {
+  static const uint32_t kEvents = 2000000;
+  static const int kEventsPerTick = 4;
+  util::SPSCQueue<TestEvent, 128> queue;
+
+  std::atomic<bool> done(false);
+  uint32_t overflow = 0;
+  std::thread producer([&] {
+    for (uint32_t n = 0; n < kEvents; ++n) {
+      if (!queue.Push(MakeEvent(n)))
+        ++overflow;
+      if (!(n & 0xfff)) std::this_thread::yield(); // bursty
+    }
+    done = true;
+  });
+
+  uint32_t received = 0, expected = 0, out_of_order = 0;
+  uint64_t ticks = 0;
+  for (;;) {
+    const bool finished = done;
+    TestEvent event;
+    int popped = 0;
+    while (popped < kEventsPerTick && queue.Pop(event)) {
+      const uint32_t n = EventNumber(event);
+      if (n < expected) ++out_of_order;
+      expected = n + 1;
+      ++received;
+      ++popped;
+    }
+    ++ticks;
+    if (finished && !popped && !queue.readable()) break;
+  }
+  producer.join();
+
+  EXPECT_EQ(0u, out_of_order);
+  EXPECT_EQ(kEvents, received + overflow);
+  printf("%u events, %u dropped, %llu ticks\n", kEvents, overflow, (unsigned long long)ticks);
+}
@@ -0,0 +1,176 @@
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "gtest/gtest.h"
+
+// Just enough Arduino for the vector oscillator
+typedef uint8_t byte;
+#define DMAMEM
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#include "util/util_macros.h"
+
+#define VECTOR_OSC_COMPILED
+#include "vector_osc/HSVectorOscillator.h"
+#include "vector_osc/WaveformManager.h"
+
+static const int kScale = (12 << 7) * 3; // VectorLFO
+
+static void MakePair(int waveform, VectorOscillator &walker, VectorOscillator &compiled) {
+  walker = WaveformManager::VectorOscillatorFromWaveform(waveform);
+  walker.Compile(0);
+  compiled = WaveformManager::VectorOscillatorFromWaveform(waveform);
+  for (VectorOscillator *osc : { &walker, &compiled }) {
+    osc->SetScale(kScale);
+  }
+}
+
+// The walker accumulates a rounded rise per tick and rounds each segment down
+// to whole ticks, so its cycles come out up to a tick per segment short; the
+// compiled oscillator keeps exact time. Over the first cycle, compare each
+// compiled sample against the walker's range over a few ticks around it; after
+// that just compare the number of cycles.
+TEST(VectorOscillatorTest, CompiledMatchesWalker) {
+  static const int kTicks = 20000;
+  std::vector<int32_t> expected(kTicks), actual(kTicks);
+
+  for (int waveform = HS::Triangle; waveform < HS::Triangle + HS::WAVEFORM_LIBRARY_COUNT; ++waveform) {
+    for (uint32_t frequency : { 200u, 1000u, 4400u }) {
+      VectorOscillator walker, compiled;
+      MakePair(waveform, walker, compiled);
+      walker.SetFrequency(frequency);
+      compiled.SetFrequency(frequency);
+      walker.Reset();
+      compiled.Reset();
+
+      int walker_eocs = 0, compiled_eocs = 0;
+      for (int t = 0; t < kTicks; ++t) {
+        expected[t] = walker.Next();
+        actual[t] = compiled.Next();
+        walker_eocs += walker.GetEOC();
+        compiled_eocs += compiled.GetEOC();
+      }
+
+      const int ticks_per_cycle = 1666667 / frequency;
+      const int segments = walker.SegmentCount();
+      EXPECT_NEAR(walker_eocs, compiled_eocs, 1 + compiled_eocs / 100 + compiled_eocs * (segments + 1) / ticks_per_cycle)
+        << "waveform " << waveform << " at " << frequency;
+
+      // The walker overshoots a target by up to a tick's rise, and holds that
+      // through any flat segment that follows
+      const int checked = std::min(kTicks, ticks_per_cycle);
+      int step = 0;
+      for (int t = 1; t < checked; ++t) {
+        const int delta = abs(expected[t] - expected[t - 1]);
+        if (delta < kScale / 4) step = std::max(step, delta);
+      }
+
+      const int window = segments + 2 + ticks_per_cycle / 100;
+      int worst = 0;
+      for (int t = window; t < checked - window; ++t) {
+        const auto range = std::minmax_element(expected.begin() + t - window, expected.begin() + t + window + 1);
+        if (actual[t] < *range.first) worst = std::max(worst, *range.first - actual[t] - step);
+        if (actual[t] > *range.second) worst = std::max(worst, actual[t] - *range.second - step);
+      }
+      EXPECT_LE(worst, kScale / 100) << "waveform " << waveform << " at " << frequency;
+    }
+  }
+}
+
+TEST(VectorOscillatorTest, OneShot) {
+  for (int waveform : { HS::Triangle, HS::Sawtooth, HS::Exponential, HS::EG1 }) {
+    VectorOscillator walker, compiled;
+    MakePair(waveform, walker, compiled);
+    for (VectorOscillator *osc : { &walker, &compiled }) {
+      osc->SetFrequency(1000); // 1666 ticks
+      osc->Cycle(0);
+      osc->Reset();
+    }
+    // Holds until started
+    EXPECT_EQ(walker.Next(), compiled.Next()) << "waveform " << waveform;
+    EXPECT_EQ(walker.Next(), compiled.Next()) << "waveform " << waveform;
+    walker.Start();
+    compiled.Start();
+
+    int walker_end = -1, compiled_end = -1;
+    for (int t = 0; t < 4000; ++t) {
+      walker.Next();
+      compiled.Next();
+      if (walker_end < 0 && walker.GetEOC()) walker_end = t;
+      if (compiled_end < 0 && compiled.GetEOC()) compiled_end = t;
+    }
+    EXPECT_NEAR(walker_end, compiled_end, 20) << "waveform " << waveform;
+    EXPECT_EQ(walker.Next(), compiled.Next()) << "waveform " << waveform;
+    EXPECT_TRUE(compiled.GetEOC());
+  }
+}
+
+TEST(VectorOscillatorTest, Phase) {
+  for (int waveform = HS::Triangle; waveform < HS::Triangle + HS::WAVEFORM_LIBRARY_COUNT; ++waveform) {
+    VectorOscillator walker, compiled;
+    MakePair(waveform, walker, compiled);
+    for (int degrees = 0; degrees < 3600; degrees += 7) {
+      // The walker's Phase() finds the segment with coarse integer
+      // proportions, so steps can land a few tenths of a degree off
+      int low = INT32_MAX, high = INT32_MIN;
+      for (int d = degrees - 5; d <= degrees + 5; ++d) {
+        low = std::min(low, walker.Phase(d + 3600));
+        high = std::max(high, walker.Phase(d + 3600));
+      }
+      const int value = compiled.Phase(degrees);
+      ASSERT_GE(value, low - kScale / 50) << "waveform " << waveform << " at " << degrees;
+      ASSERT_LE(value, high + kScale / 50) << "waveform " << waveform << " at " << degrees;
+    }
+  }
+}
+
+TEST(VectorOscillatorTest, EditsRecompile) {
+  VectorOscillator compiled = WaveformManager::VectorOscillatorFromWaveform(HS::Triangle);
+  compiled.SetScale(kScale);
+  compiled.SetFrequency(1000);
+  compiled.Reset();
+
+  // Turn the triangle into a ramp; the table must follow
+  compiled.SetSegment(0, VOSegment {255, 0});
+  compiled.Reset();
+  int previous = compiled.Next();
+  for (int t = 0; t < 1000; ++t) {
+    const int value = compiled.Next();
+    if (!compiled.GetEOC()) {
+      EXPECT_LE(value, previous) << "tick " << t;
+    }
+    previous = value;
+  }
+
+  // Sustaining EGs keep walking; just check nothing breaks
+  compiled.Sustain();
+  compiled.Reset();
+  for (int t = 0; t < 1000; ++t) compiled.Next();
+}
+
+// Not a pass/fail test: per-tick cost of both modes
+TEST(VectorOscillatorTest, Benchmark) {
+  static const int kTicks = 1 << 20;
+  for (int waveform : { HS::Triangle, HS::Sine }) {
+    VectorOscillator walker, compiled;
+    MakePair(waveform, walker, compiled);
+    double ns[2];
+    int i = 0;
+    for (VectorOscillator *osc : { &walker, &compiled }) {
+      osc->SetFrequency(20000);
+      osc->Reset();
+      int32_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < kTicks; ++t) {
+        osc->SetFrequency(20000 + (t & 0x3ff)); // FM, like VectorLFO's CV input
+        sum += osc->Next();
+      }
+      auto end = std::chrono::steady_clock::now();
+      ns[i++] = std::chrono::duration<double, std::nano>(end - start).count() / kTicks;
+      EXPECT_NE(0, sum);
+    }
+    printf("waveform %d with FM: walker %.1fns, compiled %.1fns per tick\n", waveform, ns[0], ns[1]);
+  }
+}
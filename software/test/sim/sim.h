@@ -0,0 +1,77 @@
+// Host-native simulation of the CORE ISR pipeline
+//
+// sim_hw.cpp stands in for the hardware drivers; sim_apps.cpp exposes the
+// app/applet registry to the harness; sim_main.cpp drives the ISR.
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "OC_ADC.h"
+#include "OC_DAC.h"
+
+namespace sim {
+
+uint64_t now_ns();
+
+// Hardware state visible to the harness
+extern uint32_t dac_out[DAC_CHANNEL_LAST];
+extern uint32_t display_subpages_sent;
+extern int32_t cv_in[ADC_CHANNEL_LAST]; // pitch units, 12 << 7 per volt
+
+// A rising edge runs the pin ISR as if it had happened cycles_ago target
+// cycles earlier, for sub-tick clock timing
+void set_gate(int input, bool high, uint32_t cycles_ago = 0);
+
+// One tick of CORE_timer_ISR: DAC/display/ADC/trigger stubs and app ISR
+void core_isr();
+
+// Access to the app layer, implemented in sim_apps.cpp
+int num_apps();
+const char *app_name(int index);
+uint16_t app_id(int index);
+void select_app(int index);
+
+// Sets the app up for the trace check so the synthetic inputs drive its
+// outputs: sequencers running, triggers and CV mapped, sequences filled in.
+// Called right after select_app().
+struct TraceSetup {
+  bool has_outputs = true; // false for utilities with nothing to drive
+  bool midi_notes = false; // feed a MIDI note along with every TR1 clock
+};
+TraceSetup setup_trace(int index);
+
+int num_applets();
+const char *applet_name(int index);
+int applet_id(int index);
+// Load the given applet into every Hemisphere slot and select the Hemisphere app
+void select_applet(int index);
+
+// Screens for the graphics check: every app's menu, every applet's view and
+// help screen, and the Hemisphere config pages. show_screen() sets up the
+// given screen and returns its name; screens must be shown in order.
+// draw_screen() renders the current one into the active graphics frame.
+int num_screens();
+const char *show_screen(int index);
+void draw_screen();
+
+// DAC output of one app run, for the trace check (sim_trace.cpp)
+struct Trace {
+  static constexpr uint32_t kNoTrap = 0xffffffff;
+
+  int channels;
+  uint32_t ticks;
+  uint32_t trapped_at; // tick a division by zero stopped the run on
+  std::vector<uint16_t> values; // ticks x channels
+};
+
+// Ticks on which any output changed, i.e. records in the file
+uint32_t TraceChanges(const Trace &trace);
+bool WriteTrace(const char *path, const Trace &trace);
+bool ReadTrace(const char *path, Trace &trace);
+
+}; // namespace sim
+
+#endif // SIM_H_
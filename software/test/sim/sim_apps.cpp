@@ -0,0 +1,171 @@
+// The app table and Hemisphere applet registry are file-local to OC_apps.cpp,
+// so the harness pulls it in directly to reach them.
+
+#include "OC_apps.cpp"
+#include "sim.h"
+
+namespace sim {
+
+int num_apps() {
+  return NUM_AVAILABLE_APPS;
+}
+
+const char *app_name(int index) {
+  return available_apps[index].name;
+}
+
+uint16_t app_id(int index) {
+  return available_apps[index].id;
+}
+
+void select_app(int index) {
+  OC::CORE::app_isr_enabled = false;
+  OC::apps::current_app->HandleAppEvent(OC::APP_EVENT_SUSPEND);
+  OC::apps::set_current_app(index);
+  OC::apps::current_app->HandleAppEvent(OC::APP_EVENT_RESUME);
+  OC::CORE::app_isr_enabled = true;
+}
+
+TraceSetup setup_trace(int index) {
+  TraceSetup setup;
+  OC::CORE::app_isr_enabled = false;
+  switch (app_id(index)) {
+  case TWOCC<'S','E'>::value: // Setup / About
+  case TWOCC<'B','R'>::value: // Backup / Restore
+  case TWOCC<'R','F'>::value: // References: fixed voltages, no inputs
+    setup.has_outputs = false;
+    break;
+#ifndef NO_HEMISPHERE
+  case TWOCC<'H','S'>::value:
+    manager.SetApplet(LEFT_HEMISPHERE, HS::get_applet_index_by_id(18)); // DualTM
+    manager.SetApplet(RIGHT_HEMISPHERE, HS::get_applet_index_by_id(8)); // ADSR
+    break;
+#endif
+  case TWOCC<'H','A'>::value: // Harrington 1200
+    h1200_settings.apply_value(H1200_SETTING_ROOT_OFFSET_CV, H1200_CV_SOURCE_CV2);
+    h1200_settings.apply_value(H1200_SETTING_INVERSION_CV, H1200_CV_SOURCE_CV3);
+    break;
+  case TWOCC<'S','Q'>::value: // Sequins
+    for (auto &channel : seq_channel) {
+      for (int step = 0; step < OC::kMaxPatternLength; ++step)
+        channel.set_pitch_at_step(0, step, ((step * 5) % 12) << 7);
+      channel.apply_value(SEQ_CHANNEL_SETTING_TRANSPOSE_CV_SOURCE, 1); // CV1
+    }
+    break;
+  case TWOCC<'M','I'>::value: { // Captain MIDI
+    // Setup 1: MIDI channel 1 note, gate, velocity and trigger on A-D
+    static const int kAssign[] = { MIDI_IN_NOTE, MIDI_IN_GATE, MIDI_IN_VELOCITY, MIDI_IN_TRIGGER };
+    for (int ch = 0; ch < 4; ++ch) {
+      captain_midi_instance.apply_value(ch, kAssign[ch]);
+      captain_midi_instance.apply_value(8 + ch, 1);
+    }
+    setup.midi_notes = true;
+    break;
+  }
+  case TWOCC<'N','N'>::value: { // Neural Net
+    // Setup 1 neurons as stored: type, sources 1-3, weights 1-3, threshold;
+    // outputs A-D follow neurons 1-4
+    static const uint8_t kNeurons[4][8] = {
+      { T_FLIPFLOP, 14, 0, 15, 128, 128, 128, 128 }, // ON toggled by Dig1
+      { XOR, 0, 1, 15, 128, 128, 128, 128 },         // Dig1 ^ Dig2
+      { D_FLIPFLOP, 5, 0, 15, 128, 128, 128, 128 },  // CV2 sampled by Dig1
+      { AND, 8, 4, 15, 128, 128, 128, 128 },         // Neu1 & CV1
+    };
+    for (int n = 0; n < 4; ++n) {
+      for (int i = 0; i < 8; ++i)
+        NeuralNetwork_instance.apply_value(n * 8 + i, kNeurons[n][i]);
+      NeuralNetwork_instance.apply_value(24 * 8 + n, n);
+    }
+    NeuralNetwork_instance.Resume();
+    break;
+  }
+  default:
+    break;
+  }
+  OC::CORE::app_isr_enabled = true;
+  return setup;
+}
+
+#ifndef NO_HEMISPHERE
+int num_applets() {
+  return HS::HEMISPHERE_AVAILABLE_APPLETS;
+}
+
+const char *applet_name(int index) {
+  return HS::applet_name(index);
+}
+
+int applet_id(int index) {
+  return HS::available_applets[index].id;
+}
+
+void select_applet(int index) {
+  select_app(OC::apps::index_of(TWOCC<'H','S'>::value));
+  OC::CORE::app_isr_enabled = false;
+  manager.SetApplet(LEFT_HEMISPHERE, index);
+  manager.SetApplet(RIGHT_HEMISPHERE, index);
+  OC::CORE::app_isr_enabled = true;
+}
+#else
+int num_applets() { return 0; }
+const char *applet_name(int) { return ""; }
+int applet_id(int) { return 0; }
+void select_applet(int) { }
+#endif
+
+// Config menu screens: one per cursor position from LOAD_PRESET through
+// CVMAP4, then the applet list page
+#ifndef NO_HEMISPHERE
+static constexpr int kConfigCursorScreens = HemisphereManager::CONFIG_CURSOR_COUNT;
+static constexpr int kConfigScreens = kConfigCursorScreens + 1;
+#else
+static constexpr int kConfigScreens = 0;
+#endif
+
+int num_screens() {
+  return num_apps() + 2 * num_applets() + kConfigScreens;
+}
+
+const char *show_screen(int index) {
+  static char name[64];
+  if (index < num_apps()) {
+    select_app(index);
+    snprintf(name, sizeof(name), "app %s", app_name(index));
+    return name;
+  }
+  index -= num_apps();
+
+#ifndef NO_HEMISPHERE
+  if (index < 2 * num_applets()) {
+    const int applet = index / 2;
+    const bool help = index & 1;
+    select_applet(applet);
+    manager.SetHelpScreen(help ? LEFT_HEMISPHERE : -1);
+    snprintf(name, sizeof(name), "%s %s", help ? "help" : "view", applet_name(applet));
+    return name;
+  }
+  index -= 2 * num_applets();
+
+  // Screens are shown in order, so each one steps on from the previous
+  if (!index) {
+    select_app(OC::apps::index_of(TWOCC<'H','S'>::value));
+    manager.SetHelpScreen(-1);
+    manager.ToggleConfigMenu();
+  } else if (index < kConfigCursorScreens) {
+    manager.DelegateEncoderMovement(UI::Event(UI::EVENT_ENCODER, OC::CONTROL_ENCODER_R, 1, 0));
+  } else {
+    manager.DelegateEncoderMovement(UI::Event(UI::EVENT_ENCODER, OC::CONTROL_ENCODER_L, 8, 0));
+  }
+  snprintf(name, sizeof(name), "config %d", index);
+#endif
+  return name;
+}
+
+void draw_screen() {
+#ifndef NO_HEMISPHERE
+  HemisphereApplet::InvalidateViews();
+#endif
+  OC::apps::current_app->DrawMenu();
+}
+
+}; // namespace sim
@@ -0,0 +1,237 @@
+// Host-side replacements for the hardware drivers
+//
+// The CORE ISR touches the DAC, ADC, trigger inputs and display; those are
+// the only parts of the firmware that talk to registers directly. Everything
+// here keeps the public interface of OC_DAC.cpp, OC_ADC.cpp and the display
+// driver but routes the values through the sim:: namespace instead, so the
+// harness can drive inputs and observe outputs.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <time.h>
+#include "OC_ADC.h"
+#include "OC_DAC.h"
+#include "OC_autotune.h"
+#include "OC_calibration.h"
+#include "OC_digital_inputs.h"
+#include "src/drivers/display.h"
+#include "src/drivers/FreqMeasure/OC_FreqMeasure.h"
+#include "sim.h"
+
+SimSerial Serial;
+usb_midi_class usbMIDI;
+EEPROMClass EEPROM;
+
+namespace sim {
+
+volatile uint32_t reg_dummy;
+uint8_t pins[CORE_NUM_DIGITAL];
+uint32_t micros;
+
+uint32_t dac_out[DAC_CHANNEL_LAST];
+uint32_t display_subpages_sent;
+int32_t cv_in[ADC_CHANNEL_LAST];
+
+static uint32_t random_state = 1;
+
+uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t cycle_skew;
+
+// Scale host time to target cycles so the OC_DEBUG_PROFILE_SCOPE counters
+// and debug::cycles_to_us keep their meaning
+uint32_t cycle_counter() {
+  return uint32_t(now_ns() * (F_CPU / 1000000) / 1000) - cycle_skew;
+}
+
+void set_gate(int input, bool high, uint32_t cycles_ago) {
+  static void (*const isrs[OC::DIGITAL_INPUT_LAST])() = {
+    OC::tr1_ISR, OC::tr2_ISR, OC::tr3_ISR, OC::tr4_ISR
+  };
+  static const uint8_t *const tr_pins[OC::DIGITAL_INPUT_LAST] = {
+    &TR1, &TR2, &TR3, &TR4
+  };
+
+  uint8_t &pin = pins[*tr_pins[input] % CORE_NUM_DIGITAL];
+  // inputs are inverted, and the pin ISRs trigger on the falling edge
+  const bool was_high = !pin;
+  pin = !high;
+  if (high && !was_high) {
+    cycle_skew = cycles_ago;
+    isrs[input]();
+    cycle_skew = 0;
+  }
+}
+
+}; // namespace sim
+
+uint32_t random(uint32_t howbig) {
+  if (!howbig) return 0;
+  // xorshift32, same as Teensyduino's random()
+  uint32_t x = sim::random_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  sim::random_state = x;
+  return x % howbig;
+}
+
+int32_t random(int32_t howsmall, int32_t howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(uint32_t seed) {
+  if (seed) sim::random_state = seed;
+}
+
+/* ------------------------ DAC ------------------------ */
+
+DAC_CHANNEL DAC_CHANNEL_A=0, DAC_CHANNEL_B=1, DAC_CHANNEL_C=2, DAC_CHANNEL_D=3;
+
+void SPI_init() { }
+
+namespace OC {
+
+void DAC::Init(CalibrationData *calibration_data, bool) {
+  calibration_data_ = calibration_data;
+  restore_scaling(0x0);
+  history_tail_ = 0;
+  memset(history_, 0, sizeof(history_));
+  set_all(0xffff);
+  Invalidate();
+  Update();
+}
+
+void DAC::WriteChannels(uint32_t mask, const uint32_t *values) {
+  for (int i = 0; i < DAC_CHANNEL_LAST; ++i) {
+    if (mask & (1 << i)) sim::dac_out[i] = values[i];
+  }
+}
+
+uint8_t DAC::calibration_data_used(uint8_t channel_id) {
+  return OC::AUTOTUNE::GetAutotune_data(channel_id).use_auto_calibration_;
+}
+
+void DAC::set_auto_channel_calibration_data(uint8_t) { }
+void DAC::set_default_channel_calibration_data(uint8_t) { }
+void DAC::update_auto_channel_calibration_data(uint8_t, int8_t, uint32_t) { }
+void DAC::reset_auto_channel_calibration_data(uint8_t) { }
+void DAC::reset_all_auto_channel_calibration_data() { }
+void DAC::choose_calibration_data() { }
+
+uint8_t DAC::get_voltage_scaling(uint8_t channel_id) {
+  return DAC_scaling[channel_id];
+}
+
+void DAC::set_scaling(uint8_t scaling, uint8_t channel_id) {
+  if (channel_id < DAC_CHANNEL_LAST)
+    DAC_scaling[channel_id] = scaling;
+}
+
+void DAC::restore_scaling(uint32_t scaling) {
+  for (int i = 0; i < DAC_CHANNEL_LAST; i++)
+    set_scaling((scaling >> (i * 8)) & 0xFF, i);
+}
+
+uint32_t DAC::store_scaling() {
+  uint32_t scaling = 0;
+  for (int i = 0; i < DAC_CHANNEL_LAST; i++)
+    scaling |= (DAC_scaling[i] << (i * 8));
+  return scaling;
+}
+
+void DAC::init_Vbias() { }
+void DAC::set_Vbias(uint32_t) { }
+
+DAC::CalibrationData *DAC::calibration_data_ = nullptr;
+uint32_t DAC::values_[DAC_CHANNEL_LAST];
+uint16_t DAC::history_[DAC_CHANNEL_LAST][DAC::kHistoryDepth];
+volatile size_t DAC::history_tail_;
+uint8_t DAC::DAC_scaling[DAC_CHANNEL_LAST];
+uint32_t DAC::written_[DAC_CHANNEL_LAST];
+uint32_t DAC::update_mask_;
+int DAC::refresh_channel_;
+int DAC::channels_written_;
+
+}; // namespace OC
+
+/* ------------------------ ADC ------------------------ */
+
+ADC_CHANNEL ADC_CHANNEL_1 = 0, ADC_CHANNEL_2 = 1, ADC_CHANNEL_3 = 2, ADC_CHANNEL_4 = 3;
+
+namespace OC {
+
+void ADC::Init(CalibrationData *calibration_data, bool) {
+  calibration_data_ = calibration_data;
+  std::fill(raw_, raw_ + ADC_CHANNEL_LAST, 0);
+  std::fill(smoothed_, smoothed_ + ADC_CHANNEL_LAST, 0);
+}
+
+void ADC::Init_DMA() { }
+void ADC::DMA_ISR() { }
+
+// Convert the requested pitch values back into raw readings, so the
+// calibration path in raw_pitch_value() etc. is exercised as on hardware.
+void ADC::Scan_DMA() {
+  for (int ch = 0; ch < ADC_CHANNEL_LAST; ++ch) {
+    int32_t value = (sim::cv_in[ch] << 12) / calibration_data_->pitch_cv_scale;
+    int32_t raw = calibration_data_->offset[ch] - value;
+    CONSTRAIN(raw, 0, (1 << kAdcResolution) - 1);
+    raw_[ch] = raw << kAdcSmoothBits;
+    smoothed_[ch] = (smoothed_[ch] * (kAdcSmoothing - 1) + raw_[ch]) / kAdcSmoothing;
+  }
+}
+
+void ADC::CalibratePitch(int32_t c2, int32_t c4) {
+  if (c2 < c4) {
+    int32_t scale = (24 * 128 * 4096L) / (c4 - c2);
+    calibration_data_->pitch_cv_scale = scale;
+  }
+}
+
+float ADC::Read_ID_Voltage() { return 0; }
+
+size_t ADC::scan_channel_;
+ADC::CalibrationData *ADC::calibration_data_;
+uint32_t ADC::raw_[ADC_CHANNEL_LAST];
+uint32_t ADC::smoothed_[ADC_CHANNEL_LAST];
+constexpr uint16_t ADC::SCA_CHANNEL_ID[DMA_NUM_CH];
+
+}; // namespace OC
+
+/* ------------------------ Display ------------------------ */
+
+void SH1106_128x64_Driver::Init() { }
+void SH1106_128x64_Driver::Reinit() { }
+void SH1106_128x64_Driver::Clear() { }
+void SH1106_128x64_Driver::Flush() { }
+void SH1106_128x64_Driver::SendPage(uint_fast8_t, uint_fast8_t, const uint8_t *) {
+  ++sim::display_subpages_sent;
+}
+void SH1106_128x64_Driver::SPI_send(void *, size_t) { }
+void SH1106_128x64_Driver::AdjustOffset(uint8_t) { }
+void SH1106_128x64_Driver::ChangeSpeed(uint32_t) { }
+void SH1106_128x64_Driver::SetFlipMode(bool) { }
+void SH1106_128x64_Driver::SetContrast(uint8_t) { }
+
+/* ------------------------ FreqMeasure ------------------------ */
+
+FreqMeasureClass FreqMeasure;
+
+void FreqMeasureClass::begin() { }
+uint8_t FreqMeasureClass::available() { return 0; }
+uint32_t FreqMeasureClass::read() { return 0; }
+float FreqMeasureClass::countToFrequency(uint32_t count) { return count ? float(F_BUS) / count : 0; }
+void FreqMeasureClass::end() { }
+
+/* ------------------------ Teensyduino core ------------------------ */
+
+extern "C" void _reboot_Teensyduino_() {
+  fprintf(stderr, "reboot requested\n");
+  exit(0);
+}
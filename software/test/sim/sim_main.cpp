@@ -0,0 +1,735 @@
+// Host-native CORE ISR benchmark
+//
+// Runs every full-screen app, and every Hemisphere applet (loaded into both
+// halves), at OC_CORE_ISR_FREQ against a synthetic or recorded CV/gate stream
+// and reports ns per tick, plus display subpages transferred per drawn frame
+// (out of 32). Host timings are not target timings; the table is
+// meant for spotting relative regressions before flashing.
+//
+// Usage: sim_oc [-s seconds] [-i recording] [-b budget_ns] [-f filter] [-j bpm] [-g golden] [-t traces [-w]]
+//
+// A recording is a text file of lines "tick gates cv1 cv2 ..." where gates is
+// a bitmask of TR1..TR4 and CV values are in mV. Values are held until the
+// next line; the stream loops after the last line.
+//
+// Cortex-M returns 0 for an integer division by zero where x86 traps; an
+// entry that hits one is cut short and flagged with the tick it happened on.
+//
+// -j runs the external clock sync check instead: HS::ClockManager follows an
+// ideal clock on TR1 at the given tempo and its tocks are compared against
+// the ideal grid, with and without the sub-tick clock phase. It then fails if
+// the clock doesn't pick up straight away after long gaps between SyncTrig()
+// calls.
+//
+// -g renders every app menu, applet view, applet help screen and Hemisphere
+// config page, times them, and compares a hash of each frame against the
+// given golden file (which is written if it doesn't exist yet). Any change
+// to weegfx must leave golden/screens.txt matching.
+//
+// -t runs every full-screen app for the given seconds against the synthetic
+// (or recorded) inputs and compares its DAC output, tick by tick, against
+// the trace of the same name in the given directory; a missing trace fails.
+// -w writes the traces instead. Each app runs in its own process from the
+// same state after Setup(), set up by sim::setup_trace() so the inputs drive
+// its outputs, so traces don't depend on which apps ran before or on -f. An
+// app whose outputs change on fewer than kMinChangesPerSecond ticks fails
+// either way. Any change to an app ISR that isn't meant to change its output
+// must leave golden/traces matching.
+
+#include <Arduino.h>
+#include <ctype.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "OC_apps.h"
+#include "OC_calibration.h"
+#include "OC_core.h"
+#include "OC_debug.h"
+#include "OC_digital_inputs.h"
+#include "OC_menus.h"
+#include "OC_ui.h"
+#include "HSClockManager.h"
+#include "sim.h"
+#include "usb_midi.h"
+
+unsigned long LAST_REDRAW_TIME = 0;
+uint_fast8_t MENU_REDRAW = true;
+OC::UiMode ui_mode = OC::UI_MODE_MENU;
+const bool DUMMY = false;
+
+volatile bool OC::CORE::app_isr_enabled = false;
+volatile uint32_t OC::CORE::ticks = 0;
+
+namespace sim {
+
+void core_isr() {
+  OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::ISR_cycles);
+
+  display::Flush();
+  {
+    OC_DEBUG_PROFILE_SCOPE(OC::DEBUG::DAC_cycles);
+    OC::DAC::Update();
+  }
+  display::Update();
+  OC::ADC::Scan_DMA();
+  OC::DigitalInputs::Scan();
+
+  ++OC::CORE::ticks;
+  if (OC::CORE::app_isr_enabled)
+    OC::apps::ISR();
+
+  sim::micros += OC_CORE_TIMER_RATE;
+}
+
+}; // namespace sim
+
+struct InputFrame {
+  uint32_t tick;
+  uint32_t gates;
+  int32_t cv[ADC_CHANNEL_LAST];
+};
+
+static std::vector<InputFrame> recording;
+
+static int32_t mV_to_pitch(int32_t mV) {
+  return (mV * (12 << 7)) / 1000;
+}
+
+static bool LoadRecording(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#' || line[0] == '\n') continue;
+    InputFrame frame = {};
+    char *p = line;
+    frame.tick = strtoul(p, &p, 0);
+    frame.gates = strtoul(p, &p, 0);
+    for (int ch = 0; ch < ADC_CHANNEL_LAST; ++ch)
+      frame.cv[ch] = mV_to_pitch(strtol(p, &p, 0));
+    recording.push_back(frame);
+  }
+  fclose(f);
+  return !recording.empty();
+}
+
+// Synthetic patch: clocks at a few unrelated rates, a triangle LFO, a stepped
+// random pitch, a faster sine and a slow ramp.
+static void SyntheticInputs(uint32_t tick, InputFrame &frame) {
+  static const uint32_t kClockPeriods[OC::DIGITAL_INPUT_LAST] = {
+    OC_CORE_ISR_FREQ / 32, OC_CORE_ISR_FREQ / 2, OC_CORE_ISR_FREQ / 3, OC_CORE_ISR_FREQ * 5 / 7
+  };
+  static int32_t stepped = 0;
+
+  frame.gates = 0;
+  for (int i = 0; i < OC::DIGITAL_INPUT_LAST; ++i) {
+    if ((tick % kClockPeriods[i]) < kClockPeriods[i] / 2)
+      frame.gates |= 1 << i;
+  }
+  if (tick % kClockPeriods[0] == 0)
+    stepped = random(-2000, 3000);
+
+  const float t = float(tick) / OC_CORE_ISR_FREQ;
+  const float tri = 2.0f * fabsf(2.0f * (t * 0.5f - floorf(t * 0.5f + 0.5f))) - 1.0f;
+  int32_t cv[4] = {
+    int32_t(tri * 3000),
+    stepped,
+    int32_t(sinf(2.0f * float(PI) * 2.0f * t) * 5000),
+    int32_t(fmodf(t, 10.0f) * 500),
+  };
+  for (int ch = 0; ch < ADC_CHANNEL_LAST; ++ch)
+    frame.cv[ch] = mV_to_pitch(cv[ch % 4]);
+}
+
+// Returns the gates, TR1 in bit 0
+static uint32_t ApplyInputs(uint32_t tick) {
+  InputFrame frame;
+  if (recording.empty()) {
+    SyntheticInputs(tick, frame);
+  } else {
+    const uint32_t length = recording.back().tick + 1;
+    const uint32_t t = tick % length;
+    auto it = std::upper_bound(recording.begin(), recording.end(), t,
+                               [](uint32_t v, const InputFrame &f) { return v < f.tick; });
+    frame = (it == recording.begin()) ? recording.front() : *(it - 1);
+  }
+
+  for (int i = 0; i < OC::DIGITAL_INPUT_LAST; ++i)
+    sim::set_gate(i, frame.gates & (1 << i));
+  for (int ch = 0; ch < ADC_CHANNEL_LAST; ++ch)
+    sim::cv_in[ch] = frame.cv[ch];
+  return frame.gates;
+}
+
+struct Result {
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  uint32_t max_tick = 0;
+  uint32_t over_budget = 0;
+  uint64_t draw_ns = 0;
+  uint32_t draws = 0;
+  uint32_t subpages_sent = 0;
+  uint32_t ticks = 0;
+};
+
+static sigjmp_buf trap_env;
+static volatile sig_atomic_t drawing = 0;
+
+static void OnSIGFPE(int) {
+  siglongjmp(trap_env, 1);
+}
+
+static void Run(uint32_t num_ticks, uint64_t budget_ns, Result &result) {
+  static constexpr uint32_t kRedrawTicks = (REDRAW_TIMEOUT_MS * 1000) / OC_CORE_TIMER_RATE;
+
+  const uint32_t subpages_sent = sim::display_subpages_sent;
+  for (uint32_t &tick = result.ticks; tick < num_ticks; ++tick) {
+    ApplyInputs(OC::CORE::ticks);
+
+    const uint64_t start = sim::now_ns();
+    sim::core_isr();
+    const uint64_t ns = sim::now_ns() - start;
+
+    result.total_ns += ns;
+    if (ns > result.max_ns) {
+      result.max_ns = ns;
+      result.max_tick = tick;
+    }
+    if (ns > budget_ns)
+      ++result.over_budget;
+
+    // main loop() runs many times per tick on hardware; once is enough here
+    OC::apps::current_app->loop();
+
+    // main loop() redraw, at the same cadence as on hardware
+    if (tick % kRedrawTicks == 0) {
+      const uint64_t draw_start = sim::now_ns();
+      GRAPHICS_BEGIN_FRAME(false);
+        drawing = 1;
+        OC::apps::current_app->DrawMenu();
+        drawing = 0;
+      GRAPHICS_END_FRAME();
+      result.draw_ns += sim::now_ns() - draw_start;
+      ++result.draws;
+    }
+    result.subpages_sent = sim::display_subpages_sent - subpages_sent;
+  }
+}
+
+static inline double cycles_to_ns(uint32_t cycles) {
+  return double(cycles) * 1000.0 / (F_CPU / 1000000);
+}
+
+static void PrintHeader(const char *title, bool applets) {
+  printf("\n%-24s %6s %12s %10s %9s %6s %10s %8s",
+         title, "id", "avg ns/tick", "max ns", "max@tick", "over", "draw ns", "xfer/frm");
+  if (applets)
+    printf(" %10s %10s", "ctrl ns", "ctrl max");
+  printf("\n");
+}
+
+static void PrintResult(const char *name, int id, const Result &r, bool applet, bool trapped) {
+  printf("%-24s %6d %12.1f %10llu %9u %6u %10.0f %8.1f",
+         name, id,
+         r.ticks ? double(r.total_ns) / r.ticks : 0.0,
+         (unsigned long long)r.max_ns, r.max_tick, r.over_budget,
+         r.draws ? double(r.draw_ns) / r.draws : 0.0,
+         r.draws ? double(r.subpages_sent) / r.draws : 0.0);
+  // Per-slot counters from HemisphereManager::Controller
+  if (applet) {
+    const auto &cycles = OC::DEBUG::APPLET_cycles[0];
+    printf(" %10.0f %10.0f", cycles_to_ns(cycles.value()), cycles_to_ns(cycles.max_value()));
+  }
+  if (trapped)
+    printf("  div/0@%u", r.ticks);
+  printf("\n");
+}
+
+// Run one entry, recovering from a division by zero in the app code
+static void RunEntry(const char *name, int id, uint32_t num_ticks, uint64_t budget_ns, bool applet) {
+  static Result result;
+  result = Result();
+
+  if (sigsetjmp(trap_env, 1)) {
+    if (drawing) {
+      graphics.End();
+      display::frame_buffer.written();
+      drawing = 0;
+    }
+    PrintResult(name, id, result, applet, true);
+    return;
+  }
+
+  Run(num_ticks, budget_ns, result);
+  PrintResult(name, id, result, applet, false);
+}
+
+// FNV-1a
+static uint64_t HashFrame(const uint8_t *frame) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < weegfx::Graphics::kFrameSize; ++i)
+    hash = (hash ^ frame[i]) * 1099511628211ULL;
+  return hash;
+}
+
+static int CheckScreens(const char *golden_path) {
+  static constexpr int kReps = 200;
+  static constexpr int kSettleTicks = 16;
+  static uint8_t frame[weegfx::Graphics::kFrameSize];
+
+  FILE *golden = fopen(golden_path, "r");
+  FILE *out = golden ? nullptr : fopen(golden_path, "w");
+  if (!golden && !out) {
+    fprintf(stderr, "Can't open %s\n", golden_path);
+    return 1;
+  }
+
+  // Per kind of screen, i.e. the first word of the name
+  struct Group { char kind[16]; int screens; uint64_t ns; } groups[8] = {};
+  int mismatches = 0;
+
+  for (int i = 0; i < sim::num_screens(); ++i) {
+    const char *name = sim::show_screen(i);
+    uint64_t ns = 0;
+
+    // A division by zero stops the screen where it happened, which is the
+    // same place every run, so the partial frame still counts
+    if (sigsetjmp(trap_env, 1)) {
+      graphics.End();
+      OC::CORE::app_isr_enabled = false;
+      printf("div/0 in %s\n", name);
+    } else {
+      // A few ticks with idle inputs so queued applet changes etc. are picked up
+      OC::CORE::app_isr_enabled = true;
+      for (int tick = 0; tick < kSettleTicks; ++tick)
+        sim::core_isr();
+      OC::CORE::app_isr_enabled = false;
+
+      const uint64_t start = sim::now_ns();
+      for (int rep = 0; rep < kReps; ++rep) {
+        graphics.Begin(frame, weegfx::CLEAR_FRAME_ENABLE);
+        sim::draw_screen();
+        graphics.End();
+      }
+      ns = (sim::now_ns() - start) / kReps;
+    }
+    const uint64_t hash = HashFrame(frame);
+
+    if (out) {
+      fprintf(out, "%016llx %s\n", (unsigned long long)hash, name);
+    } else {
+      char line[128];
+      unsigned long long expected = 0;
+      if (!fgets(line, sizeof(line), golden) || sscanf(line, "%llx", &expected) != 1 ||
+          strncmp(line + 17, name, strlen(name))) {
+        fprintf(stderr, "%s: golden file out of step at %s\n", golden_path, name);
+        fclose(golden);
+        return 1;
+      }
+      if (expected != hash) {
+        printf("MISMATCH %s\n", name);
+        ++mismatches;
+      }
+    }
+
+    for (auto &group : groups) {
+      if (!group.screens)
+        sscanf(name, "%15s", group.kind);
+      if (!strncmp(name, group.kind, strlen(group.kind)) && name[strlen(group.kind)] == ' ') {
+        ++group.screens;
+        group.ns += ns;
+        break;
+      }
+    }
+  }
+
+  uint64_t total_ns = 0;
+  for (const auto &group : groups) {
+    if (!group.screens) continue;
+    printf("%-8s %4d screens %10.0f ns/screen\n", group.kind, group.screens, double(group.ns) / group.screens);
+    total_ns += group.ns;
+  }
+  printf("total    %4d screens %10.0f ns/screen\n", sim::num_screens(), double(total_ns) / sim::num_screens());
+
+  if (out) {
+    fclose(out);
+    printf("wrote %s\n", golden_path);
+    return 0;
+  }
+  fclose(golden);
+  printf("%d of %d screens differ from %s\n", mismatches, sim::num_screens(), golden_path);
+  return mismatches ? 1 : 0;
+}
+
+// One app against its golden trace, in a child process. Returns 0 if it
+// matches or was written, 1 if it differs, is missing, or its outputs
+// barely move, 2 if it can't be written.
+static int TraceApp(int index, const char *dir, uint32_t num_ticks, bool write) {
+  static constexpr uint32_t kRedrawTicks = (REDRAW_TIMEOUT_MS * 1000) / OC_CORE_TIMER_RATE;
+  // A trace that hardly moves doesn't check anything
+  static constexpr uint32_t kMinChangesPerSecond = 16;
+  static constexpr uint8_t kMidiNotes[] = { 48, 55, 60, 63, 67, 70, 72, 58 };
+
+  char path[256];
+  snprintf(path, sizeof(path), "%s/", dir);
+  for (const char *c = sim::app_name(index); *c && strlen(path) < sizeof(path) - 8; ++c) {
+    const char ch = isalnum(*c) ? *c : '_';
+    strncat(path, &ch, 1);
+  }
+  strcat(path, ".trace");
+
+  static sim::Trace golden, trace;
+  const bool have_golden = !write && sim::ReadTrace(path, golden);
+  trace.channels = DAC_CHANNEL_LAST;
+  trace.ticks = have_golden ? golden.ticks : num_ticks;
+  trace.trapped_at = sim::Trace::kNoTrap;
+  trace.values.assign(size_t(trace.ticks) * trace.channels, 0);
+
+  static volatile uint32_t tick;
+  static uint64_t total_ns, max_ns;
+  tick = 0;
+  total_ns = max_ns = 0;
+  sim::select_app(index);
+  const sim::TraceSetup setup = sim::setup_trace(index);
+
+  if (sigsetjmp(trap_env, 1)) {
+    if (drawing) {
+      graphics.End();
+      drawing = 0;
+    }
+    trace.trapped_at = tick;
+  } else {
+    static bool gate = false;
+    static unsigned note = 0;
+    for (; tick < trace.ticks; ++tick) {
+      const bool tr1 = ApplyInputs(OC::CORE::ticks) & 1;
+      if (setup.midi_notes && tr1 != gate) {
+        gate = !gate;
+        if (gate) {
+          note = (note + 1) % (sizeof(kMidiNotes) / sizeof(kMidiNotes[0]));
+          usbMIDI.sim_push(usb_midi_class::NoteOn, 1, kMidiNotes[note], 60 + 8 * note);
+        } else {
+          usbMIDI.sim_push(usb_midi_class::NoteOff, 1, kMidiNotes[note], 0);
+        }
+      }
+
+      const uint64_t start = sim::now_ns();
+      sim::core_isr();
+      const uint64_t ns = sim::now_ns() - start;
+      total_ns += ns;
+      if (ns > max_ns) max_ns = ns;
+
+      for (int ch = 0; ch < trace.channels; ++ch)
+        trace.values[tick * trace.channels + ch] = sim::dac_out[ch];
+
+      OC::apps::current_app->loop();
+      if (tick % kRedrawTicks == 0) {
+        GRAPHICS_BEGIN_FRAME(false);
+          drawing = 1;
+          OC::apps::current_app->DrawMenu();
+          drawing = 0;
+        GRAPHICS_END_FRAME();
+      }
+    }
+  }
+
+  const uint32_t ran = trace.trapped_at == sim::Trace::kNoTrap ? trace.ticks : trace.trapped_at;
+  printf("%-24s %6d %12.1f %10llu  ", sim::app_name(index), sim::app_id(index),
+         ran ? double(total_ns) / ran : 0.0, (unsigned long long)max_ns);
+  if (trace.trapped_at != sim::Trace::kNoTrap)
+    printf("div/0@%u ", trace.trapped_at);
+  const uint32_t changes = sim::TraceChanges(trace);
+  const uint32_t min_changes = uint64_t(trace.ticks) * kMinChangesPerSecond / OC_CORE_ISR_FREQ;
+  printf("%7u  ", changes);
+
+  int status = 0;
+  if (setup.has_outputs && changes < min_changes) {
+    printf("STILL (fewer than %u changes)\n", min_changes);
+    status = 1;
+  } else if (write) {
+    if (sim::WriteTrace(path, trace)) {
+      printf("written\n");
+    } else {
+      printf("can't write %s\n", path);
+      status = 2;
+    }
+  } else if (!have_golden) {
+    printf("MISSING (-w writes it)\n");
+    status = 1;
+  } else if (golden.channels != trace.channels || golden.trapped_at != trace.trapped_at) {
+    printf("MISMATCH (%d channels, div/0@%d in trace)\n", golden.channels, int(golden.trapped_at));
+    status = 1;
+  } else {
+    uint32_t first = sim::Trace::kNoTrap, differ = 0;
+    for (uint32_t t = 0; t < trace.ticks; ++t) {
+      if (memcmp(&trace.values[t * trace.channels], &golden.values[t * trace.channels],
+                 trace.channels * sizeof(uint16_t))) {
+        if (!differ++) first = t;
+      }
+    }
+    if (!differ) {
+      printf("ok\n");
+    } else {
+      printf("MISMATCH from tick %u, %u ticks differ:", first, differ);
+      for (int ch = 0; ch < trace.channels; ++ch) {
+        const uint16_t expected = golden.values[first * trace.channels + ch];
+        const uint16_t got = trace.values[first * trace.channels + ch];
+        if (expected != got) printf(" %c %u->%u", 'A' + ch, expected, got);
+      }
+      printf("\n");
+      status = 1;
+    }
+  }
+  fflush(stdout);
+  return status;
+}
+
+static int CheckTraces(const char *dir, const char *filter, uint32_t num_ticks, bool write) {
+  if (write) mkdir(dir, 0777);
+  printf("%-24s %6s %12s %10s %7s  %s\n", "Trace", "id", "avg ns/tick", "max ns", "changes", "vs. golden");
+
+  int traces = 0, mismatches = 0, errors = 0;
+  for (int i = 0; i < sim::num_apps(); ++i) {
+    if (filter && !strstr(sim::app_name(i), filter)) continue;
+    ++traces;
+
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (!pid) _exit(TraceApp(i, dir, num_ticks, write));
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) > 1) {
+      if (pid > 0 && !WIFEXITED(status)) printf("%-24s crashed\n", sim::app_name(i));
+      ++errors;
+    } else if (WEXITSTATUS(status)) {
+      ++mismatches;
+    }
+  }
+
+  if (write)
+    printf("wrote %d of %d traces to %s\n", traces - mismatches - errors, traces, dir);
+  else
+    printf("%d of %d traces differ from %s\n", mismatches, traces, dir);
+  return (mismatches || errors) ? 1 : 0;
+}
+
+struct JitterResult {
+  double bpm;
+  double mean_us;
+  double rms_us;
+  double max_us;
+  uint32_t tocks;
+};
+
+// One ClockManager following an ideal ppqn clock on TR1; tocks of a x4
+// multiplier are measured against the ideal quarter-beat grid after a few
+// beats to lock on. Ticks are 1/1000000 minute here, as in ClockManager.
+static JitterResult ClockJitter(float bpm, int ppqn, int beats, bool use_phase) {
+  static constexpr int kMultiply = 4;
+  static constexpr int kLockBeats = 4;
+  static constexpr double kOffset = 0.37; // first edge, in ticks
+
+  HS::ClockManager cm;
+  cm.DisableMIDIOut();
+  cm.SetClockPPQN(ppqn);
+  cm.SetMultiply(kMultiply, 0);
+  cm.SetTempoBPM(uint16_t(bpm));
+
+  const double clock_period = 1000000.0 / bpm / ppqn;
+  const double tock_period = clock_period * ppqn / kMultiply;
+  const uint32_t num_ticks = uint32_t(clock_period * ppqn * beats);
+
+  JitterResult r = {};
+  std::vector<double> errors;
+  uint32_t edge = 0;
+
+  OC::CORE::ticks = 0;
+  cm.Start();
+  for (uint32_t tick = 1; tick < num_ticks; ++tick) {
+    OC::CORE::ticks = tick;
+    const double edge_time = kOffset + edge * clock_period;
+    if (edge_time <= tick) {
+      const uint32_t cycles_ago = uint32_t((tick - edge_time) * OC::kCyclesPerTick);
+      sim::set_gate(OC::DIGITAL_INPUT_1, true, cycles_ago);
+      sim::set_gate(OC::DIGITAL_INPUT_1, false);
+      ++edge;
+    }
+    OC::DigitalInputs::Scan();
+
+    const bool clocked = OC::DigitalInputs::clocked<OC::DIGITAL_INPUT_1>();
+    const uint8_t age = use_phase ? OC::DigitalInputs::clock_phase(OC::DIGITAL_INPUT_1) : 0;
+    cm.SyncTrig(clocked, false, age);
+
+    if (cm.Tock(0) && tick > tock_period * kMultiply * kLockBeats) {
+      const double t = tick - kOffset;
+      errors.push_back(t - tock_period * floor(t / tock_period + 0.5));
+    }
+  }
+
+  r.tocks = errors.size();
+  r.bpm = 1000000.0 * 256 / cm.FineTicksPerBeat();
+  if (!r.tocks) return r;
+
+  double sum = 0;
+  for (double e : errors) sum += e;
+  const double mean = sum / r.tocks;
+  double sq = 0;
+  for (double e : errors) {
+    sq += (e - mean) * (e - mean);
+    r.max_us = std::max(r.max_us, fabs(e - mean) * OC_CORE_TIMER_RATE);
+  }
+  r.mean_us = mean * OC_CORE_TIMER_RATE;
+  r.rms_us = sqrt(sq / r.tocks) * OC_CORE_TIMER_RATE;
+  return r;
+}
+
+static void PrintClockJitter(float bpm) {
+  static const int kPPQNs[] = { 1, 4, 24 };
+  static constexpr int kBeats = 64;
+
+  printf("Clock sync, %.2f BPM on TR1, x4 tocks vs. ideal grid over %d beats\n", bpm, kBeats);
+  printf("%-6s %-9s %10s %10s %10s %10s %7s\n",
+         "ppqn", "phase", "est. BPM", "mean us", "rms us", "max us", "tocks");
+  for (int ppqn : kPPQNs) {
+    for (bool use_phase : { false, true }) {
+      const JitterResult r = ClockJitter(bpm, ppqn, kBeats, use_phase);
+      printf("%-6d %-9s %10.3f %10.1f %10.1f %10.1f %7u\n",
+             ppqn, use_phase ? "sub-tick" : "tick", r.bpm, r.mean_us, r.rms_us, r.max_us, r.tocks);
+    }
+  }
+}
+
+// SyncTrig() only runs while Hemisphere or Quadrants has the ISR, so the
+// clock can come back to a beat that's minutes old. Tocks have to pick up on
+// the next tick and then keep the beat, whatever the gap.
+static bool ClockResumesAfterGap(uint32_t gap) {
+  static constexpr uint16_t kBPM = 120;
+  HS::ClockManager cm;
+  cm.DisableMIDIOut();
+  cm.SetMultiply(1, 0);
+  cm.SetTempoBPM(kBPM);
+  const uint32_t beat = cm.FineTicksPerBeat() >> 8;
+
+  OC::CORE::ticks = 0;
+  cm.Start();
+  for (uint32_t tick = 1; tick < 3 * beat + beat / 2; ++tick) {
+    OC::CORE::ticks = tick;
+    cm.SyncTrig(false);
+  }
+
+  // A catch-up tock or two, then one per beat
+  OC::CORE::ticks += gap;
+  uint32_t tocks[8];
+  int n = 0;
+  for (uint32_t i = 0; i < 3 * beat && n < 8; ++i, ++OC::CORE::ticks) {
+    cm.SyncTrig(false);
+    if (cm.Tock(0)) tocks[n++] = i;
+  }
+  if (n < 3) {
+    printf("%-10u %-6s %d tocks in three beats\n", gap, "FAIL", n);
+    return false;
+  }
+  const uint32_t period = tocks[n - 1] - tocks[n - 2];
+  const bool ok = tocks[0] <= 2 && period >= beat - 1 && period <= beat + 1;
+  printf("%-10u %-6s first tock after %u ticks, then every %u (beat %u)\n", gap, ok ? "ok" : "FAIL",
+         tocks[0], period, beat);
+  return ok;
+}
+
+static int CheckClockGaps() {
+  // Past the end of the beat; then past 2^23 ticks, where the age in 1/256
+  // ticks no longer fits 32 bits
+  static const uint32_t kGaps[] = { 20000, (1u << 23) + 1234, 3u << 23, 1u << 30 };
+  printf("Clock resume after a gap in SyncTrig() calls\n");
+  printf("%-10s %-6s\n", "gap", "result");
+  int failed = 0;
+  for (uint32_t gap : kGaps)
+    failed += !ClockResumesAfterGap(gap);
+  return failed ? 1 : 0;
+}
+
+static void Setup() {
+  OC::DEBUG::Init();
+  OC::calibration_load();
+  OC::DigitalInputs::Init();
+  OC::ADC::Init(&OC::calibration_data.adc, false);
+  OC::ADC::Init_DMA();
+  OC::DAC::Init(&OC::calibration_data.dac, false);
+  display::Init();
+  OC::menu::Init();
+  OC::ui.Init();
+  OC::apps::Init(false);
+  OC::CORE::app_isr_enabled = true;
+}
+
+int main(int argc, char **argv) {
+  float seconds = 2.0f;
+  uint64_t budget_ns = OC_CORE_TIMER_RATE * 1000ULL;
+  const char *filter = nullptr;
+  float jitter_bpm = 0.0f;
+  const char *golden = nullptr;
+  const char *traces = nullptr;
+  bool write_traces = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+      if (!LoadRecording(argv[++i])) {
+        fprintf(stderr, "Can't load recording %s\n", argv[i]);
+        return 1;
+      }
+    } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+      budget_ns = strtoull(argv[++i], nullptr, 0);
+    } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+      jitter_bpm = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+      golden = argv[++i];
+    } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+      traces = argv[++i];
+    } else if (!strcmp(argv[i], "-w")) {
+      write_traces = true;
+    } else {
+      fprintf(stderr, "Usage: %s [-s seconds] [-i recording] [-b budget_ns] [-f filter] [-j bpm] [-g golden] [-t traces [-w]]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  signal(SIGFPE, OnSIGFPE);
+  Setup();
+
+  if (jitter_bpm > 0) {
+    PrintClockJitter(jitter_bpm);
+    return CheckClockGaps();
+  }
+  if (golden)
+    return CheckScreens(golden);
+
+  const uint32_t num_ticks = uint32_t(seconds * OC_CORE_ISR_FREQ);
+  if (traces)
+    return CheckTraces(traces, filter, num_ticks, write_traces);
+  printf("%u ticks @ %uHz per entry, budget %lluns\n",
+         num_ticks, OC_CORE_ISR_FREQ, (unsigned long long)budget_ns);
+
+  PrintHeader("App", false);
+  for (int i = 0; i < sim::num_apps(); ++i) {
+    if (filter && !strstr(sim::app_name(i), filter)) continue;
+    sim::select_app(i);
+    RunEntry(sim::app_name(i), sim::app_id(i), num_ticks, budget_ns, false);
+  }
+
+  PrintHeader("Applet (both halves)", true);
+  for (int i = 0; i < sim::num_applets(); ++i) {
+    if (filter && !strstr(sim::applet_name(i), filter)) continue;
+    sim::select_applet(i);
+    RunEntry(sim::applet_name(i), sim::applet_id(i), num_ticks, budget_ns, true);
+  }
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+// DAC output traces for the app regression check
+//
+// File layout, little-endian: "OCTR", version, channels, 2 bytes reserved,
+// ticks (u32), the tick a division by zero stopped the run on (u32, or
+// kNoTrap). Then one record per tick on which any output changed: the
+// number of unchanged ticks before it (varint), a mask of the channels that
+// changed (u8), and for each of those the difference to its previous value
+// (zigzag varint). Outputs start at 0. Most outputs hold still or move in
+// small steps, so this is a fraction of the raw stream.
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+namespace sim {
+
+static constexpr uint8_t kTraceVersion = 1;
+
+static void PutVarint(std::vector<uint8_t> &out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(uint8_t(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(uint8_t(value));
+}
+
+static bool GetVarint(const std::vector<uint8_t> &in, size_t &pos, uint32_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (pos >= in.size()) return false;
+    const uint8_t byte = in[pos++];
+    value |= uint32_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+static void PutU32(std::vector<uint8_t> &out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) out.push_back(uint8_t(value >> (8 * i)));
+}
+
+static uint32_t GetU32(const uint8_t *in) {
+  return in[0] | (in[1] << 8) | (in[2] << 16) | (uint32_t(in[3]) << 24);
+}
+
+uint32_t TraceChanges(const Trace &trace) {
+  uint32_t changes = 0;
+  std::vector<uint16_t> last(trace.channels, 0);
+  for (uint32_t tick = 0; tick < trace.ticks; ++tick) {
+    const uint16_t *values = &trace.values[tick * trace.channels];
+    if (memcmp(values, last.data(), trace.channels * sizeof(uint16_t))) {
+      ++changes;
+      memcpy(last.data(), values, trace.channels * sizeof(uint16_t));
+    }
+  }
+  return changes;
+}
+
+bool WriteTrace(const char *path, const Trace &trace) {
+  std::vector<uint8_t> out = { 'O', 'C', 'T', 'R', kTraceVersion, uint8_t(trace.channels), 0, 0 };
+  PutU32(out, trace.ticks);
+  PutU32(out, trace.trapped_at);
+
+  std::vector<uint16_t> last(trace.channels, 0);
+  uint32_t unchanged = 0;
+  for (uint32_t tick = 0; tick < trace.ticks; ++tick) {
+    const uint16_t *values = &trace.values[tick * trace.channels];
+    uint8_t mask = 0;
+    for (int ch = 0; ch < trace.channels; ++ch) {
+      if (values[ch] != last[ch]) mask |= 1 << ch;
+    }
+    if (!mask) {
+      ++unchanged;
+      continue;
+    }
+    PutVarint(out, unchanged);
+    out.push_back(mask);
+    for (int ch = 0; ch < trace.channels; ++ch) {
+      if (!(mask & (1 << ch))) continue;
+      const int32_t delta = int32_t(values[ch]) - last[ch];
+      PutVarint(out, (uint32_t(delta) << 1) ^ uint32_t(delta >> 31));
+      last[ch] = values[ch];
+    }
+    unchanged = 0;
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (!f) return false;
+  const bool written = fwrite(out.data(), 1, out.size(), f) == out.size();
+  return !fclose(f) && written;
+}
+
+bool ReadTrace(const char *path, Trace &trace) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  std::vector<uint8_t> in;
+  uint8_t buffer[4096];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    in.insert(in.end(), buffer, buffer + length);
+  fclose(f);
+
+  if (in.size() < 16 || memcmp(in.data(), "OCTR", 4) || in[4] != kTraceVersion || in[5] > 8)
+    return false;
+  trace.channels = in[5];
+  trace.ticks = GetU32(&in[8]);
+  trace.trapped_at = GetU32(&in[12]);
+  trace.values.assign(size_t(trace.ticks) * trace.channels, 0);
+
+  std::vector<uint16_t> last(trace.channels, 0);
+  size_t pos = 16;
+  uint32_t tick = 0;
+  while (pos < in.size()) {
+    uint32_t unchanged;
+    if (!GetVarint(in, pos, unchanged) || pos >= in.size()) return false;
+    for (; unchanged && tick < trace.ticks; --unchanged, ++tick)
+      memcpy(&trace.values[tick * trace.channels], last.data(), trace.channels * sizeof(uint16_t));
+    if (tick >= trace.ticks) return false;
+
+    const uint8_t mask = in[pos++];
+    for (int ch = 0; ch < trace.channels; ++ch) {
+      if (!(mask & (1 << ch))) continue;
+      uint32_t zigzag;
+      if (!GetVarint(in, pos, zigzag)) return false;
+      last[ch] += int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+    }
+    memcpy(&trace.values[tick * trace.channels], last.data(), trace.channels * sizeof(uint16_t));
+    ++tick;
+  }
+  for (; tick < trace.ticks; ++tick)
+    memcpy(&trace.values[tick * trace.channels], last.data(), trace.channels * sizeof(uint16_t));
+  return true;
+}
+
+}; // namespace sim
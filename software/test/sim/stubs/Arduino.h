@@ -0,0 +1,182 @@
+// Host-side stand-in for the Teensyduino core, just enough of it to compile
+// the app layer on a desktop compiler. Pins, registers and timers are plain
+// variables; see sim_hw.cpp for the parts the harness drives.
+
+#ifndef SIM_ARDUINO_H_
+#define SIM_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <array>
+#include <tuple>
+#include <utility>
+
+#ifndef __MK20DX256__
+#define __MK20DX256__
+#endif
+#define KINETISK
+#define F_CPU 120000000
+#define F_BUS 60000000
+
+#define FASTRUN
+#define DMAMEM
+#define PROGMEM
+#define FLASHMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define OUTPUT_OPENDRAIN 4
+#define INPUT_DISABLE 5
+#define RISING 2
+#define FALLING 3
+#define CHANGE 4
+
+#define HEX 16
+#define DEC 10
+#define BIN 2
+
+#define CORE_NUM_DIGITAL 64
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define TWO_PI 6.283185307179586476925286766559
+
+namespace sim {
+  extern volatile uint32_t reg_dummy;
+  extern uint8_t pins[CORE_NUM_DIGITAL];
+  extern uint32_t micros;
+  extern uint32_t cycle_counter();
+}
+
+// Kinetis port config, only written to
+#define portConfigRegister(pin) (&sim::reg_dummy)
+#define portModeRegister(pin) ((volatile uint8_t *)&sim::reg_dummy)
+#define digitalPinToBitMask(pin) (1)
+#define PORT_PCR_DSE 0
+#define PORT_PCR_ODE 0
+#define PORT_PCR_PE 0
+#define PORT_PCR_PS 0
+#define PORT_PCR_MUX(n) (n)
+
+#define ARM_DWT_CYCCNT (sim::cycle_counter())
+#define ARM_DEMCR sim::reg_dummy
+#define ARM_DEMCR_TRCENA 0
+#define ARM_DWT_CTRL sim::reg_dummy
+#define ARM_DWT_CTRL_CYCCNTENA 0
+
+#define NVIC_SET_PRIORITY(irq, prio) do { } while (0)
+#define NVIC_ENABLE_IRQ(irq) do { } while (0)
+#define NVIC_DISABLE_IRQ(irq) do { } while (0)
+
+static inline void __disable_irq() { }
+static inline void __enable_irq() { }
+static inline void noInterrupts() { }
+static inline void interrupts() { }
+static inline void yield() { }
+
+static inline void pinMode(uint8_t, uint8_t) { }
+static inline void digitalWrite(uint8_t pin, uint8_t v) { sim::pins[pin % CORE_NUM_DIGITAL] = v; }
+static inline void digitalWriteFast(uint8_t pin, uint8_t v) { sim::pins[pin % CORE_NUM_DIGITAL] = v; }
+static inline uint8_t digitalRead(uint8_t pin) { return sim::pins[pin % CORE_NUM_DIGITAL]; }
+static inline uint8_t digitalReadFast(uint8_t pin) { return sim::pins[pin % CORE_NUM_DIGITAL]; }
+static inline int analogRead(uint8_t) { return 0; }
+static inline void attachInterrupt(uint8_t, void (*)(), int) { }
+
+static inline uint32_t micros() { return sim::micros; }
+static inline uint32_t millis() { return sim::micros / 1000; }
+static inline void delay(uint32_t ms) { sim::micros += ms * 1000; }
+static inline void delayMicroseconds(uint32_t us) { sim::micros += us; }
+static inline void delayNanoseconds(uint32_t) { }
+
+// Teensyduino's random() is a seeded xorshift; the harness only needs it to
+// be deterministic between runs. Same signatures as Teensyduino, so
+// random(0xFFFFFFFF) is a full-range number, not a negative bound.
+extern uint32_t random(uint32_t howbig);
+extern int32_t random(int32_t howsmall, int32_t howbig);
+extern void randomSeed(uint32_t seed);
+
+template <typename T, typename L, typename H>
+constexpr T constrain(T amt, L low, H high) {
+  return (amt < low) ? low : ((amt > high) ? high : amt);
+}
+
+template <typename T>
+constexpr T map(T x, T in_min, T in_max, T out_min, T out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+using std::min;
+using std::max;
+using std::abs;
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+class elapsedMicros {
+public:
+  elapsedMicros() : us_(micros()) { }
+  elapsedMicros(uint32_t val) : us_(micros() - val) { }
+  operator uint32_t() const { return micros() - us_; }
+  elapsedMicros &operator=(uint32_t val) { us_ = micros() - val; return *this; }
+private:
+  uint32_t us_;
+};
+
+class elapsedMillis {
+public:
+  elapsedMillis() : ms_(millis()) { }
+  elapsedMillis(uint32_t val) : ms_(millis() - val) { }
+  operator uint32_t() const { return millis() - ms_; }
+  elapsedMillis &operator=(uint32_t val) { ms_ = millis() - val; return *this; }
+private:
+  uint32_t ms_;
+};
+
+class IntervalTimer {
+public:
+  bool begin(void (*)(), uint32_t) { return true; }
+  void priority(uint8_t) { }
+  void end() { }
+};
+
+class SimSerial {
+public:
+  void begin(uint32_t) { }
+  operator bool() const { return false; }
+  int available() { return 0; }
+  int availableForWrite() { return 0; }
+  int read() { return -1; }
+  void flush() { }
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t *, size_t n) { return n; }
+  template <typename T> size_t print(T) { return 0; }
+  template <typename T> size_t print(T, int) { return 0; }
+  size_t println() { return 0; }
+  template <typename T> size_t println(T) { return 0; }
+  template <typename T> size_t println(T, int) { return 0; }
+  int printf(const char *, ...) { return 0; }
+};
+extern SimSerial Serial;
+
+#include "usb_midi.h"
+
+#endif // SIM_ARDUINO_H_
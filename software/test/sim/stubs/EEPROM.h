@@ -0,0 +1,43 @@
+// Host-side EEPROM, backed by RAM
+#ifndef SIM_EEPROM_H_
+#define SIM_EEPROM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define E2END 0xfff
+
+struct EERef {
+  EERef(int idx) : index(idx) { }
+  operator uint8_t() const;
+  EERef &operator=(uint8_t val);
+  EERef &update(uint8_t val) { return *this = val; }
+  int index;
+};
+
+struct EEPtr {
+  EEPtr(int idx) : index(idx) { }
+  EERef operator*() { return EERef(index); }
+  EEPtr &operator++() { ++index; return *this; }
+  EEPtr operator++(int) { EEPtr p = *this; ++index; return p; }
+  int index;
+};
+
+class EEPROMClass {
+public:
+  uint8_t read(int idx) { return data_[idx & E2END]; }
+  void write(int idx, uint8_t val) { data_[idx & E2END] = val; }
+  void update(int idx, uint8_t val) { data_[idx & E2END] = val; }
+  template <typename T> T &get(int idx, T &t) { memcpy(&t, data_ + idx, sizeof(T)); return t; }
+  template <typename T> const T &put(int idx, const T &t) { memcpy(data_ + idx, &t, sizeof(T)); return t; }
+  uint16_t length() { return E2END + 1; }
+
+  uint8_t data_[E2END + 1];
+};
+
+extern EEPROMClass EEPROM;
+
+inline EERef::operator uint8_t() const { return EEPROM.read(index); }
+inline EERef &EERef::operator=(uint8_t val) { EEPROM.write(index, val); return *this; }
+
+#endif // SIM_EEPROM_H_
@@ -0,0 +1,23 @@
+// CMSIS intrinsics used by the firmware, single-threaded host versions
+#ifndef SIM_ARM_MATH_H_
+#define SIM_ARM_MATH_H_
+
+#include <stdint.h>
+
+static inline void __DMB() { }
+static inline void __CLREX() { }
+static inline uint32_t __LDREXW(volatile uint32_t *addr) { return *addr; }
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) { *addr = value; return 0; }
+
+static inline int32_t __SSAT(int32_t value, uint32_t bits) {
+  const int32_t max = (1 << (bits - 1)) - 1;
+  const int32_t min = -max - 1;
+  return value > max ? max : value < min ? min : value;
+}
+
+static inline uint32_t __USAT(int32_t value, uint32_t bits) {
+  const int32_t max = (1 << bits) - 1;
+  return value > max ? max : value < 0 ? 0 : value;
+}
+
+#endif // SIM_ARM_MATH_H_
@@ -0,0 +1,79 @@
+// Host-side usbMIDI. Incoming messages can be queued by the harness with
+// sim_push(); outgoing messages are counted and dropped.
+
+#ifndef SIM_USB_MIDI_H_
+#define SIM_USB_MIDI_H_
+
+#include <stdint.h>
+
+class usb_midi_class {
+public:
+  enum {
+    InvalidType           = 0x00,
+    NoteOff               = 0x80,
+    NoteOn                = 0x90,
+    AfterTouchPoly        = 0xA0,
+    ControlChange         = 0xB0,
+    ProgramChange         = 0xC0,
+    AfterTouchChannel     = 0xD0,
+    PitchBend             = 0xE0,
+    SystemExclusive       = 0xF0,
+    TimeCodeQuarterFrame  = 0xF1,
+    SongPosition          = 0xF2,
+    SongSelect            = 0xF3,
+    TuneRequest           = 0xF6,
+    Clock                 = 0xF8,
+    Start                 = 0xFA,
+    Continue              = 0xFB,
+    Stop                  = 0xFC,
+    ActiveSensing         = 0xFE,
+    SystemReset           = 0xFF,
+  };
+
+  bool read(uint8_t channel = 0) {
+    (void)channel;
+    if (head_ == tail_) return false;
+    current_ = queue_[tail_];
+    tail_ = (tail_ + 1) % kQueueSize;
+    return true;
+  }
+  uint8_t getType() const { return current_.type; }
+  uint8_t getChannel() const { return current_.channel; }
+  uint8_t getData1() const { return current_.data1; }
+  uint8_t getData2() const { return current_.data2; }
+  uint8_t *getSysExArray() { return sysex_; }
+  uint16_t getSysExArrayLength() const { return 0; }
+
+  void sendNoteOn(uint8_t, uint8_t, uint8_t, uint8_t = 0) { ++sent_; }
+  void sendNoteOff(uint8_t, uint8_t, uint8_t, uint8_t = 0) { ++sent_; }
+  void sendControlChange(uint8_t, uint8_t, uint8_t, uint8_t = 0) { ++sent_; }
+  void sendAfterTouch(uint8_t, uint8_t, uint8_t = 0) { ++sent_; }
+  void sendPitchBend(int, uint8_t, uint8_t = 0) { ++sent_; }
+  void sendProgramChange(uint8_t, uint8_t, uint8_t = 0) { ++sent_; }
+  void sendRealTime(uint8_t, uint8_t = 0) { ++sent_; }
+  void sendSysEx(uint32_t, const uint8_t *, bool = false, uint8_t = 0) { ++sent_; }
+  void send(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t) { ++sent_; }
+  void send_now() { }
+
+  void sim_push(uint8_t type, uint8_t channel, uint8_t data1, uint8_t data2) {
+    queue_[head_] = { type, channel, data1, data2 };
+    head_ = (head_ + 1) % kQueueSize;
+  }
+  uint32_t sim_sent() const { return sent_; }
+
+private:
+  struct Message {
+    uint8_t type, channel, data1, data2;
+  };
+  static constexpr int kQueueSize = 256;
+  Message queue_[kQueueSize];
+  Message current_;
+  uint8_t sysex_[4];
+  int head_ = 0;
+  int tail_ = 0;
+  uint32_t sent_ = 0;
+};
+
+extern usb_midi_class usbMIDI;
+
+#endif // SIM_USB_MIDI_H_